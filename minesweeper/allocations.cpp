@@ -0,0 +1,26 @@
+// clang-format off
+#include "pch.h"
+#include "allocations.hpp"
+
+// clang-format on
+
+namespace {
+/// The number of heap allocations since the start of the process.
+std::atomic<std::uint64_t> gAllocations{0};
+}  // namespace
+
+std::uint64_t allocationsCount() {
+  return gAllocations.load(std::memory_order_relaxed);
+}
+
+void* operator new(std::size_t size) {
+  gAllocations.fetch_add(1, std::memory_order_relaxed);
+  if (void* p = std::malloc(size == 0 ? 1 : size)) {
+    return p;
+  }
+  throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept { std::free(p); }
+
+void operator delete(void* p, std::size_t) noexcept { std::free(p); }
@@ -0,0 +1,9 @@
+#pragma once
+
+/// @brief Returns the number of heap allocations since the start of the
+/// process.
+///
+/// The allocations are counted by a replacement of the global operator new
+/// in allocations.cpp, which only the benchmarks and the tests executables
+/// link: the game and the engine libraries keep the default allocator.
+std::uint64_t allocationsCount();
@@ -32,7 +32,7 @@ bool GraphicsAssets::load() {
 
   SDL_Texture* unexplored = createTextureFromImage(
       _renderer.get()->raw_ptr(), "unexplored", _assetsDir,
-      "Minesweeper_LAZARUS_21x21_unexplored.png");
+      tileFileName(kUnexplored));
   if (!unexplored) {
     return false;
   }
@@ -40,7 +40,7 @@ bool GraphicsAssets::load() {
 
   SDL_Texture* mine =
       createTextureFromImage(_renderer.get()->raw_ptr(), "mine", _assetsDir,
-                             "Minesweeper_LAZARUS_21x21_mine.png");
+                             tileFileName(kMine));
   if (!mine) {
     return false;
   }
@@ -48,17 +48,16 @@ bool GraphicsAssets::load() {
 
   SDL_Texture* mineHit =
       createTextureFromImage(_renderer.get()->raw_ptr(), "mine_hit", _assetsDir,
-                             "Minesweeper_LAZARUS_21x21_mine_hit.png");
+                             tileFileName(kMineHit));
   if (!mineHit) {
     return false;
   }
   _graphics.emplace(kMineHit, std::make_shared<Texture>(mineHit));
 
   for (int i = 0; i <= 8; i++) {
-    std::string fileName =
-        "Minesweeper_LAZARUS_21x21_" + std::to_string(i) + ".png";
-
     std::string name = fmt::format("{}", i);
+    std::string fileName = tileFileName(name);
+
     SDL_Texture* tex = createTextureFromImage(_renderer.get()->raw_ptr(), name,
                                               _assetsDir, fileName);
     if (!tex) {
@@ -12,6 +12,13 @@ const std::string k5("5");
 const std::string k6("6");
 const std::string k7("7");
 const std::string k8("8");
+const std::string kFlag("flag");
+
+/// @brief Returns the file name of the image of a tile (e.g. kMine) in the
+/// assets directory.
+inline std::string tileFileName(const std::string& name) {
+  return "Minesweeper_LAZARUS_21x21_" + name + ".png";
+}
 
 class Renderer;
 
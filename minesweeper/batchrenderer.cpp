@@ -0,0 +1,170 @@
+// clang-format off
+#include "pch.h"
+#include "assets.hpp"
+#include "board.hpp"
+#include "threadpool.hpp"
+#include "batchrenderer.hpp"
+
+// clang-format on
+
+namespace fs = std::filesystem;
+
+namespace {
+/// The pixel format of the decoded tiles and of the drawn images.
+const Uint32 kPixelFormat = SDL_PIXELFORMAT_ARGB8888;
+
+/// The color of the pixels no tile covers (the margins of the hex rows).
+const std::uint32_t kBackground = 0xFF808080;
+}  // namespace
+
+bool BatchRenderer::load() {
+  // the PNG codec is loaded here, before the workers use it
+  if (!(IMG_Init(IMG_INIT_PNG) & IMG_INIT_PNG)) {
+    return false;
+  }
+
+  const std::string names[kTilesCount] = {kUnexplored, kFlag, kMine, kMineHit,
+                                          k0, k1, k2, k3, k4, k5, k6, k7, k8};
+
+  for (int t = 0; t < kTilesCount; t++) {
+    fs::path imagePath = _tilesDir / tileFileName(names[t]);
+    SDL_Surface* image = IMG_Load(imagePath.string().c_str());
+    if (image == nullptr) {
+      return false;
+    }
+    SDL_Surface* surface = SDL_ConvertSurfaceFormat(image, kPixelFormat, 0);
+    SDL_FreeSurface(image);
+    if (surface == nullptr) {
+      return false;
+    }
+
+    if (t == 0) {
+      _tileW = surface->w;
+      _tileH = surface->h;
+      _tiles.resize(static_cast<std::size_t>(kTilesCount) * _tileW * _tileH);
+    } else if (surface->w != _tileW || surface->h != _tileH) {
+      SDL_SetError("The tile %s is not %dx%d", names[t].c_str(), _tileW,
+                   _tileH);
+      SDL_FreeSurface(surface);
+      return false;
+    }
+
+    std::uint32_t* dst = _tiles.data() + static_cast<std::size_t>(t) *
+                                             _tileW * _tileH;
+    for (int y = 0; y < _tileH; y++) {
+      std::memcpy(dst + static_cast<std::size_t>(y) * _tileW,
+                  static_cast<const std::uint8_t*>(surface->pixels) +
+                      static_cast<std::size_t>(y) * surface->pitch,
+                  _tileW * sizeof(std::uint32_t));
+    }
+    SDL_FreeSurface(surface);
+  }
+
+  // the tile of each packed tile value, as in Game::init()
+  for (std::size_t cell = 0; cell < _cellTiles.size(); cell++) {
+    int value = static_cast<int>(cell & kCellValueMask);
+    int t;
+    if (!(cell & kCellRevealed)) {
+      t = cell & kCellFlagged ? kTileFlag : kTileUnexplored;
+    } else if (value == static_cast<int>(kMineTileValue)) {
+      t = cell & kCellExploded ? kTileMineHit : kTileMine;
+    } else {
+      t = kTile0 + std::min(value, 8);
+    }
+    _cellTiles[cell] = static_cast<std::uint8_t>(t);
+  }
+
+  return true;
+}
+
+void BatchRenderer::imageSize(int boardSize, TopologyKind topology,
+                              int& width, int& height) const {
+  width = _tileW * boardSize;
+  if (topology == TopologyKind::Hex && boardSize > 1) {
+    width += _tileW / 2;
+  }
+  height = _tileH * boardSize;
+}
+
+void BatchRenderer::draw(const std::uint8_t* cells, int boardSize,
+                         TopologyKind topology,
+                         std::vector<std::uint32_t>& pixels) const {
+  int width;
+  int height;
+  imageSize(boardSize, topology, width, height);
+  pixels.resize(static_cast<std::size_t>(width) * height);
+
+  bool hex = topology == TopologyKind::Hex;
+  std::size_t rowBytes = _tileW * sizeof(std::uint32_t);
+
+  for (int row = 0; row < boardSize; row++) {
+    int offset = hex && (row & 1) ? _tileW / 2 : 0;
+    const std::uint8_t* rowCells =
+        cells + static_cast<std::size_t>(row) * boardSize;
+
+    for (int y = 0; y < _tileH; y++) {
+      std::uint32_t* dst =
+          pixels.data() + static_cast<std::size_t>(row * _tileH + y) * width;
+
+      // the margins left by the shifted rows
+      if (hex) {
+        std::fill(dst, dst + offset, kBackground);
+        std::fill(dst + offset + boardSize * _tileW, dst + width,
+                  kBackground);
+      }
+
+      dst += offset;
+      for (int col = 0; col < boardSize; col++) {
+        const std::uint32_t* src =
+            tile(_cellTiles[rowCells[col]]) + static_cast<std::size_t>(y) *
+                                                   _tileW;
+        std::memcpy(dst, src, rowBytes);
+        dst += _tileW;
+      }
+    }
+  }
+}
+
+std::size_t BatchRenderer::render(ThreadPool& pool,
+                                  const std::vector<RenderJob>& jobs) {
+  _buffers.resize(pool.size());
+  std::atomic<std::size_t> written{0};
+
+  pool.parallelFor(jobs.size(), [this, &jobs, &written](std::size_t i,
+                                                        std::size_t worker) {
+    const RenderJob& job = jobs[i];
+    std::vector<std::uint32_t>& pixels = _buffers[worker];
+    draw(job.cells, job.boardSize, job.topology, pixels);
+
+    int width;
+    int height;
+    imageSize(job.boardSize, job.topology, width, height);
+
+    // the encoder streams the compressed rows into the file
+    SDL_RWops* file = SDL_RWFromFile(job.output.string().c_str(), "wb");
+    if (file == nullptr) {
+      return;
+    }
+    bool encoded = encode(pixels, width, height, file);
+    if (SDL_RWclose(file) == 0 && encoded) {
+      written.fetch_add(1, std::memory_order_relaxed);
+    }
+  });
+
+  return written.load();
+}
+
+bool BatchRenderer::encode(std::vector<std::uint32_t>& pixels, int width,
+                           int height, SDL_RWops* stream) {
+  // a surface over the pixels, without copying them
+  SDL_Surface* surface = SDL_CreateRGBSurfaceWithFormatFrom(
+      pixels.data(), width, height, 32, width * sizeof(std::uint32_t),
+      kPixelFormat);
+  if (surface == nullptr) {
+    return false;
+  }
+
+  bool encoded = IMG_SavePNG_RW(surface, stream, 0) == 0;
+  SDL_FreeSurface(surface);
+  return encoded;
+}
@@ -0,0 +1,86 @@
+#pragma once
+
+#include "topology.hpp"
+
+class ThreadPool;
+
+/// @brief An image to render: a board state and the PNG file receiving it.
+struct RenderJob {
+  const std::uint8_t* cells;  //!< The packed tiles (see board.hpp), owned by
+                              //!< the caller.
+  int boardSize;
+  TopologyKind topology;
+  std::filesystem::path output;
+};
+
+/// @brief Renders boards to PNG files without a display.
+///
+/// The tile images of the assets are decoded once into 32-bit ARGB pixels,
+/// and a board is drawn by copying the rows of its tiles into an image buffer:
+/// no renderer, window or video driver is involved. The jobs are spread over
+/// a thread pool; each worker draws into its own buffer, which is reused from
+/// one job to the next, and encodes the PNG straight into the output file.
+/// Flags, mines and the exploded mine (kCellExploded) are drawn as the player
+/// would see them at the end of the game.
+class BatchRenderer {
+ public:
+  /// @brief The constructor.
+  /// @param assetsDir The assets directory; the tiles are read from its
+  /// graphics/21x21 directory, as the game reads them.
+  explicit BatchRenderer(const std::filesystem::path& assetsDir)
+      : _tilesDir{assetsDir / "graphics" / "21x21"} {}
+
+  BatchRenderer(const BatchRenderer&) = delete;
+  BatchRenderer& operator=(const BatchRenderer&) = delete;
+
+  /// @brief Decodes the tile images.
+  /// @return true if all the images were decoded and have the same size;
+  /// false otherwise (see SDL_GetError()).
+  bool load();
+
+  /// @brief Returns the size of a drawn board, in pixels.
+  void imageSize(int boardSize, TopologyKind topology, int& width,
+                 int& height) const;
+
+  /// @brief Draws a board.
+  /// @param cells The packed tiles.
+  /// @param boardSize The dimension of the board.
+  /// @param topology The topology (hex boards shift the odd rows).
+  /// @param pixels Receives the ARGB pixels, row-major; resized if needed.
+  void draw(const std::uint8_t* cells, int boardSize, TopologyKind topology,
+            std::vector<std::uint32_t>& pixels) const;
+
+  /// @brief Draws and encodes the jobs in parallel.
+  /// @param pool The workers.
+  /// @param jobs The jobs.
+  /// @return The number of images written; the other jobs failed.
+  std::size_t render(ThreadPool& pool, const std::vector<RenderJob>& jobs);
+
+  /// @brief Encodes an image as a PNG stream.
+  /// @param pixels The ARGB pixels.
+  /// @param width The width of the image.
+  /// @param height The height of the image.
+  /// @param stream The destination; it is not closed.
+  /// @return true if the image was written; false otherwise.
+  static bool encode(std::vector<std::uint32_t>& pixels, int width, int height,
+                     SDL_RWops* stream);
+
+ private:
+  /// The tiles, in the order of _tiles.
+  enum Tile { kTileUnexplored, kTileFlag, kTileMine, kTileMineHit, kTile0 };
+
+  static constexpr int kTilesCount = kTile0 + 9;
+
+  /// @brief Returns the first pixel of a tile.
+  const std::uint32_t* tile(int t) const {
+    return _tiles.data() + static_cast<std::size_t>(t) * _tileW * _tileH;
+  }
+
+ private:
+  std::filesystem::path _tilesDir;  //!< The directory of the tile images.
+  int _tileW{0};
+  int _tileH{0};
+  std::vector<std::uint32_t> _tiles;                 //!< The tile pixels.
+  std::array<std::uint8_t, 256> _cellTiles{};        //!< The tile of each cell.
+  std::vector<std::vector<std::uint32_t>> _buffers;  //!< One per worker.
+};
@@ -0,0 +1,979 @@
+// clang-format off
+#include "pch.h"
+#include "allocations.hpp"
+#include "assets.hpp"
+#include "batchrenderer.hpp"
+#include "renderer.hpp"
+#include "board.hpp"
+#include "bitboard.hpp"
+#include "boardcodec.hpp"
+#include "boardgenerator.hpp"
+#include "components.hpp"
+#include "game.hpp"
+#include "gridlayout.hpp"
+#include "montecarlo.hpp"
+#include "parallelreveal.hpp"
+#include "solver.hpp"
+#include "threadpool.hpp"
+#include "vectorenv.hpp"
+#include "benchmark.hpp"
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+// clang-format on
+
+namespace fs = std::filesystem;
+
+namespace {
+/// The number of won() checks of a "won" operation; a single check is too
+/// short to be timed.
+const std::size_t kWonChecks = 1000;
+
+/// The boards of the vectorized environment cases, stepped by one call.
+const std::size_t kVecEnvBoards = 1024;
+
+/// The batches of random actions the vectorized environment cases cycle
+/// through; enough for the games to keep ending and restarting.
+const std::size_t kVecEnvBatches = 64;
+
+/// The largest dimension of the vectorized environment cases: agents train
+/// on the difficulty levels.
+const int kVecEnvMaxSize = 24;
+
+/// The dimension of the parallel reveal cases, and their mines: at 2% of
+/// mines almost the whole board is one opening.
+const int kParallelRevealSize = 4096;
+const int kParallelRevealMines = kParallelRevealSize * kParallelRevealSize / 50;
+
+/// The workers of the parallel reveal cases.
+const std::size_t kParallelRevealThreads[] = {1, 2, 4, 8, 16, 32, 64};
+
+/// The largest dimension of the Monte Carlo cases: the hints are asked on the
+/// difficulty levels.
+const int kMonteCarloMaxSize = 24;
+
+/// The dimensions of the layout cases: 1M, 16M, 64M and 100M tiles. The
+/// Morton layout pads to a power of two and stops at 8192: 10000x10000 would
+/// take 256M tiles.
+const int kLayoutSizes[] = {1024, 4096, 8192, 10000};
+const int kMortonMaxSize = 8192;
+
+/// Receives the results of the measured operations, so that the compiler
+/// does not remove them.
+volatile std::uintptr_t gSink;
+
+template <typename B>
+struct IsBitBoard : std::false_type {};
+
+template <int W, int H>
+struct IsBitBoard<BitBoard<W, H>> : std::true_type {};
+
+/// True if the Solver looks up the pair patterns on a board type: the square
+/// boards, but not the bitboards, whose solver has the single point rule only.
+template <typename B>
+struct HasPairPatterns
+    : std::bool_constant<B::TopologyType::kKind == TopologyKind::Square> {};
+
+template <int W, int H>
+struct HasPairPatterns<BitBoard<W, H>> : std::false_type {};
+
+/// @brief A board dimension to benchmark.
+struct BoardSettings {
+  const char* name;
+  int size;
+  int mines;
+  bool game;  //!< Also run the game (and rendering) cases.
+};
+
+/// The difficulty levels and large custom boards (about 15% of mines). The
+/// game cases create one entity and render one 21x21 tile per cell, so they
+/// stop at 256x256.
+const BoardSettings kBoards[] = {
+    {"beginner", 9, 10, true},          {"intermediate", 16, 40, true},
+    {"advanced", 24, 99, true},         {"custom256", 256, 9830, true},
+    {"custom1024", 1024, 157286, false}};
+
+/// @brief The hardware counters of the calling thread, read as a group:
+/// cycles, cache misses and branch misses of the user space code.
+class PerfCounters {
+ public:
+  PerfCounters() {
+#ifdef __linux__
+    const std::uint64_t configs[kCount] = {PERF_COUNT_HW_CPU_CYCLES,
+                                           PERF_COUNT_HW_CACHE_MISSES,
+                                           PERF_COUNT_HW_BRANCH_MISSES};
+    for (int i = 0; i < kCount; i++) {
+      perf_event_attr attr;
+      memset(&attr, 0, sizeof attr);
+      attr.size = sizeof attr;
+      attr.type = PERF_TYPE_HARDWARE;
+      attr.config = configs[i];
+      attr.disabled = i == 0;
+      attr.exclude_kernel = 1;
+      attr.exclude_hv = 1;
+      attr.read_format = PERF_FORMAT_GROUP;
+
+      int fd = static_cast<int>(
+          syscall(SYS_perf_event_open, &attr, 0, -1, _fds[0], 0));
+      if (fd < 0) {
+        close();
+        return;
+      }
+      _fds[i] = fd;
+    }
+#endif
+  }
+
+  ~PerfCounters() { close(); }
+
+  PerfCounters(const PerfCounters&) = delete;
+  PerfCounters& operator=(const PerfCounters&) = delete;
+
+  /// @brief Returns true if the counters can be read.
+  bool available() const { return _fds[0] >= 0; }
+
+  /// @brief Resets the counters to zero.
+  void reset() {
+#ifdef __linux__
+    if (available()) {
+      ioctl(_fds[0], PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+    }
+#endif
+  }
+
+  /// @brief Starts counting.
+  void enable() {
+#ifdef __linux__
+    if (available()) {
+      ioctl(_fds[0], PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+    }
+#endif
+  }
+
+  /// @brief Stops counting.
+  void disable() {
+#ifdef __linux__
+    if (available()) {
+      ioctl(_fds[0], PERF_EVENT_IOC_DISABLE, PERF_IOC_FLAG_GROUP);
+    }
+#endif
+  }
+
+  /// @brief Reads the counters.
+  /// @param values Receives the cycles, cache misses and branch misses.
+  /// @return true if the counters were read; false otherwise.
+  bool read(std::uint64_t (&values)[3]) const {
+#ifdef __linux__
+    // PERF_FORMAT_GROUP: the number of counters, then their values
+    std::uint64_t buffer[1 + kCount];
+    if (available() &&
+        ::read(_fds[0], buffer, sizeof buffer) ==
+            static_cast<ssize_t>(sizeof buffer) &&
+        buffer[0] == kCount) {
+      for (int i = 0; i < kCount; i++) {
+        values[i] = buffer[1 + i];
+      }
+      return true;
+    }
+#endif
+    (void)values;
+    return false;
+  }
+
+ private:
+  void close() {
+#ifdef __linux__
+    for (int& fd : _fds) {
+      if (fd >= 0) {
+        ::close(fd);
+        fd = -1;
+      }
+    }
+#endif
+  }
+
+ private:
+  static const int kCount = 3;
+  int _fds[kCount] = {-1, -1, -1};
+};
+
+/// @brief Returns a board with its largest opening revealed, the position at
+/// which a player first has to guess.
+Board openedBoard(int size, int mines) {
+  BoardGenerator generator(size, mines);
+  generator.seed(1);
+  generator.generate();
+
+  Board board;
+  board.setTiles(size, generator.getTiles());
+  int start = std::max(generator.getLargestOpeningTile(), 0);
+  board.reveal(start / size, start % size);
+  return board;
+}
+
+/// @brief Reads the ns_per_op of each benchmark of a JSON results file, as
+/// written by writeResults().
+/// @return false if the file cannot be read, or if a benchmark has no
+/// ns_per_op number: a field read as 0 would report every case as a
+/// regression.
+bool readBaseline(const fs::path& path,
+                  std::unordered_map<std::string, double>& baseline) {
+  std::ifstream file(path);
+  if (!file) {
+    return false;
+  }
+  std::string text((std::istreambuf_iterator<char>(file)),
+                   std::istreambuf_iterator<char>());
+
+  const std::string nameKey = "\"name\":";
+  const std::string nsKey = "\"ns_per_op\":";
+  std::size_t pos = 0;
+
+  while ((pos = text.find(nameKey, pos)) != std::string::npos) {
+    std::size_t first = text.find('"', pos + nameKey.size());
+    std::size_t last = text.find('"', first + 1);
+    std::size_t ns = text.find(nsKey, last);
+    if (first == std::string::npos || last == std::string::npos ||
+        ns == std::string::npos || ns > text.find(nameKey, last)) {
+      return false;
+    }
+
+    const char* value = text.c_str() + ns + nsKey.size();
+    char* end;
+    double nsPerOp = std::strtod(value, &end);
+    if (end == value || !(nsPerOp >= 0)) {
+      return false;
+    }
+    baseline[text.substr(first + 1, last - first - 1)] = nsPerOp;
+    pos = ns;
+  }
+  return true;
+}
+
+/// @brief Writes the results as JSON.
+bool writeResults(const fs::path& path,
+                  const std::vector<BenchmarkResult>& results) {
+  std::ofstream file(path);
+  file << "{\n  \"benchmarks\": [\n";
+  for (std::size_t i = 0; i < results.size(); i++) {
+    const BenchmarkResult& r = results[i];
+    file << fmt::format(
+        "    {{\"name\": \"{}\", \"ns_per_op\": {:.3f}, "
+        "\"allocs_per_op\": {:.3f}, \"cycles_per_op\": {:.1f}, "
+        "\"cache_misses_per_op\": {:.3f}, \"branch_misses_per_op\": {:.3f}}}{}"
+        "\n",
+        r.name, r.nsPerOp, r.allocsPerOp, r.cyclesPerOp, r.cacheMissesPerOp,
+        r.branchMissesPerOp, i + 1 < results.size() ? "," : "");
+  }
+  file << "  ]\n}\n";
+  return file.good();
+}
+}  // namespace
+
+Benchmarks::Benchmarks(const fs::path& assetsDir,
+                       std::shared_ptr<spdlog::logger> logger)
+    : _assetsDir{assetsDir}, _logger{logger} {}
+
+Benchmarks::~Benchmarks() {
+  if (_game) {
+    _game->destroy();
+  }
+}
+
+bool Benchmarks::run(const BenchmarkOptions& options) {
+  // the game cases render with the software renderer on the dummy video
+  // driver, which needs no display
+  SDL_setenv("SDL_VIDEODRIVER", "dummy", 1);
+  _game = std::make_unique<Game>(_assetsDir, _logger);
+  if (!_game->init(SDL_RENDERER_SOFTWARE)) {
+    _logger->warn("No renderer ({}), skipping the game benchmarks",
+                  SDL_GetError());
+    _game.reset();
+  }
+
+  _batchRenderer = std::make_unique<BatchRenderer>(_assetsDir);
+  if (!_batchRenderer->load()) {
+    _logger->warn("No tiles ({}), skipping the image benchmarks",
+                  SDL_GetError());
+    _batchRenderer.reset();
+  }
+
+  for (const BoardSettings& settings : kBoards) {
+    addBoardCases(settings.name, settings.size, settings.mines);
+    if (settings.size <= kMonteCarloMaxSize) {
+      addMonteCarloCases(settings.name, settings.size, settings.mines);
+    }
+    if (settings.game && _game) {
+      addGameCases(settings.name, settings.size, settings.mines);
+    }
+    if (settings.game && _batchRenderer) {
+      addImageCases(settings.name, settings.size, settings.mines);
+    }
+  }
+  addParallelRevealCases();
+
+  for (int size : kLayoutSizes) {
+    addLayoutCases<RowMajorLayout>(size);
+    addLayoutCases<BlockedLayout<8>>(size);
+    addLayoutCases<BlockedLayout<64>>(size);
+    if (size <= kMortonMaxSize) {
+      addLayoutCases<MortonLayout>(size);
+    }
+  }
+
+  std::unordered_map<std::string, double> baseline;
+  if (!options.baseline.empty() && !readBaseline(options.baseline, baseline)) {
+    _logger->error("Cannot read the baseline {}", options.baseline.string());
+    return false;
+  }
+
+  bool passed = true;
+  std::vector<BenchmarkResult> results;
+
+  fmt::print("{:<32} {:>14} {:>10} {:>12} {:>12} {:>12}\n", "benchmark",
+             "ns/op", "allocs/op", "cycles/op", "cache-miss", "branch-miss");
+
+  for (const Case& c : _cases) {
+    if (c.name.find(options.filter) == std::string::npos) {
+      continue;
+    }
+
+    if (c.start) {
+      c.start();
+    }
+    BenchmarkResult result = measure(c, options.minTime);
+    results.push_back(result);
+
+    fmt::print("{:<32} {:>14.1f} {:>10.2f} {:>12.0f} {:>12.2f} {:>12.2f}\n",
+               result.name, result.nsPerOp, result.allocsPerOp,
+               result.cyclesPerOp, result.cacheMissesPerOp,
+               result.branchMissesPerOp);
+    _logger->info("Benchmark {}: {:.1f} ns/op, {:.2f} allocs/op", result.name,
+                  result.nsPerOp, result.allocsPerOp);
+    if (c.report) {
+      c.report();
+    }
+    if (c.finish) {
+      c.finish();
+    }
+
+    if (c.noAllocations && result.allocsPerOp > 0) {
+      _logger->error("Benchmark {} allocated: {:.2f} allocs/op", result.name,
+                     result.allocsPerOp);
+      fmt::print("ALLOCATION {}: {:.2f} allocs/op, expected none\n",
+                 result.name, result.allocsPerOp);
+      passed = false;
+    }
+
+    auto it = baseline.find(result.name);
+    if (it != baseline.end() &&
+        result.nsPerOp > it->second * (1.0 + options.tolerance)) {
+      _logger->error("Benchmark {} regressed: {:.1f} ns/op, baseline {:.1f}",
+                     result.name, result.nsPerOp, it->second);
+      fmt::print("REGRESSION {}: {:.1f} ns/op, baseline {:.1f} ns/op\n",
+                 result.name, result.nsPerOp, it->second);
+      passed = false;
+    }
+  }
+
+  if (!options.output.empty() && !writeResults(options.output, results)) {
+    _logger->error("Cannot write the results {}", options.output.string());
+    return false;
+  }
+
+  return passed;
+}
+
+template <typename MakeFixture, typename Setup, typename Op>
+Benchmarks::Case& Benchmarks::addCase(const std::string& name,
+                                      MakeFixture makeFixture, Setup setup,
+                                      Op op, std::size_t opsPerCall) {
+  using Fixture = typename decltype(makeFixture())::element_type;
+  auto fixture = std::make_shared<std::unique_ptr<Fixture>>();
+
+  Case c(name, nullptr, [fixture, op]() { op(**fixture); }, opsPerCall);
+  if constexpr (!std::is_null_pointer_v<Setup>) {
+    c.setup = [fixture, setup]() { setup(**fixture); };
+  }
+  c.start = [fixture, makeFixture]() { *fixture = makeFixture(); };
+  c.finish = [fixture]() { fixture->reset(); };
+
+  _cases.push_back(std::move(c));
+  return _cases.back();
+}
+
+void Benchmarks::addBoardCases(const std::string& board, int size,
+                               int mines) {
+  auto generator = std::make_shared<BoardGenerator>(size, mines);
+  generator->seed(1);
+
+  _cases.push_back({board + "/generate", nullptr,
+                    [generator]() { generator->generate(); }, 1, true});
+
+  _cases.push_back({board + "/mines_positions",
+                    [generator]() {
+                      std::fill(generator->_tiles.begin(),
+                                generator->_tiles.end(), kEmptyTileValue);
+                    },
+                    [generator]() { generator->generateMinesPositions(); }});
+
+  generator->generate();
+  auto tiles = std::make_shared<const std::vector<int>>(generator->getTiles());
+  addCodecCases(board, size, tiles);
+
+  int start = std::max(generator->getLargestOpeningTile(), 0);
+  addRevealCases<Board>(board + "/", tiles, size, start);
+
+  if (size == 9) {
+    addRevealCases<BeginnerBitBoard>(board + "/bitboard_", tiles, size, start);
+  } else if (size == 16) {
+    addRevealCases<IntermediateBitBoard>(board + "/bitboard_", tiles, size,
+                                         start);
+  } else if (size == 24) {
+    addRevealCases<AdvancedBitBoard>(board + "/bitboard_", tiles, size, start);
+  } else {
+    addRevealCases<DynamicBitBoard>(board + "/bitboard_", tiles, size, start);
+  }
+
+  addTopologyCases<TorusTopology>(board, size, mines);
+  addTopologyCases<HexTopology>(board, size, mines);
+  addTopologyCases<KnightTopology>(board, size, mines);
+
+  if (size <= kVecEnvMaxSize) {
+    addVectorEnvCases(board, size, mines);
+  }
+}
+
+void Benchmarks::addCodecCases(const std::string& board, int size,
+                               std::shared_ptr<const std::vector<int>> tiles) {
+  struct Fixture {
+    BoardCodec codec;
+    std::vector<std::uint8_t> cells;
+    std::vector<std::uint8_t> record;
+    int size;
+  };
+
+  auto makeFixture = [tiles, size]() {
+    auto f = std::make_unique<Fixture>();
+    f->size = size;
+    f->cells.assign(tiles->begin(), tiles->end());
+    std::size_t mines = std::count(tiles->begin(), tiles->end(),
+                                   static_cast<int>(kMineTileValue));
+    BoardCodec::Format format;
+    f->record.resize(f->codec.encodedSize(size, mines, format));
+    f->codec.encode(f->cells.data(), size, f->record.data());
+    return f;
+  };
+
+  addCase(board + "/codec_encode", makeFixture, nullptr, [](Fixture& f) {
+    gSink = f.codec.encode(f.cells.data(), f.size, f.record.data());
+  });
+
+  addCase(board + "/codec_decode", makeFixture, nullptr, [](Fixture& f) {
+    int size;
+    gSink = f.codec.decode(f.record.data(), f.record.size(), size, f.cells);
+  });
+}
+
+void Benchmarks::addVectorEnvCases(const std::string& board, int size,
+                                   int mines) {
+  struct Fixture {
+    std::unique_ptr<VectorEnv> env;
+    std::vector<EnvAction> actions;
+    std::vector<std::uint8_t> observations;
+    std::vector<std::uint32_t> revealed;
+    std::vector<float> rewards;
+    std::vector<std::uint8_t> dones;
+    std::size_t batch{0};
+  };
+
+  auto makeFixture = [size, mines]() {
+    auto f = std::make_unique<Fixture>();
+    f->env = std::make_unique<VectorEnv>(kVecEnvBoards, size, mines, 1);
+    f->observations.resize(kVecEnvBoards * f->env->cellsCount());
+    f->revealed.resize(kVecEnvBoards);
+    f->rewards.resize(kVecEnvBoards);
+    f->dones.resize(kVecEnvBoards);
+
+    // mostly reveals, as a learning agent plays
+    std::mt19937 random(1);
+    std::uniform_int_distribution<std::uint32_t> coord(0, size - 1);
+    std::uniform_int_distribution<std::uint32_t> kind(0, 9);
+    f->actions.resize(kVecEnvBoards * kVecEnvBatches);
+    for (EnvAction& action : f->actions) {
+      std::uint32_t k = kind(random);
+      action.row = coord(random);
+      action.col = coord(random);
+      action.kind = static_cast<std::uint32_t>(
+          k == 0 ? EnvActionKind::Flag
+                 : (k == 1 ? EnvActionKind::Chord : EnvActionKind::Reveal));
+    }
+    return f;
+  };
+
+  // steps every board once, writing all the outputs; the level sizes play
+  // on bitboards
+  addCase(
+      board + "/vecenv_step", makeFixture, nullptr,
+      [](Fixture& f) {
+        f.env->step(f.actions.data() + f.batch * kVecEnvBoards,
+                    f.observations.data(), f.revealed.data(), f.rewards.data(),
+                    f.dones.data());
+        f.batch = (f.batch + 1) % kVecEnvBatches;
+      },
+      kVecEnvBoards)
+      .noAllocations = true;
+}
+
+void Benchmarks::addMonteCarloCases(const std::string& board, int size,
+                                    int mines) {
+  struct Fixture {
+    ThreadPool pool;
+    MonteCarloEngine engine{pool};
+    Board view;
+    MonteCarloOptions options;
+  };
+
+  // the rollouts and the time of all the calls
+  auto total = std::make_shared<MonteCarloResult>();
+
+  auto makeFixture = [size, mines, total]() {
+    auto f = std::make_unique<Fixture>();
+    f->view = openedBoard(size, mines);
+    f->options.seed = 1;
+    f->options.samplesPerRound = f->pool.size();
+    f->options.maxRounds = 1;
+    f->options.timeBudget = std::chrono::hours(1);
+    total->threads = f->pool.size();
+    return f;
+  };
+
+  // one sampled layout per worker, with a rollout per hidden tile, from the
+  // first guess of the board
+  const std::string name = board + "/montecarlo_best_guess";
+  addCase(name, makeFixture, nullptr, [total](Fixture& f) {
+    MonteCarloResult result = f.engine.bestGuess(f.view, f.options);
+    total->rollouts += result.rollouts;
+    total->elapsed += result.elapsed;
+    gSink = result.estimates.size();
+  }).report = [this, total, name]() {
+    fmt::print("{:<32} {:>14.0f} rollouts/s/core ({} threads)\n", name,
+               total->rolloutsPerSecondPerCore(), total->threads);
+    _logger->info("Benchmark {}: {:.0f} rollouts/s/core, {} threads", name,
+                  total->rolloutsPerSecondPerCore(), total->threads);
+  };
+}
+
+void Benchmarks::addParallelRevealCases() {
+  struct Fixture {
+    std::vector<int> tiles;
+    Board board;
+    int start{0};
+    ParallelReveal reveal;
+    std::unique_ptr<ThreadPool> pool;
+  };
+
+  auto makeFixture = [](std::size_t threads) {
+    return [threads]() {
+      BoardGenerator generator(kParallelRevealSize, kParallelRevealMines);
+      generator.seed(1);
+      generator.generate();
+
+      auto f = std::make_unique<Fixture>();
+      f->tiles = generator.getTiles();
+      f->start = std::max(generator.getLargestOpeningTile(), 0);
+      if (threads != 0) {
+        f->pool = std::make_unique<ThreadPool>(threads);
+      }
+      return f;
+    };
+  };
+  auto setup = [](Fixture& f) {
+    f.board.setTiles(kParallelRevealSize, f.tiles);
+  };
+  const std::string prefix = fmt::format("custom{}/", kParallelRevealSize);
+
+  // the sequential flood fill, for reference
+  addCase(prefix + "reveal_opening", makeFixture(0), setup, [](Fixture& f) {
+    gSink = static_cast<std::uintptr_t>(f.board.reveal(
+        f.start / kParallelRevealSize, f.start % kParallelRevealSize));
+  });
+
+  for (std::size_t threads : kParallelRevealThreads) {
+    addCase(fmt::format("{}parallel_reveal_{}", prefix, threads),
+            makeFixture(threads), setup, [](Fixture& f) {
+              gSink = static_cast<std::uintptr_t>(f.reveal.reveal(
+                  *f.pool, f.board, f.start / kParallelRevealSize,
+                  f.start % kParallelRevealSize));
+            });
+  }
+}
+
+template <typename Layout>
+void Benchmarks::addLayoutCases(int size) {
+  struct Fixture {
+    std::unique_ptr<LayoutGrid<Layout>> grid;
+    std::vector<std::uint8_t> rows;
+    std::mt19937_64 random{1};
+    int size{0};
+    int start{0};
+
+    // at 2% of mines almost the whole board is one opening
+    void generate() {
+      grid->generate(static_cast<std::size_t>(size) * size / 50, random);
+      start = 0;
+      while (start < size * size && grid->cell(start / size, start % size)) {
+        start++;
+      }
+      start %= size * size;
+    }
+  };
+
+  auto makeFixture = [size]() {
+    auto f = std::make_unique<Fixture>();
+    f->grid = std::make_unique<LayoutGrid<Layout>>(size);
+    f->rows.resize(static_cast<std::size_t>(size) * size);
+    f->size = size;
+    f->generate();
+    return f;
+  };
+  const std::string prefix = fmt::format("grid{}/{}_", size, Layout::name());
+
+  addCase(prefix + "generate", makeFixture, nullptr,
+          [](Fixture& f) { f.generate(); });
+
+  addCase(
+      prefix + "reveal", makeFixture,
+      [](Fixture& f) { f.grid->hideAll(); },
+      [](Fixture& f) {
+        gSink = f.grid->reveal(f.start / f.size, f.start % f.size);
+      });
+
+  // reads the board row by row, as the renderers do
+  addCase(prefix + "rows", makeFixture, nullptr, [](Fixture& f) {
+    f.grid->copyRowMajor(f.rows.data());
+    gSink = f.rows[0];
+  });
+}
+
+template <typename Topology>
+void Benchmarks::addTopologyCases(const std::string& board, int size,
+                                  int mines) {
+  const std::string prefix = board + "/" + Topology::kName + "_";
+
+  auto generator = std::make_shared<BoardGenerator>(size, mines);
+  generator->seed(1);
+
+  _cases.push_back({prefix + "generate", nullptr,
+                    [generator]() { generator->generate<Topology>(); }, 1,
+                    true});
+
+  generator->generate<Topology>();
+  addRevealCases<BasicBoard<Topology>>(
+      prefix, std::make_shared<const std::vector<int>>(generator->getTiles()),
+      size, std::max(generator->getLargestOpeningTile(), 0));
+}
+
+template <typename B>
+void Benchmarks::addRevealCases(const std::string& prefix,
+                                std::shared_ptr<const std::vector<int>> tiles,
+                                int size, int start) {
+  struct Fixture {
+    B board;
+    Solver solver;
+    BoardJournal journal;
+    std::shared_ptr<const std::vector<int>> tiles;
+    int size;
+    int start;
+
+    void load() {
+      if constexpr (!IsBitBoard<B>::value) {
+        board.setTiles(size, *tiles);
+      } else {
+        board.setTiles(*tiles);
+      }
+    }
+
+    void reveal() { board.reveal(start / size, start % size); }
+
+    Solver::Status solve() {
+      if constexpr (!IsBitBoard<B>::value) {
+        return solver.solve(board);
+      } else {
+        return board.solve();
+      }
+    }
+  };
+
+  // the single point solver has no pair patterns; the scalar one runs the
+  // single point rule tile by tile, even on the boards of the levels
+  auto makeFixture = [tiles, size, start](bool pairPatterns,
+                                          bool bitBoards = true) {
+    return [tiles, size, start, pairPatterns, bitBoards]() {
+      auto f = std::make_unique<Fixture>();
+      f->tiles = tiles;
+      f->size = size;
+      f->start = start;
+      f->solver.setPairPatterns(pairPatterns);
+      f->solver.setBitBoards(bitBoards);
+      if constexpr (IsBitBoard<B>::value) {
+        f->board.resize(size, size);
+      }
+      return f;
+    };
+  };
+  auto revealOpening = [](Fixture& f) {
+    f.load();
+    f.reveal();
+  };
+  auto solve = [](Fixture& f) {
+    gSink = static_cast<std::uintptr_t>(f.solve());
+  };
+
+  // reveals the largest opening; neither the flood fill nor the solver
+  // allocate once they ran on the board
+  addCase(prefix + "reveal", makeFixture(true),
+          [](Fixture& f) { f.load(); }, [](Fixture& f) { f.reveal(); })
+      .noAllocations = true;
+
+  // solves the board from the largest opening; the bitboard solver has the
+  // single point rule only, so it compares with <board>/solve_single_point
+  addCase(prefix + (IsBitBoard<B>::value ? "solve_single_point" : "solve"),
+          makeFixture(true), revealOpening, solve)
+      .noAllocations = true;
+
+  if constexpr (HasPairPatterns<B>::value) {
+    addCase(prefix + "solve_single_point", makeFixture(false), revealOpening,
+            solve)
+        .noAllocations = true;
+    addCase(prefix + "solve_scalar", makeFixture(true, false), revealOpening,
+            solve)
+        .noAllocations = true;
+  }
+
+  if constexpr (!IsBitBoard<B>::value) {
+    // reveals the largest opening, recording it in a journal
+    addCase(
+        prefix + "journal_reveal", makeFixture(true),
+        [](Fixture& f) {
+          f.load();
+          f.journal.clear();
+          f.board.setJournal(&f.journal);
+        },
+        [](Fixture& f) { f.reveal(); });
+
+    // undoes and redoes the reveal of the largest opening
+    addCase(
+        prefix + "undo_redo", makeFixture(true),
+        [](Fixture& f) {
+          f.load();
+          f.journal.clear();
+          f.board.setJournal(&f.journal);
+          f.reveal();
+          f.board.setJournal(nullptr);
+        },
+        [](Fixture& f) {
+          f.journal.undo(f.board);
+          f.journal.redo(f.board);
+        },
+        2);
+  }
+}
+
+void Benchmarks::addImageCases(const std::string& board, int size,
+                               int mines) {
+  struct Fixture {
+    BatchRenderer* renderer;
+    std::vector<std::uint8_t> cells;
+    std::vector<std::uint32_t> pixels;
+    std::vector<std::uint8_t> png;
+    int size;
+    int width;
+    int height;
+  };
+
+  // the revealed board, as a thumbnail shows it
+  auto makeFixture = [renderer = _batchRenderer.get(), size, mines]() {
+    BoardGenerator generator(size, mines);
+    generator.seed(1);
+    generator.generate();
+
+    auto f = std::make_unique<Fixture>();
+    f->renderer = renderer;
+    f->size = size;
+    for (int tile : generator.getTiles()) {
+      f->cells.push_back(static_cast<std::uint8_t>(tile | kCellRevealed));
+    }
+    renderer->imageSize(size, TopologyKind::Square, f->width, f->height);
+    renderer->draw(f->cells.data(), size, TopologyKind::Square, f->pixels);
+    // room for an uncompressed image
+    f->png.resize(f->pixels.size() * sizeof(std::uint32_t) + 4096);
+    return f;
+  };
+
+  // draws the board into the image buffer
+  addCase(board + "/draw_image", makeFixture, nullptr, [](Fixture& f) {
+    f.renderer->draw(f.cells.data(), f.size, TopologyKind::Square, f.pixels);
+  });
+
+  // encodes the image as a PNG in memory
+  addCase(board + "/encode_png", makeFixture, nullptr, [](Fixture& f) {
+    SDL_RWops* stream =
+        SDL_RWFromMem(f.png.data(), static_cast<int>(f.png.size()));
+    gSink = BatchRenderer::encode(f.pixels, f.width, f.height, stream);
+    SDL_RWclose(stream);
+  });
+}
+
+void Benchmarks::addGameCases(const std::string& board, int size, int mines) {
+  Game* game = _game.get();
+
+  // switches the game to the board of the case, once per case
+  auto prepare = [game, size, mines]() {
+    if (game->_boardSize != size || game->_minesCount != mines) {
+      game->changeBoard(size, mines);
+    }
+  };
+
+  auto hideTiles = [game, prepare]() {
+    prepare();
+    game->_registry.view<TileComponent>().each(
+        [](TileComponent& tile) { tile.explored = false; });
+    game->_revealedTilesCount = 0;
+  };
+
+  _cases.push_back({board + "/game_reveal", hideTiles,
+                    [game]() {
+                      int start =
+                          std::max(game->_board.largestOpeningTile, 0);
+                      game->tryRevealNearbyTiles(start / game->_boardSize,
+                                                 start % game->_boardSize);
+                    },
+                    1});
+
+  // a new game generating its board, the prefetcher having none ready; once a
+  // game of the size was played, a new game reuses all its memory
+  auto drained = std::make_shared<PreparedBoard>();
+  _cases.push_back({board + "/new_game",
+                    [game, prepare, drained, size, mines]() {
+                      prepare();
+                      while (game->_prefetcher.take(size, mines,
+                                                    game->_topology,
+                                                    *drained)) {
+                      }
+                    },
+                    [game]() { game->reset(); }, 1, true});
+
+  // a new game taking the board the prefetcher generated ahead
+  _cases.push_back({board + "/new_game_prefetched",
+                    [game, prepare, size, mines]() {
+                      prepare();
+                      BoardPrefetcher& prefetcher = game->_prefetcher;
+                      prefetcher.setCustom(size, mines, game->_topology);
+                      prefetcher.start();
+                      while (prefetcher.depth(size, mines, game->_topology) ==
+                             0) {
+                        std::this_thread::yield();
+                      }
+                      prefetcher.stop();
+                    },
+                    [game]() { game->reset(); }, 1, true});
+
+  _cases.push_back({board + "/reveal_mines", hideTiles,
+                    [game]() { game->revealMines(); }, 1});
+
+  _cases.push_back({board + "/won", prepare,
+                    [game]() {
+                      std::uintptr_t won = 0;
+                      for (std::size_t i = 0; i < kWonChecks; i++) {
+                        won += game->won();
+                        gSink = won;
+                      }
+                    },
+                    kWonChecks});
+
+  _cases.push_back(
+      {board + "/texture_lookup", prepare,
+       [game]() {
+         std::uintptr_t textures = 0;
+         game->_registry.view<TileComponent>().each(
+             [game, &textures](const TileComponent& tile) {
+               textures ^= reinterpret_cast<std::uintptr_t>(
+                   game->getTextureForZoneValue(tile.zoneValue));
+             });
+         gSink = textures;
+       },
+       static_cast<std::size_t>(size) * size});
+
+  // copies the board into a snapshot for the render thread
+  _cases.push_back({board + "/publish_frame", prepare,
+                    [game]() { game->publishFrame(GameInput{}); }, 1});
+
+  _cases.push_back({board + "/render",
+                    [game, prepare]() {
+                      prepare();
+                      game->publishFrame(GameInput{});
+                      game->_frames.acquire();
+                    },
+                    [game]() {
+                      game->startFrame();
+                      game->render();
+                    },
+                    1});
+}
+
+BenchmarkResult Benchmarks::measure(const Case& c,
+                                    std::chrono::milliseconds minTime) {
+  using Clock = std::chrono::steady_clock;
+
+  // warm up the caches and the lazily created data
+  if (c.setup) {
+    c.setup();
+  }
+  c.op();
+
+  PerfCounters counters;
+  counters.reset();
+
+  Clock::duration elapsed{0};
+  std::uint64_t allocations = 0;
+  std::size_t calls = 0;
+
+  while (elapsed < minTime) {
+    if (c.setup) {
+      c.setup();
+    }
+
+    std::uint64_t allocationsBefore = allocationsCount();
+    counters.enable();
+    auto start = Clock::now();
+    c.op();
+    auto end = Clock::now();
+    counters.disable();
+
+    allocations += allocationsCount() - allocationsBefore;
+    elapsed += end - start;
+    calls++;
+  }
+
+  double ops = static_cast<double>(calls * c.opsPerCall);
+
+  BenchmarkResult result;
+  result.name = c.name;
+  result.nsPerOp =
+      std::chrono::duration<double, std::nano>(elapsed).count() / ops;
+  result.allocsPerOp = static_cast<double>(allocations) / ops;
+
+  std::uint64_t values[3];
+  if (counters.read(values)) {
+    result.cyclesPerOp = static_cast<double>(values[0]) / ops;
+    result.cacheMissesPerOp = static_cast<double>(values[1]) / ops;
+    result.branchMissesPerOp = static_cast<double>(values[2]) / ops;
+  }
+  return result;
+}
@@ -0,0 +1,142 @@
+#pragma once
+
+class BatchRenderer;
+class Game;
+
+/// @brief The settings of a benchmark run.
+struct BenchmarkOptions {
+  std::string filter;  //!< Only run the benchmarks whose name contains it.
+  std::filesystem::path baseline;  //!< The JSON results to compare with,
+                                   //!< written by a run on the same machine.
+  std::filesystem::path output;    //!< Where to write the JSON results.
+  double tolerance{0.10};  //!< The allowed slow down relative to the baseline.
+  std::chrono::milliseconds minTime{200};  //!< The timed run of each case.
+};
+
+/// @brief The measures of a benchmark case, per operation.
+struct BenchmarkResult {
+  std::string name;
+  double nsPerOp{0};
+  double allocsPerOp{0};
+  double cyclesPerOp{-1};        //!< -1 if the counter is not available.
+  double cacheMissesPerOp{-1};   //!< -1 if the counter is not available.
+  double branchMissesPerOp{-1};  //!< -1 if the counter is not available.
+};
+
+/// @brief Microbenchmarks of the board generation, the game logic and the
+/// rendering, run on each difficulty level and on large custom boards.
+///
+/// The rendering uses the software renderer of SDL on the dummy video driver,
+/// so no display is needed. The hardware counters (cycles, cache misses and
+/// branch misses) are read with perf_event_open on Linux only.
+class Benchmarks {
+ public:
+  /// @brief The constructor.
+  /// @param assetsDir The directory the assets are loaded from.
+  /// @param logger The logger.
+  Benchmarks(const std::filesystem::path& assetsDir,
+             std::shared_ptr<spdlog::logger> logger);
+  ~Benchmarks();
+
+  Benchmarks(const Benchmarks&) = delete;
+  Benchmarks& operator=(const Benchmarks&) = delete;
+
+  /// @brief Runs the benchmarks, writes the results and compares them with
+  /// the baseline.
+  /// @param options The settings.
+  /// @return false if a benchmark regressed beyond the tolerance, if a case
+  /// which must not allocate did, or if the run failed; true otherwise.
+  bool run(const BenchmarkOptions& options);
+
+ private:
+  /// @brief A benchmark case: setup() prepares each operation and is not
+  /// measured; op() is measured and runs opsPerCall operations.
+  struct Case {
+    Case(std::string name, std::function<void()> setup,
+         std::function<void()> op, std::size_t opsPerCall = 1,
+         bool noAllocations = false)
+        : name{std::move(name)},
+          setup{std::move(setup)},
+          op{std::move(op)},
+          opsPerCall{opsPerCall},
+          noAllocations{noAllocations} {}
+
+    std::string name;
+    std::function<void()> setup;
+    std::function<void()> op;
+    std::size_t opsPerCall;
+    bool noAllocations;  //!< The run fails if an operation allocates after
+                         //!< the warm up.
+    std::function<void()> report;  //!< If set, prints the measures specific
+                                   //!< to the case after it ran.
+    std::function<void()> start;   //!< If set, runs before the case.
+    std::function<void()> finish;  //!< If set, runs after the case.
+  };
+
+  /// @brief Registers a case run on a fixture. The fixture is built by
+  /// makeFixture() (which returns a std::unique_ptr) when the case starts and
+  /// released when it ends, so only the fixture of the running case is alive.
+  /// @param name The name of the case.
+  /// @param makeFixture Builds the fixture.
+  /// @param setup Called with the fixture before each operation; may be null.
+  /// @param op Called with the fixture; measured.
+  /// @param opsPerCall The operations run by a call to op.
+  /// @return The case, valid until the next case is registered.
+  template <typename MakeFixture, typename Setup, typename Op>
+  Case& addCase(const std::string& name, MakeFixture makeFixture, Setup setup,
+                Op op, std::size_t opsPerCall = 1);
+
+  /// @brief Registers the cases of a board dimension.
+  void addBoardCases(const std::string& board, int size, int mines);
+
+  /// @brief Registers the generate, reveal and solve cases of a topology
+  /// other than the square one.
+  template <typename Topology>
+  void addTopologyCases(const std::string& board, int size, int mines);
+
+  /// @brief Registers the reveal and solve cases of a board type (BasicBoard
+  /// or BitBoard) on a fixed board.
+  template <typename B>
+  void addRevealCases(const std::string& prefix,
+                      std::shared_ptr<const std::vector<int>> tiles, int size,
+                      int start);
+
+  /// @brief Registers the encode and decode cases of a board.
+  void addCodecCases(const std::string& board, int size,
+                     std::shared_ptr<const std::vector<int>> tiles);
+
+  /// @brief Registers the cases of the vectorized environment.
+  void addVectorEnvCases(const std::string& board, int size, int mines);
+
+  /// @brief Registers the Monte Carlo guess search case of a board, which
+  /// also reports the rollouts per second per core.
+  void addMonteCarloCases(const std::string& board, int size, int mines);
+
+  /// @brief Registers the sequential and parallel reveal cases of a very large
+  /// opening.
+  void addParallelRevealCases();
+
+  /// @brief Registers the generate, reveal and row traversal cases of a grid
+  /// layout (see gridlayout.hpp).
+  /// @param size The dimension of the board.
+  template <typename Layout>
+  void addLayoutCases(int size);
+
+  /// @brief Registers the offline rendering cases.
+  void addImageCases(const std::string& board, int size, int mines);
+
+  /// @brief Registers the cases which need a game (and a renderer).
+  void addGameCases(const std::string& board, int size, int mines);
+
+  /// @brief Measures a case.
+  BenchmarkResult measure(const Case& c, std::chrono::milliseconds minTime);
+
+ private:
+  std::filesystem::path _assetsDir;
+  std::shared_ptr<spdlog::logger> _logger;
+  std::vector<Case> _cases;
+  std::unique_ptr<Game> _game;  //!< Shared by the game cases; null if the
+                                //!< video could not be initialized.
+  std::unique_ptr<BatchRenderer> _batchRenderer;  //!< Null if the tiles are
+                                                  //!< missing.
+};
@@ -0,0 +1,711 @@
+#pragma once
+
+#include "board.hpp"
+#include "solver.hpp"
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+/// @brief Helpers of BitBoard.
+namespace bitboard {
+/// @brief Returns the number of 64 bits words of a plane of width x height
+/// cells.
+constexpr std::size_t wordsCount(int width, int height) {
+  return (static_cast<std::size_t>(width) * height + 63) / 64;
+}
+
+inline int popcount(std::uint64_t x) {
+#ifdef _MSC_VER
+  return static_cast<int>(__popcnt64(x));
+#else
+  return __builtin_popcountll(x);
+#endif
+}
+
+/// @brief Returns the index of the lowest set bit of a word which is not 0.
+inline int lowestBit(std::uint64_t x) {
+#ifdef _MSC_VER
+  unsigned long index;
+  _BitScanForward64(&index, x);
+  return static_cast<int>(index);
+#else
+  return __builtin_ctzll(x);
+#endif
+}
+
+/// @brief Spreads the 8 bits of a byte over the 8 bytes of a word: bit k
+/// becomes the lowest bit of byte k.
+constexpr std::uint64_t spreadBits(std::uint64_t byte) {
+  // the multiplication copies the byte 8 times and the mask keeps bit k of
+  // copy k; then the top bit of each byte is set if the byte is not 0 (the
+  // addition never carries into the next byte)
+  const std::uint64_t kept =
+      (byte * 0x0101010101010101ull) & 0x8040201008040201ull;
+  const std::uint64_t low = 0x7F7F7F7F7F7F7F7Full;
+  return ((kept | ((kept & low) + low)) & 0x8080808080808080ull) >> 7;
+}
+
+constexpr std::array<std::uint64_t, 256> makeSpreadTable() {
+  std::array<std::uint64_t, 256> table{};
+  for (std::uint64_t byte = 0; byte < 256; byte++) {
+    table[byte] = spreadBits(byte);
+  }
+  return table;
+}
+
+/// @brief spreadBits() of every byte.
+inline constexpr std::array<std::uint64_t, 256> kSpreadTable =
+    makeSpreadTable();
+
+/// @brief Calls f with the index of each set bit of the first words of a
+/// plane, in increasing order.
+template <typename Bits, typename F>
+void forEachBit(const Bits& bits, std::size_t words, F f) {
+  for (std::size_t w = 0; w < words; w++) {
+    for (std::uint64_t x = bits[w]; x != 0; x &= x - 1) {
+      f(64 * w + static_cast<std::size_t>(lowestBit(x)));
+    }
+  }
+}
+
+/// @brief The constant planes of a board geometry.
+template <typename Bits>
+struct Masks {
+  Bits cells{};           //!< All the cells; the padding bits are 0.
+  Bits notFirstColumn{};  //!< The cells which have a western neighbour.
+  Bits notLastColumn{};   //!< The cells which have an eastern neighbour.
+};
+
+template <typename Bits>
+constexpr void fillMasks(Masks<Bits>& masks, int width, int height) {
+  for (int row = 0; row < height; row++) {
+    for (int col = 0; col < width; col++) {
+      std::size_t i = static_cast<std::size_t>(row) * width + col;
+      std::uint64_t bit = std::uint64_t{1} << (i % 64);
+      masks.cells[i / 64] |= bit;
+      if (col > 0) {
+        masks.notFirstColumn[i / 64] |= bit;
+      }
+      if (col < width - 1) {
+        masks.notLastColumn[i / 64] |= bit;
+      }
+    }
+  }
+}
+
+template <int W, int H>
+constexpr Masks<std::array<std::uint64_t, wordsCount(W, H)>> makeMasks() {
+  Masks<std::array<std::uint64_t, wordsCount(W, H)>> masks{};
+  fillMasks(masks, W, H);
+  return masks;
+}
+
+/// @brief The geometry of a board whose dimensions are known at compile
+/// time: the planes are fixed arrays and the masks are constants.
+template <int W, int H>
+class Geometry {
+ public:
+  using Bits = std::array<std::uint64_t, wordsCount(W, H)>;
+
+  static constexpr int width() { return W; }
+  static constexpr int height() { return H; }
+  static constexpr std::size_t words() { return wordsCount(W, H); }
+  static const Masks<Bits>& masks() { return kMasks; }
+
+ protected:
+  void resizeGeometry(int width, int height) {
+    assert(width == W && height == H);
+    (void)width;
+    (void)height;
+  }
+
+  static void resizeBits(Bits& bits) { bits.fill(0); }
+
+ private:
+  static constexpr Masks<Bits> kMasks = makeMasks<W, H>();
+};
+
+/// @brief The geometry of a board whose dimensions are only known at run
+/// time.
+template <>
+class Geometry<0, 0> {
+ public:
+  using Bits = std::vector<std::uint64_t>;
+
+  int width() const { return _width; }
+  int height() const { return _height; }
+  std::size_t words() const { return _words; }
+  const Masks<Bits>& masks() const { return _masks; }
+
+ protected:
+  void resizeGeometry(int width, int height) {
+    _width = width;
+    _height = height;
+    _words = wordsCount(width, height);
+    resizeBits(_masks.cells);
+    resizeBits(_masks.notFirstColumn);
+    resizeBits(_masks.notLastColumn);
+    fillMasks(_masks, width, height);
+  }
+
+  void resizeBits(Bits& bits) const { bits.assign(_words, 0); }
+
+ private:
+  int _width{0};
+  int _height{0};
+  std::size_t _words{0};
+  Masks<Bits> _masks;
+};
+}  // namespace bitboard
+
+/// @brief Headless board stored as bitboards: one plane (one bit per cell,
+/// row-major) for the mines, the revealed tiles and the flags, and four
+/// bit-sliced planes for the zone values.
+///
+/// The neighbours of all the cells of a plane are read at once by shifting
+/// the plane by one of the eight neighbour offsets and masking the cells
+/// which wrapped around a row, so neighbour counting, flood fill and the
+/// solver rules become word-wide shift, mask and add operations.
+///
+/// With W and H known at compile time the planes are fixed arrays (an
+/// advanced board takes 9 words per plane) and the shifts are constants;
+/// BitBoard<0, 0> is the runtime-sized version of the benchmarks. VectorEnv
+/// plays the difficulty levels on the fixed ones, and Solver runs its single
+/// point rule on them; both keep Board for the custom dimensions.
+///
+/// The rules match Board. The deductions are the single point rule of Solver
+/// only: Solver also looks up the pair patterns when that rule is stuck, so
+/// BitBoard::solve matches a Solver whose pair patterns are disabled.
+template <int W, int H>
+class BitBoard : public bitboard::Geometry<W, H> {
+  using Geometry = bitboard::Geometry<W, H>;
+
+ public:
+  using Bits = typename Geometry::Bits;
+
+  using Geometry::height;
+  using Geometry::masks;
+  using Geometry::width;
+  using Geometry::words;
+
+  BitBoard() { resize(W, H); }
+  BitBoard(int width, int height) { resize(width, height); }
+
+  /// @brief Changes the dimensions of the board (only BitBoard<0, 0> may
+  /// change them) and clears it.
+  void resize(int width, int height) {
+    this->resizeGeometry(width, height);
+    for (Bits* bits :
+         {&_mines, &_revealed, &_flags, &_values[0], &_values[1], &_values[2],
+          &_values[3], &_empty, &_sources[0], &_sources[1], &_region[0],
+          &_region[1], &_deduced[0], &_deduced[1]}) {
+      this->resizeBits(*bits);
+    }
+    _minesCount = 0;
+    _revealedCount = 0;
+  }
+
+  /// @brief Loads the mines of a generated board and hides all tiles.
+  /// @param tiles The zone values (row-major), as produced by BoardGenerator.
+  void setTiles(const std::vector<int>& tiles) {
+    clear();
+    const std::size_t n = cellsCount();
+    for (std::size_t w = 0; w < words(); w++) {
+      std::uint64_t mines = 0;
+      for (std::size_t i = 64 * w; i < std::min(n, 64 * w + 64); i++) {
+        mines |= std::uint64_t{tiles[i] == static_cast<int>(kMineTileValue)}
+                 << (i % 64);
+      }
+      _mines[w] = mines;
+    }
+    countMines();
+  }
+
+  /// @brief Places the mines and counts the neighbouring mines of the other
+  /// tiles. All tiles are hidden.
+  /// @param mines The (row-major) indices of the mines.
+  void setMines(const std::vector<std::size_t>& mines) {
+    clear();
+    for (std::size_t i : mines) {
+      _mines[i / 64] |= std::uint64_t{1} << (i % 64);
+    }
+    countMines();
+  }
+
+  /// @brief Loads the packed tiles of a Board of the same dimensions: the
+  /// zone values are read from the tiles, so a view whose hidden tiles hold
+  /// no mines keeps the values of its revealed tiles.
+  /// @param cells The packed tiles (see kCellValueMask, kCellRevealed and
+  /// kCellFlagged).
+  void setCells(const std::vector<std::uint8_t>& cells) {
+    const std::size_t n = cellsCount();
+    _minesCount = 0;
+    _revealedCount = 0;
+    for (std::size_t w = 0; w < words(); w++) {
+      std::uint64_t planes[7] = {0, 0, 0, 0, 0, 0, 0};
+      for (std::size_t i = 64 * w; i < std::min(n, 64 * w + 64); i++) {
+        const std::uint8_t cell = cells[i];
+        const std::uint8_t value = cell & kCellValueMask;
+        const std::uint64_t bit = std::uint64_t{1} << (i % 64);
+        if (value == kMineTileValue) {
+          planes[0] |= bit;
+        } else {
+          planes[3] |= value & 1 ? bit : 0;
+          planes[4] |= value & 2 ? bit : 0;
+          planes[5] |= value & 4 ? bit : 0;
+          planes[6] |= value & 8 ? bit : 0;
+        }
+        planes[1] |= cell & kCellRevealed ? bit : 0;
+        planes[2] |= cell & kCellFlagged ? bit : 0;
+      }
+
+      _mines[w] = planes[0];
+      _revealed[w] = planes[1];
+      _flags[w] = planes[2];
+      for (int k = 0; k < 4; k++) {
+        _values[k][w] = planes[3 + k];
+      }
+      _empty[w] = masks().cells[w] & ~(planes[0] | planes[3] | planes[4] |
+                                       planes[5] | planes[6]);
+      _minesCount += bitboard::popcount(planes[0]);
+      _revealedCount += bitboard::popcount(planes[1] & ~planes[0]);
+    }
+  }
+
+  int minesCount() const { return _minesCount; }
+  std::size_t cellsCount() const {
+    return static_cast<std::size_t>(width()) * height();
+  }
+  std::size_t revealedCount() const { return _revealedCount; }
+
+  std::size_t index(int row, int col) const {
+    return static_cast<std::size_t>(row) * width() + col;
+  }
+
+  bool isValid(int row, int col) const {
+    return row >= 0 && row < height() && col >= 0 && col < width();
+  }
+
+  int zoneValue(std::size_t i) const {
+    if (test(_mines, i)) {
+      return static_cast<int>(kMineTileValue);
+    }
+    return test(_values[0], i) | test(_values[1], i) << 1 |
+           test(_values[2], i) << 2 | test(_values[3], i) << 3;
+  }
+  bool isMine(std::size_t i) const { return test(_mines, i); }
+  bool isRevealed(std::size_t i) const { return test(_revealed, i); }
+  bool isFlagged(std::size_t i) const { return test(_flags, i); }
+
+  /// @brief Writes the tiles as the player sees them, in the layout of the
+  /// packed tiles of Board: the zone value and kCellRevealed for the
+  /// revealed tiles, kCellFlagged for the flagged ones and 0 for the other
+  /// hidden tiles.
+  /// @param out Receives cellsCount() bytes.
+  void observe(std::uint8_t* out) const {
+    using bitboard::kSpreadTable;
+    const std::size_t n = cellsCount();
+
+    // eight tiles at a time: each plane byte is spread over the 8 bytes of
+    // the tiles; the values are only read where a tile is revealed
+    for (std::size_t i = 0; i < n; i += 8) {
+      const std::size_t w = i / 64;
+      const int shift = static_cast<int>(i % 64);
+      auto plane = [w, shift](const Bits& bits) {
+        return kSpreadTable[(bits[w] >> shift) & 0xFF];
+      };
+
+      std::uint64_t cells = plane(_flags) * kCellFlagged;
+      if ((_revealed[w] >> shift) & 0xFF) {
+        const std::uint64_t revealed = plane(_revealed) * 0xFF;
+        const std::uint64_t values =
+            plane(_mines) * kMineTileValue | plane(_values[0]) |
+            plane(_values[1]) << 1 | plane(_values[2]) << 2 |
+            plane(_values[3]) << 3;
+        cells = ((values | 0x0101010101010101ull * kCellRevealed) & revealed) |
+                (cells & ~revealed);
+      }
+      std::memcpy(out + i, &cells, std::min<std::size_t>(8, n - i));
+    }
+  }
+
+  /// @brief Reveals a tile; if the tile is empty then all the touching tiles
+  /// are revealed as well.
+  /// @param row The row.
+  /// @param col The column.
+  /// @return The outcome of the reveal.
+  RevealResult reveal(int row, int col) {
+    std::size_t i = index(row, col);
+    if (test(_revealed, i) || test(_flags, i)) {
+      return RevealResult::None;
+    }
+
+    std::uint64_t bit = std::uint64_t{1} << (i % 64);
+    if (test(_mines, i)) {
+      _revealed[i / 64] |= bit;
+      return RevealResult::Mine;
+    }
+
+    _region[0][i / 64] = bit;
+    revealRegion(i / 64, i / 64);
+    return RevealResult::Revealed;
+  }
+
+  /// @brief Flags or unflags a hidden tile.
+  /// @return true if the tile changed; false otherwise.
+  bool toggleFlag(int row, int col) {
+    std::size_t i = index(row, col);
+    if (test(_revealed, i)) {
+      return false;
+    }
+    _flags[i / 64] ^= std::uint64_t{1} << (i % 64);
+    return true;
+  }
+
+  /// @brief Reveals the hidden neighbours of a revealed tile whose zone value
+  /// equals the number of its flagged neighbours, as Board::chord does.
+  /// @param row The row.
+  /// @param col The column.
+  /// @return Mine if a wrongly flagged neighbour led to a mine, Revealed if
+  /// any tile was revealed, None otherwise.
+  RevealResult chord(int row, int col) {
+    std::size_t i = index(row, col);
+    if (!test(_revealed, i) || test(_mines, i)) {
+      return RevealResult::None;
+    }
+
+    int flagged = 0;
+    for (int k = 0; k < 8; k++) {
+      int r = row + kNeighbourRows[k];
+      int c = col + kNeighbourCols[k];
+      flagged += isValid(r, c) && test(_flags, index(r, c));
+    }
+    if (flagged != zoneValue(i)) {
+      return RevealResult::None;
+    }
+
+    // the hidden neighbours: the mines are revealed as they are, the safe
+    // tiles grow through the empty tiles
+    bool mine = false;
+    std::size_t first = words();
+    std::size_t last = 0;
+    for (int k = 0; k < 8; k++) {
+      int r = row + kNeighbourRows[k];
+      int c = col + kNeighbourCols[k];
+      if (!isValid(r, c)) {
+        continue;
+      }
+      std::size_t j = index(r, c);
+      if (test(_revealed, j) || test(_flags, j)) {
+        continue;
+      }
+      std::uint64_t bit = std::uint64_t{1} << (j % 64);
+      if (test(_mines, j)) {
+        _revealed[j / 64] |= bit;
+        mine = true;
+      } else {
+        _region[0][j / 64] |= bit;
+        first = std::min(first, j / 64);
+        last = std::max(last, j / 64);
+      }
+    }
+
+    bool revealed = first <= last;
+    if (revealed) {
+      revealRegion(first, last);
+    }
+    return mine       ? RevealResult::Mine
+           : revealed ? RevealResult::Revealed
+                      : RevealResult::None;
+  }
+
+  /// @brief Moves a mine to a tile which holds none and recounts the zone
+  /// values, as Board::relocateMine does. Both tiles must be hidden; their
+  /// flags are kept.
+  /// @param from The index of the mine.
+  /// @param to The index of the new position of the mine.
+  /// @return true if the mine was moved; false if from holds no mine, if to
+  /// holds one or if a tile is revealed.
+  bool relocateMine(std::size_t from, std::size_t to) {
+    if (!isMine(from) || isMine(to) || isRevealed(from) || isRevealed(to)) {
+      return false;
+    }
+    _mines[from / 64] &= ~(std::uint64_t{1} << (from % 64));
+    _mines[to / 64] |= std::uint64_t{1} << (to % 64);
+    countMines();
+    return true;
+  }
+
+  /// @brief Checks if all the tiles which are not mines are revealed.
+  bool won() const {
+    return _revealedCount ==
+           cellsCount() - static_cast<std::size_t>(_minesCount);
+  }
+
+  /// @brief Finds the tiles which are known to be safe or mines with the
+  /// single point rule of Solver::deduce, for all the tiles at once: the
+  /// zone values of the revealed tiles are compared (bit-sliced) with the
+  /// counts of their flagged and of their hidden neighbours.
+  /// @param safe Receives the plane of the safe tiles.
+  /// @param mines Receives the plane of the mines.
+  /// @return true if any deduction was made; false otherwise.
+  bool deduce(Bits& safe, Bits& mines) const {
+    const Bits& cells = masks().cells;
+    const std::size_t n = words();
+
+    // the revealed tiles whose hidden neighbours are all safe (or all mines)
+    for (std::size_t w = 0; w < n; w++) {
+      std::uint64_t flagged[4] = {0, 0, 0, 0};
+      std::uint64_t hidden[4] = {0, 0, 0, 0};
+      for (int k = 0; k < 8; k++) {
+        add(flagged, neighbours(_flags, w, k));
+        add(hidden, neighbours(cells, w, k) & ~neighbours(_revealed, w, k) &
+                        ~neighbours(_flags, w, k));
+      }
+
+      std::uint64_t total[4];
+      sum(flagged, hidden, total);
+
+      std::uint64_t numbered = _revealed[w] & ~_mines[w];
+      _sources[0][w] = numbered & equal(_values, w, flagged);
+      _sources[1][w] = numbered & equal(_values, w, total);
+    }
+
+    // their hidden neighbours
+    bool deduced = false;
+    for (std::size_t w = 0; w < n; w++) {
+      std::uint64_t unknown = cells[w] & ~_revealed[w] & ~_flags[w];
+      std::uint64_t s = 0;
+      std::uint64_t m = 0;
+      for (int k = 0; k < 8; k++) {
+        s |= neighbours(_sources[0], w, k);
+        m |= neighbours(_sources[1], w, k);
+      }
+      safe[w] = s & unknown;
+      mines[w] = m & unknown & ~safe[w];
+      deduced = deduced || safe[w] != 0 || mines[w] != 0;
+    }
+    return deduced;
+  }
+
+  /// @brief Applies the deductions until none is left, like Solver::solve
+  /// without the pair patterns: the safe tiles are revealed and the mines are
+  /// flagged. It may get stuck where Solver goes on.
+  /// @return Won if all the safe tiles are revealed, Stuck if a guess is
+  /// needed, Lost if a wrong flag led to revealing a mine.
+  Solver::Status solve() {
+    Bits& safe = _deduced[0];
+    Bits& mines = _deduced[1];
+
+    while (!won()) {
+      if (!deduce(safe, mines)) {
+        return Solver::Status::Stuck;
+      }
+
+      bool lost = false;
+      std::size_t first = words();
+      std::size_t last = 0;
+      for (std::size_t w = 0; w < words(); w++) {
+        _flags[w] |= mines[w];
+        lost = lost || (safe[w] & _mines[w]) != 0;
+        _region[0][w] = safe[w];
+        if (safe[w] != 0) {
+          first = std::min(first, w);
+          last = w;
+        }
+      }
+
+      if (lost) {
+        for (std::size_t w = 0; w < words(); w++) {
+          _revealed[w] |= safe[w] & _mines[w];
+        }
+        return Solver::Status::Lost;
+      }
+      if (first <= last) {
+        revealRegion(first, last);
+      }
+    }
+    return Solver::Status::Won;
+  }
+
+ private:
+  /// @brief The neighbour offsets (row, column).
+  static constexpr int kNeighbourRows[8] = {0, -1, -1, -1, 0, 1, 1, 1};
+  static constexpr int kNeighbourCols[8] = {-1, -1, 0, 1, 1, 1, 0, -1};
+
+  static int test(const Bits& bits, std::size_t i) {
+    return static_cast<int>((bits[i / 64] >> (i % 64)) & 1);
+  }
+
+  /// @brief Hides and unflags all the tiles and removes the mines.
+  void clear() {
+    for (Bits* bits : {&_mines, &_revealed, &_flags, &_values[0], &_values[1],
+                       &_values[2], &_values[3], &_empty}) {
+      std::fill(bits->begin(), bits->end(), 0);
+    }
+    _minesCount = 0;
+    _revealedCount = 0;
+  }
+
+  /// @brief Computes the zone values from the mines plane.
+  void countMines() {
+    _minesCount = 0;
+    for (std::size_t w = 0; w < words(); w++) {
+      std::uint64_t count[4] = {0, 0, 0, 0};
+      for (int k = 0; k < 8; k++) {
+        add(count, neighbours(_mines, w, k));
+      }
+      for (int k = 0; k < 4; k++) {
+        _values[k][w] = count[k] & ~_mines[w];
+      }
+      _empty[w] = masks().cells[w] &
+                  ~(_mines[w] | count[0] | count[1] | count[2] | count[3]);
+      _minesCount += bitboard::popcount(_mines[w]);
+    }
+  }
+
+  /// @brief Returns the word w of a plane shifted so that each cell receives
+  /// the bit of its neighbour k (0 if it has no such neighbour).
+  ///
+  /// The bits out of [0, cellsCount()) are always 0, so only the neighbours
+  /// across the left and right edges need a mask.
+  std::uint64_t neighbours(const Bits& bits, std::size_t w, int k) const {
+    const std::ptrdiff_t offset =
+        static_cast<std::ptrdiff_t>(kNeighbourRows[k]) * width() +
+        kNeighbourCols[k];
+
+    // bit i of the result is bit 64 * w + i + offset of the plane
+    const std::ptrdiff_t q =
+        offset >= 0 ? offset / 64 : -((-offset + 63) / 64);
+    const int r = static_cast<int>(offset - q * 64);
+    const std::ptrdiff_t j = static_cast<std::ptrdiff_t>(w) + q;
+
+    std::uint64_t shifted = word(bits, j) >> r;
+    if (r != 0) {
+      shifted |= word(bits, j + 1) << (64 - r);
+    }
+
+    const Bits& mask = kNeighbourCols[k] < 0   ? masks().notFirstColumn
+                       : kNeighbourCols[k] > 0 ? masks().notLastColumn
+                                               : masks().cells;
+    return shifted & mask[w];
+  }
+
+  std::uint64_t word(const Bits& bits, std::ptrdiff_t j) const {
+    return j >= 0 && j < static_cast<std::ptrdiff_t>(words()) ? bits[j] : 0;
+  }
+
+  /// @brief Adds a bit to each of the 64 bit-sliced 4 bits counters.
+  static void add(std::uint64_t (&count)[4], std::uint64_t bits) {
+    for (int k = 0; k < 4; k++) {
+      std::uint64_t carry = count[k] & bits;
+      count[k] ^= bits;
+      bits = carry;
+    }
+  }
+
+  /// @brief Adds two bit-sliced 4 bits counters.
+  static void sum(const std::uint64_t (&a)[4], const std::uint64_t (&b)[4],
+                  std::uint64_t (&result)[4]) {
+    std::uint64_t carry = 0;
+    for (int k = 0; k < 4; k++) {
+      result[k] = a[k] ^ b[k] ^ carry;
+      carry = (a[k] & b[k]) | (carry & (a[k] ^ b[k]));
+    }
+  }
+
+  /// @brief Returns the cells of the word w whose zone value equals the
+  /// bit-sliced counter.
+  static std::uint64_t equal(const Bits (&values)[4], std::size_t w,
+                             const std::uint64_t (&count)[4]) {
+    std::uint64_t differ = 0;
+    for (int k = 0; k < 4; k++) {
+      differ |= values[k][w] ^ count[k];
+    }
+    return ~differ;
+  }
+
+  /// @brief Reveals the tiles of _region[0], whose set bits are in the
+  /// words [first, last], and grows them through the empty tiles one ring of
+  /// neighbours at a time until the region stops growing.
+  ///
+  /// A ring is a 3x3 dilation of the empty tiles of the region, done as a
+  /// horizontal then a vertical dilation. Both region planes are 0 between
+  /// the calls and only the words the region can reach are visited.
+  void revealRegion(std::size_t first, std::size_t last) {
+    // the number of words a neighbour offset spans
+    const std::size_t reach = static_cast<std::size_t>(width()) / 64 + 2;
+    const std::size_t n = words();
+    // the neighbours W, E, N and S
+    const int kWest = 0;
+    const int kEast = 4;
+    const int kNorth = 2;
+    const int kSouth = 6;
+
+    Bits& region = _region[0];
+    Bits& rows = _region[1];  // the horizontal dilation
+    for (std::size_t w = first; w <= last; w++) {
+      region[w] &= ~_revealed[w] & ~_flags[w];
+    }
+
+    std::size_t from = 0;
+    std::size_t to = 0;
+    for (bool grown = true; grown;) {
+      grown = false;
+      from = first > reach ? first - reach : 0;
+      to = std::min(last + reach, n - 1);
+
+      for (std::size_t w = from; w <= to; w++) {
+        std::uint64_t west =
+            neighbours(region, w, kWest) & neighbours(_empty, w, kWest);
+        std::uint64_t east =
+            neighbours(region, w, kEast) & neighbours(_empty, w, kEast);
+        rows[w] = (region[w] & _empty[w]) | west | east;
+      }
+
+      for (std::size_t w = from; w <= to; w++) {
+        std::uint64_t ring = rows[w] | neighbours(rows, w, kNorth) |
+                             neighbours(rows, w, kSouth);
+        std::uint64_t grow = ring & masks().cells[w] & ~region[w] &
+                             ~_revealed[w] & ~_flags[w];
+        if (grow != 0) {
+          region[w] |= grow;
+          grown = true;
+          first = std::min(first, w);
+          last = std::max(last, w);
+        }
+      }
+    }
+
+    from = first > reach ? first - reach : 0;
+    to = std::min(last + reach, n - 1);
+    for (std::size_t w = from; w <= to; w++) {
+      _revealed[w] |= region[w];
+      _revealedCount += bitboard::popcount(region[w]);
+      region[w] = 0;
+      rows[w] = 0;
+    }
+  }
+
+ private:
+  Bits _mines;       //!< The mines.
+  Bits _revealed;    //!< The revealed tiles.
+  Bits _flags;       //!< The flagged tiles.
+  Bits _values[4];   //!< The bit-sliced zone values (0 on the mines).
+  Bits _empty;       //!< The tiles whose zone value is 0.
+  int _minesCount{0};
+  std::size_t _revealedCount{0};
+
+  mutable Bits _sources[2];  //!< Scratch planes of deduce().
+  Bits _region[2];           //!< Scratch planes of the flood fill.
+  Bits _deduced[2];          //!< Scratch planes of solve().
+};
+
+/// The boards of the difficulty levels.
+using BeginnerBitBoard = BitBoard<9, 9>;
+using IntermediateBitBoard = BitBoard<16, 16>;
+using AdvancedBitBoard = BitBoard<24, 24>;
+
+/// The runtime-sized board, for the custom dimensions.
+using DynamicBitBoard = BitBoard<0, 0>;
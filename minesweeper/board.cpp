@@ -0,0 +1,174 @@
+// clang-format off
+#include "pch.h"
+#include "board.hpp"
+
+// clang-format on
+
+template <typename Topology>
+BasicBoard<Topology>::BasicBoard(int size, int minesCount)
+    : _size{size}, _minesCount{minesCount}, _revealedCount{0} {
+  std::size_t sz = size;
+  _cells.resize(sz * sz);
+}
+
+template <typename Topology>
+void BasicBoard<Topology>::setTiles(int size, const std::vector<int>& tiles) {
+  _size = size;
+  _cells.resize(tiles.size());
+  // the flood fill holds each tile once at most: revealing never allocates
+  _stack.reserve(tiles.size());
+  _revealedCount = 0;
+  _minesCount = 0;
+
+  for (std::size_t i = 0; i < tiles.size(); i++) {
+    _cells[i] = static_cast<std::uint8_t>(tiles[i]);
+    if (tiles[i] == kMineTileValue) {
+      _minesCount++;
+    }
+  }
+}
+
+template <typename Topology>
+void BasicBoard<Topology>::setMines(const std::vector<std::size_t>& mines) {
+  std::fill(_cells.begin(), _cells.end(), 0);
+  _minesCount = static_cast<int>(mines.size());
+  _revealedCount = 0;
+
+  for (std::size_t i : mines) {
+    _cells[i] = kMineTileValue;
+  }
+
+  for (std::size_t i : mines) {
+    int row = static_cast<int>(i / _size);
+    int col = static_cast<int>(i % _size);
+
+    Topology::forEachNeighbour(row, col, _size, [this](int r, int c) {
+      if (!isMine(index(r, c))) {
+        _cells[index(r, c)]++;
+      }
+    });
+  }
+}
+
+template <typename Topology>
+RevealResult BasicBoard<Topology>::reveal(int row, int col) {
+  std::size_t i = index(row, col);
+  if (_cells[i] & (kCellRevealed | kCellFlagged)) {
+    return RevealResult::None;
+  }
+
+  JournalScope action(_journal);
+  if (isMine(i)) {
+    setCell(i, static_cast<std::uint8_t>(_cells[i] | kCellRevealed));
+    return RevealResult::Mine;
+  }
+
+  floodFill(i);
+  return RevealResult::Revealed;
+}
+
+template <typename Topology>
+RevealResult BasicBoard<Topology>::chord(int row, int col) {
+  std::size_t i = index(row, col);
+  if (!isRevealed(i) || isMine(i)) {
+    return RevealResult::None;
+  }
+
+  int flagged = 0;
+  Topology::forEachNeighbour(row, col, _size, [&](int r, int c) {
+    if (isFlagged(index(r, c))) {
+      flagged++;
+    }
+  });
+
+  if (flagged != zoneValue(i)) {
+    return RevealResult::None;
+  }
+
+  JournalScope action(_journal);
+  RevealResult result = RevealResult::None;
+  Topology::forEachNeighbour(row, col, _size, [&](int r, int c) {
+    RevealResult revealed = reveal(r, c);
+    if (revealed == RevealResult::Mine) {
+      result = RevealResult::Mine;
+    } else if (revealed == RevealResult::Revealed &&
+               result == RevealResult::None) {
+      result = RevealResult::Revealed;
+    }
+  });
+  return result;
+}
+
+template <typename Topology>
+bool BasicBoard<Topology>::toggleFlag(int row, int col) {
+  std::size_t i = index(row, col);
+  if (isRevealed(i)) {
+    return false;
+  }
+  JournalScope action(_journal);
+  setCell(i, static_cast<std::uint8_t>(_cells[i] ^ kCellFlagged));
+  return true;
+}
+
+template <typename Topology>
+bool BasicBoard<Topology>::relocateMine(std::size_t from, std::size_t to) {
+  if (!isMine(from) || isMine(to) || isRevealed(from) || isRevealed(to)) {
+    return false;
+  }
+
+  JournalScope action(_journal);
+  relocateMineCells<Topology>(
+      _size, from, to, [this](std::size_t i) { return _cells[i]; },
+      [this](std::size_t i, std::uint8_t cell) { setCell(i, cell); });
+  return true;
+}
+
+template <typename Topology>
+void BasicBoard<Topology>::restoreCell(std::size_t i, std::uint8_t cell) {
+  // the revealed count only counts the tiles which are not mines
+  auto revealedSafe = [](std::uint8_t c) {
+    return (c & kCellRevealed) && (c & kCellValueMask) != kMineTileValue;
+  };
+
+  _revealedCount -= revealedSafe(_cells[i]);
+  _revealedCount += revealedSafe(cell);
+  _minesCount -= isMine(i);
+  _cells[i] = cell;
+  _minesCount += isMine(i);
+}
+
+template <typename Topology>
+void BasicBoard<Topology>::floodFill(std::size_t start) {
+  _stack.clear();
+  _stack.push_back(start);
+  setCell(start, static_cast<std::uint8_t>(_cells[start] | kCellRevealed));
+  _revealedCount++;
+
+  while (!_stack.empty()) {
+    std::size_t i = _stack.back();
+    _stack.pop_back();
+
+    if (zoneValue(i) != 0) {
+      continue;
+    }
+
+    int row = static_cast<int>(i / _size);
+    int col = static_cast<int>(i % _size);
+
+    Topology::forEachNeighbour(row, col, _size, [this](int r, int c) {
+      std::size_t j = index(r, c);
+      if (_cells[j] & (kCellRevealed | kCellFlagged)) {
+        return;
+      }
+
+      setCell(j, static_cast<std::uint8_t>(_cells[j] | kCellRevealed));
+      _revealedCount++;
+      _stack.push_back(j);
+    });
+  }
+}
+
+template class BasicBoard<SquareTopology>;
+template class BasicBoard<TorusTopology>;
+template class BasicBoard<HexTopology>;
+template class BasicBoard<KnightTopology>;
@@ -0,0 +1,193 @@
+#pragma once
+
+#include "boardgenerator.hpp"
+#include "journal.hpp"
+#include "structs.hpp"
+#include "topology.hpp"
+
+/// @brief The layout of a packed board cell: the low nibble holds the zone
+/// value (0: empty space; 1-8: the number of neighbours; 9: mine), the high
+/// bits hold the state of the tile as seen by the player.
+const std::uint8_t kCellValueMask = 0x0F;
+const std::uint8_t kCellRevealed = 0x10;
+const std::uint8_t kCellFlagged = 0x20;
+
+/// @brief Marks the mine which ended the game. Set by Game in the packed
+/// tiles of its journal and frames and drawn by the renderers; boards
+/// ignore it.
+const std::uint8_t kCellExploded = 0x40;
+
+/// @brief The outcome of revealing a tile.
+enum class RevealResult {
+  None,      //!< Nothing changed (the tile is revealed or flagged).
+  Revealed,  //!< One or more tiles were revealed.
+  Mine       //!< The tile holds a mine.
+};
+
+/// @brief Moves a mine to a tile which holds none and updates the zone values
+/// around both tiles, on any storage of packed cells: BasicBoard and Game
+/// (which keeps its tiles in entities) share it.
+/// @param size The dimension of the board.
+/// @param from The index of the mine.
+/// @param to The index of the new position of the mine.
+/// @param cell Returns the packed cell of an index.
+/// @param setCell Writes the packed cell of an index.
+template <typename Topology, typename Cell, typename SetCell>
+void relocateMineCells(int size, std::size_t from, std::size_t to, Cell cell,
+                       SetCell setCell) {
+  auto isMine = [&cell](std::size_t i) {
+    return (cell(i) & kCellValueMask) == kMineTileValue;
+  };
+
+  setCell(to, static_cast<std::uint8_t>((cell(to) & ~kCellValueMask) |
+                                        kMineTileValue));
+
+  auto shift = [&](std::size_t i, int delta) {
+    int row = static_cast<int>(i / size);
+    int col = static_cast<int>(i % size);
+    Topology::forEachNeighbour(row, col, size, [&](int r, int c) {
+      std::size_t j = static_cast<std::size_t>(r) * size + c;
+      if (!isMine(j)) {
+        setCell(j, static_cast<std::uint8_t>(cell(j) + delta));
+      }
+    });
+  };
+  shift(from, -1);
+  shift(to, 1);
+
+  // the old position counts the mines around it, the moved one included
+  int mines = 0;
+  int row = static_cast<int>(from / size);
+  int col = static_cast<int>(from % size);
+  Topology::forEachNeighbour(row, col, size, [&](int r, int c) {
+    if (isMine(static_cast<std::size_t>(r) * size + c)) {
+      mines++;
+    }
+  });
+  setCell(from, static_cast<std::uint8_t>((cell(from) & ~kCellValueMask) |
+                                          mines));
+}
+
+/// @brief Headless board: the game rules without any rendering.
+///
+/// The tiles are stored row-major, one byte per tile. The buffers are reused
+/// across boards of the same (or a smaller) size. The neighbours of a tile
+/// are given by the Topology policy (see topology.hpp); the member functions
+/// are instantiated for each policy in board.cpp. With a journal attached,
+/// each reveal, chord, flag and mine relocation is recorded as one action
+/// which the journal can undo and redo.
+template <typename Topology>
+class BasicBoard {
+  friend class ParallelReveal;
+
+ public:
+  using TopologyType = Topology;
+
+  BasicBoard() : _size{0}, _minesCount{0}, _revealedCount{0} {}
+  BasicBoard(int size, int minesCount);
+
+  /// @brief Loads the zone values of a generated board and hides all tiles.
+  /// @param size The dimension of the board.
+  /// @param tiles The zone values, as produced by BoardGenerator.
+  void setTiles(int size, const std::vector<int>& tiles);
+
+  /// @brief Places the mines and computes the zone values of the other tiles.
+  /// All tiles are hidden.
+  /// @param mines The (row-major) indices of the mines.
+  void setMines(const std::vector<std::size_t>& mines);
+
+  int size() const { return _size; }
+  int minesCount() const { return _minesCount; }
+  std::size_t cellsCount() const { return _cells.size(); }
+  std::size_t revealedCount() const { return _revealedCount; }
+
+  /// @brief Returns the packed tiles (see kCellValueMask, kCellRevealed and
+  /// kCellFlagged).
+  const std::vector<std::uint8_t>& cells() const { return _cells; }
+
+  std::size_t index(int row, int col) const {
+    return static_cast<std::size_t>(row) * _size + col;
+  }
+
+  bool isValid(int row, int col) const {
+    return row >= 0 && row < _size && col >= 0 && col < _size;
+  }
+
+  std::uint8_t cell(std::size_t i) const { return _cells[i]; }
+  int zoneValue(std::size_t i) const { return _cells[i] & kCellValueMask; }
+  bool isMine(std::size_t i) const {
+    return (_cells[i] & kCellValueMask) == kMineTileValue;
+  }
+  bool isRevealed(std::size_t i) const { return _cells[i] & kCellRevealed; }
+  bool isFlagged(std::size_t i) const { return _cells[i] & kCellFlagged; }
+
+  /// @brief Reveals a tile; if the tile is empty then all the touching tiles
+  /// are revealed as well.
+  /// @param row The row.
+  /// @param col The column.
+  /// @return The outcome of the reveal.
+  RevealResult reveal(int row, int col);
+
+  /// @brief Reveals the hidden neighbours of a revealed tile whose zone value
+  /// equals the number of its flagged neighbours.
+  /// @param row The row.
+  /// @param col The column.
+  /// @return Mine if a wrongly flagged neighbour led to a mine, Revealed if
+  /// any tile was revealed, None otherwise.
+  RevealResult chord(int row, int col);
+
+  /// @brief Flags or unflags a hidden tile.
+  /// @return true if the tile changed; false otherwise.
+  bool toggleFlag(int row, int col);
+
+  /// @brief Moves a mine to a tile which holds none and updates the zone
+  /// values around both tiles (e.g. so that the first click is never on a
+  /// mine). Both tiles must be hidden; their flags are kept.
+  /// @param from The index of the mine.
+  /// @param to The index of the new position of the mine.
+  /// @return true if the mine was moved; false if from holds no mine, if to
+  /// holds one or if a tile is revealed.
+  bool relocateMine(std::size_t from, std::size_t to);
+
+  /// @brief Records the following actions into a journal. The journal is not
+  /// owned and should be cleared when the board is reloaded; the copies of
+  /// the board record into the same journal.
+  /// @param journal The journal; null to stop recording.
+  void setJournal(BoardJournal* journal) { _journal = journal; }
+
+  /// @brief Overwrites a packed tile without recording it (used by
+  /// BoardJournal to undo and redo the actions).
+  /// @param i The index of the tile.
+  /// @param cell The packed tile.
+  void restoreCell(std::size_t i, std::uint8_t cell);
+
+  /// @brief Checks if all the tiles which are not mines are revealed.
+  bool won() const {
+    return _revealedCount ==
+           _cells.size() - static_cast<std::size_t>(_minesCount);
+  }
+
+ private:
+  /// @brief Reveals the region of empty tiles containing the given tile and
+  /// its border (iterative; no recursion).
+  void floodFill(std::size_t start);
+
+  /// @brief Changes a packed tile, recording the change in the journal.
+  void setCell(std::size_t i, std::uint8_t cell) {
+    if (_journal) {
+      _journal->record(i, _cells[i], cell);
+    }
+    _cells[i] = cell;
+  }
+
+ private:
+  std::vector<std::uint8_t> _cells;  //!< The packed tiles.
+  std::vector<std::size_t> _stack;   //!< The flood fill work list.
+  int _size;                         //!< The dimension of the board.
+  int _minesCount;                   //!< The number of mines.
+  std::size_t _revealedCount;        //!< The number of revealed tiles.
+  BoardJournal* _journal{nullptr};   //!< Records the actions, if any.
+};
+
+/// The classic board.
+using Board = BasicBoard<SquareTopology>;
@@ -0,0 +1,559 @@
+// clang-format off
+#include "pch.h"
+#include "board.hpp"
+#include "threadpool.hpp"
+#include "boardcodec.hpp"
+
+// clang-format on
+
+namespace {
+/// A big number: 32-bit limbs, least significant first, without leading
+/// zero limbs (zero has no limbs).
+using Limbs = std::vector<std::uint32_t>;
+
+void setSmall(Limbs& a, std::uint32_t value) {
+  a.clear();
+  if (value != 0) {
+    a.push_back(value);
+  }
+}
+
+void trim(Limbs& a) {
+  while (!a.empty() && a.back() == 0) {
+    a.pop_back();
+  }
+}
+
+/// @brief Multiplies by m and divides by d; the quotient must be exact.
+///
+/// The quotient is built from the least significant limb up, together with
+/// the product: dividing exactly by an odd number is a multiplication by its
+/// inverse modulo 2^32 (Jebelean), much cheaper than a hardware division,
+/// and the powers of two of d are shifted out at the end.
+void multiplyDivide(Limbs& a, std::uint32_t m, std::uint32_t d) {
+  int shift = 0;
+  while (!(d & 1)) {
+    d >>= 1;
+    shift++;
+  }
+
+  // Newton's iteration doubles the correct low bits: 3, 6, 12, 24, 48
+  std::uint32_t inverse = d;
+  for (int i = 0; i < 4; i++) {
+    inverse *= 2 - d * inverse;
+  }
+
+  std::uint64_t carry = 0;
+  std::uint32_t borrow = 0;
+  auto divideLimb = [d, inverse, &borrow](std::uint32_t limb) {
+    std::uint32_t x = limb - borrow;
+    borrow = limb < borrow ? 1 : 0;
+    std::uint32_t q = x * inverse;
+    borrow += static_cast<std::uint32_t>(
+        (static_cast<std::uint64_t>(q) * d) >> 32);
+    return q;
+  };
+
+  for (std::uint32_t& limb : a) {
+    std::uint64_t product = static_cast<std::uint64_t>(limb) * m + carry;
+    carry = product >> 32;
+    limb = divideLimb(static_cast<std::uint32_t>(product));
+  }
+  if (carry != 0) {
+    a.push_back(divideLimb(static_cast<std::uint32_t>(carry)));
+  }
+
+  if (shift != 0) {
+    for (std::size_t k = 0; k < a.size(); k++) {
+      std::uint32_t high = k + 1 < a.size() ? a[k + 1] << (32 - shift) : 0;
+      a[k] = (a[k] >> shift) | high;
+    }
+  }
+  trim(a);
+}
+
+void add(Limbs& a, const Limbs& b) {
+  if (a.size() < b.size()) {
+    a.resize(b.size(), 0);
+  }
+
+  std::uint64_t carry = 0;
+  for (std::size_t k = 0; k < a.size(); k++) {
+    if (k >= b.size() && carry == 0) {
+      return;
+    }
+    std::uint64_t sum = a[k] + carry + (k < b.size() ? b[k] : 0);
+    a[k] = static_cast<std::uint32_t>(sum);
+    carry = sum >> 32;
+  }
+  if (carry != 0) {
+    a.push_back(static_cast<std::uint32_t>(carry));
+  }
+}
+
+/// @brief Subtracts b from a; a must not be smaller than b.
+void subtract(Limbs& a, const Limbs& b) {
+  std::uint32_t borrow = 0;
+  for (std::size_t k = 0; k < a.size(); k++) {
+    if (k >= b.size() && borrow == 0) {
+      break;
+    }
+    std::uint64_t sub =
+        static_cast<std::uint64_t>(k < b.size() ? b[k] : 0) + borrow;
+    borrow = a[k] < sub ? 1 : 0;
+    a[k] = static_cast<std::uint32_t>(a[k] - sub);
+  }
+  trim(a);
+}
+
+void decrement(Limbs& a) {
+  for (std::uint32_t& limb : a) {
+    if (limb-- != 0) {
+      break;
+    }
+  }
+  trim(a);
+}
+
+/// @brief Returns -1, 0 or 1 as a is smaller than, equal to or greater than
+/// b.
+int compare(const Limbs& a, const Limbs& b) {
+  if (a.size() != b.size()) {
+    return a.size() < b.size() ? -1 : 1;
+  }
+  for (std::size_t k = a.size(); k > 0; k--) {
+    if (a[k - 1] != b[k - 1]) {
+      return a[k - 1] < b[k - 1] ? -1 : 1;
+    }
+  }
+  return 0;
+}
+
+std::size_t bitLength(const Limbs& a) {
+  if (a.empty()) {
+    return 0;
+  }
+  std::size_t bits = (a.size() - 1) * 32;
+  for (std::uint32_t top = a.back(); top != 0; top >>= 1) {
+    bits++;
+  }
+  return bits;
+}
+
+/// @brief Sets a to the binomial coefficient C(n, k).
+void binomial(Limbs& a, std::size_t n, std::size_t k) {
+  if (k > n) {
+    a.clear();
+    return;
+  }
+  k = std::min(k, n - k);
+
+  // C(n - k + j, j) after each step: every division is exact
+  setSmall(a, 1);
+  for (std::size_t j = 1; j <= k; j++) {
+    multiplyDivide(a, static_cast<std::uint32_t>(n - k + j),
+                   static_cast<std::uint32_t>(j));
+  }
+}
+
+std::size_t varintSize(std::uint64_t value) {
+  std::size_t bytes = 1;
+  while (value >= 0x80) {
+    value >>= 7;
+    bytes++;
+  }
+  return bytes;
+}
+
+std::uint8_t* writeVarint(std::uint8_t* out, std::uint64_t value) {
+  while (value >= 0x80) {
+    *out++ = static_cast<std::uint8_t>(value | 0x80);
+    value >>= 7;
+  }
+  *out++ = static_cast<std::uint8_t>(value);
+  return out;
+}
+
+/// @return The next byte to read; null if the varint is truncated, too long
+/// or not in its shortest form (a last byte of zero after the first one).
+const std::uint8_t* readVarint(const std::uint8_t* in, const std::uint8_t* end,
+                               std::uint64_t& value) {
+  value = 0;
+  for (int shift = 0; shift < 64 && in < end; shift += 7) {
+    std::uint8_t byte = *in++;
+    value |= static_cast<std::uint64_t>(byte & 0x7F) << shift;
+    if (!(byte & 0x80)) {
+      return byte != 0 || shift == 0 ? in : nullptr;
+    }
+  }
+  return nullptr;
+}
+}  // namespace
+
+std::size_t BoardCodec::encodedSize(int size, std::size_t mines,
+                                    Format& format) {
+  std::size_t cells = static_cast<std::size_t>(size) * size;
+  std::size_t payload = (cells + 7) / 8;
+  format = Format::Bitmap;
+
+  if (cells <= kMaxRankCells && rankBytes(cells, mines) < payload) {
+    payload = rankBytes(cells, mines);
+    format = Format::Rank;
+  }
+
+  return 1 + varintSize(static_cast<std::uint64_t>(size)) +
+         varintSize(mines) + payload;
+}
+
+std::size_t BoardCodec::encode(const std::uint8_t* cells, int size,
+                               std::uint8_t* record) {
+  std::size_t n = static_cast<std::size_t>(size) * size;
+  auto isMine = [cells](std::size_t i) {
+    return (cells[i] & kCellValueMask) == kMineTileValue;
+  };
+
+  std::size_t mines = 0;
+  for (std::size_t i = 0; i < n; i++) {
+    mines += isMine(i);
+  }
+
+  Format format;
+  std::size_t recordSize = encodedSize(size, mines, format);
+
+  std::uint8_t* out = record;
+  *out++ = static_cast<std::uint8_t>(format);
+  out = writeVarint(out, static_cast<std::uint64_t>(size));
+  out = writeVarint(out, mines);
+  std::size_t payload = static_cast<std::size_t>(record + recordSize - out);
+  std::memset(out, 0, payload);
+
+  if (format == Format::Bitmap) {
+    for (std::size_t i = 0; i < n; i++) {
+      if (isMine(i)) {
+        out[i / 8] |= static_cast<std::uint8_t>(1 << (i % 8));
+      }
+    }
+    return recordSize;
+  }
+
+  // the sum of C(c, k) over the k-th mine c, keeping _binomial = C(i, k)
+  // while scanning the tiles i
+  _rank.reserve(n / 32 + 2);
+  _binomial.reserve(n / 32 + 2);
+  _rank.clear();
+  _binomial.clear();
+  std::size_t k = 1;
+
+  for (std::size_t i = 0; i < n && k <= mines; i++) {
+    if (isMine(i)) {
+      add(_rank, _binomial);
+      // C(i, k + 1) = C(i, k) * (i - k) / (k + 1)
+      if (i > k) {
+        multiplyDivide(_binomial, static_cast<std::uint32_t>(i - k),
+                       static_cast<std::uint32_t>(k + 1));
+      } else {
+        _binomial.clear();
+      }
+      k++;
+    }
+
+    // C(i + 1, k) = C(i, k) * (i + 1) / (i + 1 - k)
+    if (i + 1 == k) {
+      setSmall(_binomial, 1);
+    } else if (i + 1 > k) {
+      multiplyDivide(_binomial, static_cast<std::uint32_t>(i + 1),
+                     static_cast<std::uint32_t>(i + 1 - k));
+    }
+  }
+
+  for (std::size_t b = 0; b < payload; b++) {
+    std::size_t limb = b / 4;
+    if (limb < _rank.size()) {
+      out[b] = static_cast<std::uint8_t>(_rank[limb] >> (8 * (b % 4)));
+    }
+  }
+  return recordSize;
+}
+
+std::size_t BoardCodec::decodeMines(const std::uint8_t* record,
+                                    std::size_t length, int& size,
+                                    std::vector<std::size_t>& mines) {
+  std::size_t recordSize = read(record, length, size);
+  if (recordSize != 0) {
+    mines.assign(_mines.begin(), _mines.end());
+  }
+  return recordSize;
+}
+
+template <typename Topology>
+std::size_t BoardCodec::decode(const std::uint8_t* record, std::size_t length,
+                               int& size, std::vector<std::uint8_t>& cells) {
+  std::size_t recordSize = read(record, length, size);
+  if (recordSize != 0 && size < Topology::kMinSize) {
+    return 0;
+  }
+  if (recordSize != 0) {
+    cells.resize(static_cast<std::size_t>(size) * size);
+    fillCells<Topology>(size, cells.data());
+  }
+  return recordSize;
+}
+
+void BoardCodec::encodeBatch(ThreadPool& pool, const std::uint8_t* cells,
+                             int size, std::size_t count,
+                             std::vector<std::uint8_t>& records,
+                             std::vector<std::size_t>& offsets) {
+  std::vector<std::unique_ptr<BoardCodec>> codecs;
+  for (std::size_t w = 0; w < pool.size(); w++) {
+    codecs.emplace_back(std::make_unique<BoardCodec>());
+  }
+
+  // the sizes first, so that each record is then encoded in place
+  std::size_t n = static_cast<std::size_t>(size) * size;
+  std::size_t total = 0;
+  offsets.resize(count);
+  for (std::size_t b = 0; b < count; b++) {
+    const std::uint8_t* board = cells + b * n;
+    std::size_t mines = 0;
+    for (std::size_t i = 0; i < n; i++) {
+      mines += (board[i] & kCellValueMask) == kMineTileValue;
+    }
+
+    Format format;
+    offsets[b] = total;
+    total += codecs[0]->encodedSize(size, mines, format);
+  }
+
+  records.resize(total);
+  pool.parallelFor(count, [&](std::size_t b, std::size_t worker) {
+    codecs[worker]->encode(cells + b * n, size, records.data() + offsets[b]);
+  });
+}
+
+template <typename Topology>
+std::size_t BoardCodec::decodeBatch(ThreadPool& pool,
+                                    const std::uint8_t* records,
+                                    std::size_t length, int& size,
+                                    std::vector<std::uint8_t>& cells) {
+  std::vector<std::unique_ptr<BoardCodec>> codecs;
+  for (std::size_t w = 0; w < pool.size(); w++) {
+    codecs.emplace_back(std::make_unique<BoardCodec>());
+  }
+
+  // the records are found from their headers, then decoded in parallel
+  std::vector<std::size_t> offsets;
+  size = 0;
+  for (std::size_t offset = 0; offset < length;) {
+    Format format;
+    int dimension;
+    std::size_t mines;
+    std::size_t header = readHeader(records + offset, length - offset, format,
+                                    dimension, mines);
+    if (header == 0 || dimension < Topology::kMinSize ||
+        (size != 0 && dimension != size)) {
+      return 0;
+    }
+    size = dimension;
+
+    std::size_t payload;
+    if (!codecs[0]->payloadSize(size, mines, format, payload) ||
+        header + payload > length - offset) {
+      return 0;
+    }
+    offsets.push_back(offset);
+    offset += header + payload;
+  }
+
+  std::size_t n = static_cast<std::size_t>(size) * size;
+  cells.resize(offsets.size() * n);
+  std::atomic<bool> valid{true};
+
+  pool.parallelFor(offsets.size(), [&](std::size_t b, std::size_t worker) {
+    BoardCodec& codec = *codecs[worker];
+    int dimension;
+    if (codec.read(records + offsets[b], length - offsets[b], dimension) ==
+        0) {
+      valid.store(false, std::memory_order_relaxed);
+      return;
+    }
+    codec.fillCells<Topology>(size, cells.data() + b * n);
+  });
+
+  return valid.load() ? offsets.size() : 0;
+}
+
+std::size_t BoardCodec::readHeader(const std::uint8_t* record,
+                                   std::size_t length, Format& format,
+                                   int& size, std::size_t& mines) {
+  const std::uint8_t* end = record + length;
+  if (length == 0 || record[0] > static_cast<std::uint8_t>(Format::Bitmap)) {
+    return 0;
+  }
+  format = static_cast<Format>(record[0]);
+
+  std::uint64_t dimension;
+  std::uint64_t minesCount;
+  const std::uint8_t* in = readVarint(record + 1, end, dimension);
+  if (in == nullptr || dimension == 0 || dimension > UINT16_MAX) {
+    return 0;
+  }
+  in = readVarint(in, end, minesCount);
+  if (in == nullptr || minesCount > dimension * dimension) {
+    return 0;
+  }
+  if (format == Format::Rank && dimension * dimension > kMaxRankCells) {
+    return 0;
+  }
+
+  size = static_cast<int>(dimension);
+  mines = static_cast<std::size_t>(minesCount);
+  return static_cast<std::size_t>(in - record);
+}
+
+bool BoardCodec::payloadSize(int size, std::size_t mines, Format format,
+                             std::size_t& payload) {
+  Format expected;
+  payload = encodedSize(size, mines, expected) - 1 -
+            varintSize(static_cast<std::uint64_t>(size)) - varintSize(mines);
+  return format == expected;
+}
+
+std::size_t BoardCodec::rankBytes(std::size_t cells, std::size_t mines) {
+  if (cells != _rankCells || mines != _rankMines) {
+    // the largest rank is C(cells, mines) - 1
+    binomial(_binomial, cells, mines);
+    decrement(_binomial);
+
+    _rankCells = cells;
+    _rankMines = mines;
+    _rankBytes = (bitLength(_binomial) + 7) / 8;
+  }
+  return _rankBytes;
+}
+
+bool BoardCodec::decodePayload(const std::uint8_t* payload, Format format,
+                               std::size_t cells, std::size_t mines) {
+  _mines.resize(mines);
+
+  if (format == Format::Bitmap) {
+    std::size_t found = 0;
+    for (std::size_t i = 0; i < cells; i++) {
+      if (payload[i / 8] & (1 << (i % 8))) {
+        if (found == mines) {
+          return false;
+        }
+        _mines[found++] = i;
+      }
+    }
+    // the padding bits of the last byte are zero
+    if (cells % 8 != 0 && (payload[cells / 8] >> (cells % 8)) != 0) {
+      return false;
+    }
+    return found == mines;
+  }
+
+  std::size_t bytes = rankBytes(cells, mines);
+  _rank.assign((bytes + 3) / 4, 0);
+  for (std::size_t b = 0; b < bytes; b++) {
+    _rank[b / 4] |= static_cast<std::uint32_t>(payload[b]) << (8 * (b % 4));
+  }
+  trim(_rank);
+  if (mines == 0) {
+    return _rank.empty();
+  }
+
+  // from the last mine down: the k-th mine is the largest c whose C(c, k)
+  // does not exceed the rest of the rank, keeping _binomial = C(c, k)
+  _binomial.reserve(cells / 32 + 2);
+  binomial(_binomial, cells - 1, mines);
+  std::size_t c = cells - 1;
+
+  for (std::size_t k = mines; k > 0; k--) {
+    while (compare(_binomial, _rank) > 0) {
+      // C(c - 1, k) = C(c, k) * (c - k) / c
+      if (c > k) {
+        multiplyDivide(_binomial, static_cast<std::uint32_t>(c - k),
+                       static_cast<std::uint32_t>(c));
+      } else {
+        _binomial.clear();
+      }
+      c--;
+    }
+
+    _mines[k - 1] = c;
+    subtract(_rank, _binomial);
+    if (k == 1) {
+      break;
+    }
+
+    // C(c - 1, k - 1) = C(c, k) * k / c; zero stays zero
+    if (!_binomial.empty()) {
+      multiplyDivide(_binomial, static_cast<std::uint32_t>(k),
+                     static_cast<std::uint32_t>(c));
+    }
+    c--;
+  }
+
+  // a rank beyond the last one leaves a remainder
+  return _rank.empty();
+}
+
+std::size_t BoardCodec::read(const std::uint8_t* record, std::size_t length,
+                             int& size) {
+  Format format;
+  std::size_t mines;
+  std::size_t header = readHeader(record, length, format, size, mines);
+  if (header == 0) {
+    return 0;
+  }
+
+  std::size_t n = static_cast<std::size_t>(size) * size;
+  std::size_t payload;
+  if (!payloadSize(size, mines, format, payload) ||
+      header + payload > length ||
+      !decodePayload(record + header, format, n, mines)) {
+    return 0;
+  }
+  return header + payload;
+}
+
+template <typename Topology>
+void BoardCodec::fillCells(int size, std::uint8_t* cells) const {
+  std::memset(cells, 0, static_cast<std::size_t>(size) * size);
+  for (std::size_t i : _mines) {
+    cells[i] = kMineTileValue;
+  }
+
+  for (std::size_t i : _mines) {
+    int row = static_cast<int>(i / size);
+    int col = static_cast<int>(i % size);
+    Topology::forEachNeighbour(row, col, size, [cells, size](int r, int c) {
+      std::size_t j = static_cast<std::size_t>(r) * size + c;
+      if (cells[j] != kMineTileValue) {
+        cells[j]++;
+      }
+    });
+  }
+}
+
+template std::size_t BoardCodec::decode<SquareTopology>(
+    const std::uint8_t*, std::size_t, int&, std::vector<std::uint8_t>&);
+template std::size_t BoardCodec::decode<TorusTopology>(
+    const std::uint8_t*, std::size_t, int&, std::vector<std::uint8_t>&);
+template std::size_t BoardCodec::decode<HexTopology>(
+    const std::uint8_t*, std::size_t, int&, std::vector<std::uint8_t>&);
+template std::size_t BoardCodec::decode<KnightTopology>(
+    const std::uint8_t*, std::size_t, int&, std::vector<std::uint8_t>&);
+
+template std::size_t BoardCodec::decodeBatch<SquareTopology>(
+    ThreadPool&, const std::uint8_t*, std::size_t, int&,
+    std::vector<std::uint8_t>&);
+template std::size_t BoardCodec::decodeBatch<TorusTopology>(
+    ThreadPool&, const std::uint8_t*, std::size_t, int&,
+    std::vector<std::uint8_t>&);
+template std::size_t BoardCodec::decodeBatch<HexTopology>(
+    ThreadPool&, const std::uint8_t*, std::size_t, int&,
+    std::vector<std::uint8_t>&);
+template std::size_t BoardCodec::decodeBatch<KnightTopology>(
+    ThreadPool&, const std::uint8_t*, std::size_t, int&,
+    std::vector<std::uint8_t>&);
@@ -0,0 +1,141 @@
+#pragma once
+
+#include "topology.hpp"
+
+class ThreadPool;
+
+/// @brief Encodes boards (their mines) into compact byte records and back.
+///
+/// A record is the format byte, the dimension of the board and the number
+/// of mines (as varints), then the payload:
+///   - Rank: the rank of the set of mines in the combinatorial number system
+///     (little endian, in the fewest bytes holding any rank of the board
+///     dimension and mines count). The mines c1 < c2 < ... < cm have the rank
+///     C(c1, 1) + C(c2, 2) + ... + C(cm, m), a number below C(n, m): an
+///     advanced board (24x24, 99 mines) takes 51 bytes, 76 as a bitmap.
+///   - Bitmap: one bit per tile, row-major, least significant bit first.
+/// The rank is never longer than the bitmap, but it costs time quadratic in
+/// the dimension of the board, so the large boards are stored as bitmaps.
+/// The records are self-delimiting and can be concatenated. Each board has
+/// a single record: the decoder rejects the format encode() would not pick,
+/// the varints which are not in their shortest form, the ranks beyond the
+/// last one and the bitmaps with a bit set past the last tile.
+///
+/// The zone values are not stored: they are computed again when decoding,
+/// for the topology of the board. A codec keeps its scratch numbers, so a
+/// long lived codec does not allocate once it has seen the largest board.
+class BoardCodec {
+ public:
+  enum class Format : std::uint8_t { Rank = 0, Bitmap = 1 };
+
+  /// The largest number of tiles stored as a rank: 64x64 boards.
+  static constexpr std::size_t kMaxRankCells = 4096;
+
+  BoardCodec() = default;
+
+  BoardCodec(const BoardCodec&) = delete;
+  BoardCodec& operator=(const BoardCodec&) = delete;
+
+  /// @brief Returns the size of the record of a board.
+  /// @param size The dimension of the board.
+  /// @param mines The number of mines.
+  /// @param format Receives the format of the record.
+  std::size_t encodedSize(int size, std::size_t mines, Format& format);
+
+  /// @brief Encodes a board.
+  /// @param cells The packed tiles (see board.hpp); only the mines are kept.
+  /// @param size The dimension of the board.
+  /// @param record Receives the record; encodedSize() bytes.
+  /// @return The size of the record.
+  std::size_t encode(const std::uint8_t* cells, int size,
+                     std::uint8_t* record);
+
+  /// @brief Decodes the mines of a record.
+  /// @param record The record.
+  /// @param length The bytes available from the record.
+  /// @param size Receives the dimension of the board.
+  /// @param mines Receives the (row-major) indices of the mines, in
+  /// increasing order, e.g. for BasicBoard::setMines().
+  /// @return The size of the record; 0 if it is truncated or invalid.
+  std::size_t decodeMines(const std::uint8_t* record, std::size_t length,
+                          int& size, std::vector<std::size_t>& mines);
+
+  /// @brief Decodes a record into packed tiles, all hidden.
+  /// @param record The record.
+  /// @param length The bytes available from the record.
+  /// @param size Receives the dimension of the board.
+  /// @param cells Receives size * size packed tiles.
+  /// @return The size of the record; 0 if it is truncated or invalid, or if
+  /// the board is smaller than the smallest board of the topology.
+  template <typename Topology = SquareTopology>
+  std::size_t decode(const std::uint8_t* record, std::size_t length,
+                     int& size, std::vector<std::uint8_t>& cells);
+
+  /// @brief Encodes boards of a dimension in parallel.
+  /// @param pool The workers.
+  /// @param cells The packed tiles of the boards, one board after the other.
+  /// @param size The dimension of the boards.
+  /// @param count The number of boards.
+  /// @param records Receives the records, one after the other.
+  /// @param offsets Receives the offset of each record in records.
+  static void encodeBatch(ThreadPool& pool, const std::uint8_t* cells,
+                          int size, std::size_t count,
+                          std::vector<std::uint8_t>& records,
+                          std::vector<std::size_t>& offsets);
+
+  /// @brief Decodes concatenated records of boards of a dimension in
+  /// parallel.
+  /// @param pool The workers.
+  /// @param records The records.
+  /// @param length The size of the records.
+  /// @param size Receives the dimension of the boards.
+  /// @param cells Receives the packed tiles of the boards, one board after
+  /// the other.
+  /// @return The number of boards; 0 if a record is invalid, if the
+  /// dimensions differ or if the boards are smaller than the smallest board
+  /// of the topology.
+  template <typename Topology = SquareTopology>
+  static std::size_t decodeBatch(ThreadPool& pool,
+                                 const std::uint8_t* records,
+                                 std::size_t length, int& size,
+                                 std::vector<std::uint8_t>& cells);
+
+ private:
+  /// @brief Reads the header of a record.
+  /// @return The size of the header; 0 if it is truncated or invalid.
+  static std::size_t readHeader(const std::uint8_t* record,
+                                std::size_t length, Format& format, int& size,
+                                std::size_t& mines);
+
+  /// @brief Returns the size of the payload of a record.
+  /// @param payload Receives the size.
+  /// @return false if encode() stores the board in the other format.
+  bool payloadSize(int size, std::size_t mines, Format format,
+                   std::size_t& payload);
+
+  /// @brief Returns the size of the rank of the mines of a board.
+  std::size_t rankBytes(std::size_t cells, std::size_t mines);
+
+  /// @brief Decodes the payload into _mines.
+  /// @return false if the payload is invalid.
+  bool decodePayload(const std::uint8_t* payload, Format format,
+                     std::size_t cells, std::size_t mines);
+
+  /// @brief Decodes a record into _mines.
+  /// @return The size of the record; 0 if it is truncated or invalid.
+  std::size_t read(const std::uint8_t* record, std::size_t length, int& size);
+
+  /// @brief Writes the hidden packed tiles of the board of _mines.
+  template <typename Topology>
+  void fillCells(int size, std::uint8_t* cells) const;
+
+ private:
+  std::vector<std::uint32_t> _rank;      //!< The rank, in 32-bit limbs.
+  std::vector<std::uint32_t> _binomial;  //!< The running binomial.
+  std::vector<std::size_t> _mines;       //!< The decoded mines.
+
+  // the rank size of the last board dimension and mines count
+  std::size_t _rankCells{0};
+  std::size_t _rankMines{0};
+  std::size_t _rankBytes{0};
+};
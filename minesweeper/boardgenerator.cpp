@@ -3,78 +3,170 @@
 #include "boardgenerator.hpp"
 
 // clang-format on
-static const unsigned int kMaxSize = 25;
 
-void BoardGenerator::generate() {
-  std::vector<Coord> minesCoords = generateMinesPositions();
+bool BoardGenerator::isValidBoard(int size, int numMines) {
+  return size > 0 && size <= kMaxBoardSize && numMines >= 0 &&
+         static_cast<std::size_t>(numMines) <
+             static_cast<std::size_t>(size) * size;
+}
 
-  for (auto& c : minesCoords) {
-    std::size_t row = c.row;
-    std::size_t col = c.col;
+void BoardGenerator::reset(int size, int numMines) {
+  // placing more mines than tiles would never end, even in a release build
+  if (!isValidBoard(size, numMines)) {
+    throw std::invalid_argument("BoardGenerator: invalid size or mines count");
+  }
 
-    // W
-    if (isValid(c.row, c.col - 1)) {
-      _tiles[row * _size + col - 1] += 1;
-    }
+  _size = size;
+  _numMines = numMines;
+
+  std::size_t sz = size;
+  _tiles.resize(sz * sz);
+  _mines.resize(numMines);
+  _marks.resize(sz * sz);
+  _openings.resize(sz * sz);
+  _parents.resize(sz * sz);
+  // two openings never touch, so at most about half the tiles start one and
+  // generating does not allocate; only a 2x2 knight board, whose tiles have
+  // no neighbours, can hold more (the list then grows)
+  _openingSizes.reserve(sz * sz / 2 + 1);
+}
 
-    // N-W
-    if (isValid(c.row - 1, c.col - 1)) {
-      _tiles[(row - 1) * _size + col - 1] += 1;
-    }
+template <typename Topology>
+void BoardGenerator::generate() {
+  if (_size < Topology::kMinSize) {
+    throw std::invalid_argument(
+        "BoardGenerator: the board is too small for its topology");
+  }
+  std::fill(_tiles.begin(), _tiles.end(), 0);
+  generateMinesPositions();
+
+  for (auto& c : _mines) {
+    Topology::forEachNeighbour(c.row, c.col, _size, [this](int r, int c) {
+      int& tile = _tiles[static_cast<std::size_t>(r) * _size + c];
+      if (tile != static_cast<int>(kMineTileValue)) {
+        tile++;
+      }
+    });
+  }
 
-    // N
-    if (isValid(c.row - 1, c.col)) {
-      _tiles[(row - 1) * _size + col] += 1;
-    }
+  labelOpenings<Topology>();
+}
 
-    // N-E
-    if (isValid(c.row - 1, c.col + 1)) {
-      _tiles[(row - 1) * _size + col + 1] += 1;
+void BoardGenerator::generateMinesPositions() {
+  const std::size_t n = _marks.size();
+  const std::size_t mines = static_cast<std::size_t>(_numMines);
+
+  // past half of the tiles most random tiles already hold a mine: a dense
+  // board draws its mines among the tiles not drawn yet, with a partial
+  // Fisher-Yates shuffle of the tiles
+  if (2 * mines > n) {
+    std::iota(_marks.begin(), _marks.end(), 0);
+    for (std::size_t i = 0; i < mines; i++) {
+      std::swap(_marks[i],
+                _marks[i + static_cast<std::size_t>(_random() % (n - i))]);
+      std::size_t r = static_cast<std::size_t>(_marks[i]);
+      _mines[i] = Coord{static_cast<int>(r / _size),
+                        static_cast<int>(r % _size)};
+      _tiles[r] = kMineTileValue;
     }
+    return;
+  }
 
-    // E
-    if (isValid(c.row, c.col + 1)) {
-      _tiles[row * _size + col + 1] += 1;
-    }
+  std::fill(_marks.begin(), _marks.end(), 0);
+  for (int i = 0; i < _numMines;) {
+    std::size_t r = static_cast<std::size_t>(_random() % n);
+    int row = static_cast<int>(r / _size);
+    int col = static_cast<int>(r % _size);
 
-    // S-E
-    if (isValid(c.row + 1, c.col + 1)) {
-      _tiles[(row + 1) * _size + col + 1] += 1;
-    }
+    if (!_marks[r]) {
+      _mines[i] = Coord{row, col};
 
-    // S
-    if (isValid(c.row + 1, c.col)) {
-      _tiles[(row + 1) * _size + col] += 1;
-    }
-
-    // S-W
-    if (isValid(c.row + 1, c.col - 1)) {
-      _tiles[(row + 1) * _size + col - 1] += 1;
+      _tiles[static_cast<std::size_t>(row) * _size + col] = kMineTileValue;
+      _marks[r] = 1;
+      i++;
     }
   }
 }
 
-std::vector<BoardGenerator::Coord> BoardGenerator::generateMinesPositions() {
-  std::vector<BoardGenerator::Coord> mines(_numMines);
+template <typename Topology>
+void BoardGenerator::labelOpenings() {
+  const int n = _size * _size;
 
-  bool mark[kMaxSize * kMaxSize];
-  memset(mark, false, sizeof mark);
+  // first pass: join each empty tile with its empty neighbours; the root of
+  // a set is always its smallest tile
+  for (int i = 0; i < n; i++) {
+    _parents[i] = i;
+  }
 
-  srand(static_cast<unsigned int>(time(nullptr)));
+  for (int i = 0; i < n; i++) {
+    if (_tiles[i] != kEmptyTileValue) {
+      continue;
+    }
 
-  for (int i = 0; i < _numMines;) {
-    int r = rand() % (_size * _size);
-    int row = r / _size;
-    int col = r % _size;
+    Topology::forEachHalfNeighbour(
+        i / _size, i % _size, _size, [&](int r, int c) {
+          int j = r * _size + c;
+          if (_tiles[j] != kEmptyTileValue) {
+            return;
+          }
+
+          int a = findRoot(i);
+          int b = findRoot(j);
+          if (a < b) {
+            _parents[b] = a;
+          } else if (b < a) {
+            _parents[a] = b;
+          }
+        });
+  }
 
-    if (!mark[r]) {
-      mines[i] = Coord{row, col};
+  // second pass: number the openings in the order of their roots and count
+  // the numbered tiles which no opening reveals
+  _openingsCount = 0;
+  _largestOpeningTile = -1;
+  _3bv = 0;
+  _openingSizes.clear();
+
+  for (int i = 0; i < n; i++) {
+    _openings[i] = -1;
+
+    if (_tiles[i] == kEmptyTileValue) {
+      int root = findRoot(i);
+      if (root == i) {
+        _openings[i] = _openingsCount++;
+        _openingSizes.push_back(0);
+      } else {
+        _openings[i] = _openings[root];
+      }
+
+      int size = ++_openingSizes[_openings[i]];
+      if (_largestOpeningTile < 0 ||
+          size > _openingSizes[_openings[_largestOpeningTile]]) {
+        _largestOpeningTile = root;
+      }
+      continue;
+    }
 
-      _tiles[static_cast<std::size_t>(row) * _size + col] = kMineTileValue;
-      mark[r] = true;
-      i++;
+    if (_tiles[i] == kMineTileValue) {
+      continue;
+    }
+
+    bool bordersOpening = false;
+    Topology::forEachNeighbour(i / _size, i % _size, _size, [&](int r, int c) {
+      if (_tiles[r * _size + c] == kEmptyTileValue) {
+        bordersOpening = true;
+      }
+    });
+
+    if (!bordersOpening) {
+      _3bv++;
     }
   }
 
-  return mines;
-}
\ No newline at end of file
+  _3bv += _openingsCount;
+}
+
+template void BoardGenerator::generate<SquareTopology>();
+template void BoardGenerator::generate<TorusTopology>();
+template void BoardGenerator::generate<HexTopology>();
+template void BoardGenerator::generate<KnightTopology>();
@@ -1,15 +1,26 @@
 #pragma once
 
+#include "topology.hpp"
+
 const unsigned int kEmptyTileValue = 0;
 const unsigned int kMineTileValue = 9;
 
+/// The largest dimension of a generated board: the generator indexes the
+/// tiles with int, so size * size must fit an int.
+const int kMaxBoardSize = 46340;
+
 /// @brief Generates the configuration of the border.
 ///
+/// The generator owns its working buffers (tiles, mines coordinates, marks) and
+/// reuses them across calls of generate(), so a long lived generator creates
+/// new boards of the same (or a smaller) size without touching the heap.
 class BoardGenerator {
+  friend class Benchmarks;
+
  public:
-  BoardGenerator(int size, int numMines) : _size{size}, _numMines{numMines} {
-    std::size_t sz = size;
-    _tiles.resize(sz * sz);
+  BoardGenerator(int size, int numMines)
+      : _random{static_cast<std::uint64_t>(time(nullptr))} {
+    reset(size, numMines);
   }
 
   ~BoardGenerator() {}
@@ -18,9 +29,63 @@ class BoardGenerator {
   BoardGenerator& operator=(const BoardGenerator&) = delete;
 
   bool check() { return true; }
+
+  /// @brief Changes the dimension of the board and the number of mines. The
+  /// buffers only grow, they are never released. Throws
+  /// std::invalid_argument if the board is not valid (see isValidBoard()).
+  /// @param size The dimension of the board, at most kMaxBoardSize.
+  /// @param numMines The number of mines, less than size * size.
+  void reset(int size, int numMines);
+
+  /// @brief Returns true if the dimension is in [1, kMaxBoardSize] and the
+  /// mines leave a safe tile.
+  static bool isValidBoard(int size, int numMines);
+
+  /// @brief Seeds the random generator: the same seed, dimension and number
+  /// of mines always give the same sequence of boards.
+  /// @param seed The seed.
+  void seed(std::uint64_t seed) { _random.seed(seed); }
+
+  /// @brief Generates a new board, then labels its openings and computes its
+  /// 3BV. The mines do not depend on the topology, the zone values and the
+  /// openings do. Throws std::invalid_argument if the board is smaller than
+  /// the smallest board of the topology.
+  template <typename Topology = SquareTopology>
   void generate();
 
-  std::vector<int>&& getTiles() { return std::move(_tiles); }
+  /// @brief Returns the dimension of the board.
+  int getSize() const { return _size; }
+
+  /// @brief Returns the number of mines.
+  int getMinesCount() const { return _numMines; }
+
+  /// @brief Returns the tiles of the last generated board. The reference stays
+  /// valid until the next call of reset() or generate().
+  const std::vector<int>& getTiles() const { return _tiles; }
+
+  /// @brief Returns the opening (connected region of empty tiles) which holds
+  /// a tile. The labels rate the boards (3BV, start tile); Board and Game
+  /// still reveal an opening by flood fill, since they also reveal its
+  /// numbered border.
+  /// @param row The row.
+  /// @param col The column.
+  /// @return The opening index (in [0, getOpeningsCount())), or -1 if the tile
+  /// is not empty.
+  int getOpening(int row, int col) const {
+    return _openings[static_cast<std::size_t>(row) * _size + col];
+  }
+
+  /// @brief Returns the number of openings of the last generated board.
+  int getOpeningsCount() const { return _openingsCount; }
+
+  /// @brief Returns the first tile (row-major index) of the largest opening,
+  /// or -1 if the board has no opening.
+  int getLargestOpeningTile() const { return _largestOpeningTile; }
+
+  /// @brief Returns the 3BV of the last generated board: the minimum number of
+  /// clicks which solve it (one per opening plus one per numbered tile which
+  /// does not border an opening).
+  int get3BV() const { return _3bv; }
 
  private:
   struct Coord {
@@ -31,19 +96,36 @@ class BoardGenerator {
     Coord(int r, int c) : row{r}, col{c} {}
   };
 
-  /// @brief Generates the coordinates of the mines.
-  ///
-  /// @return A vector holding the coordinates of the mines.
-  std::vector<Coord> generateMinesPositions();
+  /// @brief Generates the coordinates of the mines into _mines.
+  void generateMinesPositions();
+
+  /// @brief Labels the openings with a two pass union-find over the tiles and
+  /// counts the 3BV.
+  template <typename Topology>
+  void labelOpenings();
 
-  bool isValid(int row, int col) {
-    std::size_t i = static_cast<std::size_t>(row) * _size + col;
-    return row >= 0 && row < _size && col >= 0 && col < _size &&
-           _tiles[i] != kMineTileValue;
+  /// @brief Returns the root of a tile in the union-find forest.
+  int findRoot(int i) {
+    while (_parents[i] != i) {
+      _parents[i] = _parents[_parents[i]];
+      i = _parents[i];
+    }
+    return i;
   }
 
  private:
+  std::mt19937_64 _random;  //!< Places the mines.
   std::vector<int> _tiles;
+  std::vector<Coord> _mines;  //!< The coordinates of the mines.
+  // the tiles which already hold a mine (1), or on dense boards the tiles
+  // shuffled to draw the mines
+  std::vector<int> _marks;
+  std::vector<int> _openings;  //!< The opening of each tile (-1: none).
+  std::vector<int> _parents;   //!< The union-find forest of the openings.
+  std::vector<int> _openingSizes;  //!< The number of tiles of each opening.
   int _size;
   int _numMines;
-};
\ No newline at end of file
+  int _openingsCount{0};
+  int _largestOpeningTile{-1};
+  int _3bv{0};
+};
@@ -0,0 +1,219 @@
+// clang-format off
+#include "pch.h"
+#include "boardgenerator.hpp"
+#include "boardprefetcher.hpp"
+
+// clang-format on
+
+BoardPrefetcher::BoardPrefetcher()
+    : _generator{std::make_unique<BoardGenerator>(1, 0)},
+      _custom{std::make_unique<Queue>()} {
+  // the generators are seeded from the clock: a game generator created in the
+  // same second would produce the same boards
+  _generator->seed(std::random_device{}());
+}
+
+BoardPrefetcher::~BoardPrefetcher() { stop(); }
+
+void BoardPrefetcher::start() {
+  if (_thread.joinable()) {
+    return;
+  }
+  _stop = false;
+  _thread = std::thread([this]() { produce(); });
+}
+
+void BoardPrefetcher::stop() {
+  if (!_thread.joinable()) {
+    return;
+  }
+  {
+    std::lock_guard<std::mutex> lock(_mutex);
+    _stop = true;
+  }
+  _wakeUp.notify_one();
+  _thread.join();
+}
+
+void BoardPrefetcher::want(int size, int mines, TopologyKind topology) {
+  // the producer generates the board: it must not throw there
+  checkBoard(size, mines, topology);
+  {
+    std::lock_guard<std::mutex> lock(_mutex);
+    if (find(size, mines, topology) != nullptr) {
+      return;
+    }
+    auto queue = std::make_unique<Queue>();
+    queue->size = size;
+    queue->mines = mines;
+    queue->topology = topology;
+    _queues.push_back(std::move(queue));
+  }
+  _wakeUp.notify_one();
+}
+
+void BoardPrefetcher::setCustom(int size, int mines, TopologyKind topology) {
+  checkBoard(size, mines, topology);
+  {
+    std::lock_guard<std::mutex> lock(_mutex);
+    bool permanent = findPermanent(size, mines, topology) != nullptr;
+    if (_customWanted && !permanent && _custom->size == size &&
+        _custom->mines == mines && _custom->topology == topology) {
+      return;
+    }
+
+    _custom->size = size;
+    _custom->mines = mines;
+    _custom->topology = topology;
+    _custom->head = 0;
+    _custom->count = 0;
+    _customWanted = !permanent;
+    _customGeneration++;
+
+    // the buffers are kept if the producer is writing one of the boards
+    if (!_customWanted && _filling != _custom.get()) {
+      for (PreparedBoard& board : _custom->boards) {
+        board.tiles = std::vector<int>();
+      }
+    }
+  }
+  _wakeUp.notify_one();
+}
+
+bool BoardPrefetcher::take(int size, int mines, TopologyKind topology,
+                           PreparedBoard& board) {
+  {
+    std::lock_guard<std::mutex> lock(_mutex);
+    Queue* queue = find(size, mines, topology);
+    if (queue == nullptr || queue->count == 0) {
+      _misses++;
+      return false;
+    }
+
+    // the previous buffer of the caller goes back to the queue, which fills it
+    // again once it is the free slot
+    PreparedBoard& ready = queue->boards[queue->head];
+    std::swap(board, ready);
+    queue->head = (queue->head + 1) % kDepth;
+    queue->count--;
+    _hits++;
+  }
+  _wakeUp.notify_one();
+  return true;
+}
+
+std::size_t BoardPrefetcher::depth(int size, int mines,
+                                   TopologyKind topology) const {
+  std::lock_guard<std::mutex> lock(_mutex);
+  Queue* queue = find(size, mines, topology);
+  return queue ? queue->count : 0;
+}
+
+PrefetchStats BoardPrefetcher::stats() const {
+  std::lock_guard<std::mutex> lock(_mutex);
+  PrefetchStats stats;
+  stats.hits = _hits;
+  stats.misses = _misses;
+  stats.produced = _produced;
+  for (const auto& queue : _queues) {
+    stats.queued += queue->count;
+  }
+  if (_customWanted) {
+    stats.queued += _custom->count;
+  }
+  return stats;
+}
+
+void BoardPrefetcher::prepare(BoardGenerator& generator, TopologyKind topology,
+                              PreparedBoard& board) {
+  withTopology(topology, [&generator](auto t) {
+    generator.generate<decltype(t)>();
+  });
+
+  const std::vector<int>& tiles = generator.getTiles();
+  board.tiles.assign(tiles.begin(), tiles.end());
+  board.size = generator.getSize();
+  board.mines = generator.getMinesCount();
+  board.topology = topology;
+  board.openings = generator.getOpeningsCount();
+  board.largestOpeningTile = generator.getLargestOpeningTile();
+  board.bbbv = generator.get3BV();
+}
+
+void BoardPrefetcher::checkBoard(int size, int mines, TopologyKind topology) {
+  if (!BoardGenerator::isValidBoard(size, mines) ||
+      size < minBoardSize(topology)) {
+    throw std::invalid_argument("BoardPrefetcher: invalid board");
+  }
+}
+
+BoardPrefetcher::Queue* BoardPrefetcher::find(int size, int mines,
+                                              TopologyKind topology) const {
+  Queue* queue = findPermanent(size, mines, topology);
+  if (queue == nullptr && _customWanted && _custom->size == size &&
+      _custom->mines == mines && _custom->topology == topology) {
+    queue = _custom.get();
+  }
+  return queue;
+}
+
+BoardPrefetcher::Queue* BoardPrefetcher::findPermanent(
+    int size, int mines, TopologyKind topology) const {
+  for (const auto& queue : _queues) {
+    if (queue->size == size && queue->mines == mines &&
+        queue->topology == topology) {
+      return queue.get();
+    }
+  }
+  return nullptr;
+}
+
+void BoardPrefetcher::produce() {
+  std::unique_lock<std::mutex> lock(_mutex);
+
+  for (;;) {
+    // the emptiest queue first, so that a taken board is replaced before the
+    // other queues get deeper
+    Queue* queue = nullptr;
+    _wakeUp.wait(lock, [this, &queue]() {
+      queue = nullptr;
+      for (const auto& q : _queues) {
+        if (q->count < kDepth &&
+            (queue == nullptr || q->count < queue->count)) {
+          queue = q.get();
+        }
+      }
+      if (_customWanted && _custom->count < kDepth &&
+          (queue == nullptr || _custom->count < queue->count)) {
+        queue = _custom.get();
+      }
+      return _stop || queue != nullptr;
+    });
+    if (_stop) {
+      return;
+    }
+
+    // the free slot after the ready boards: take() only touches the oldest
+    // ready board, so it is left alone while the lock is released
+    PreparedBoard& board =
+        queue->boards[(queue->head + queue->count) % kDepth];
+    int size = queue->size;
+    int mines = queue->mines;
+    TopologyKind topology = queue->topology;
+    std::uint64_t generation = _customGeneration;
+
+    _filling = queue;
+    lock.unlock();
+    _generator->reset(size, mines);
+    prepare(*_generator, topology, board);
+    lock.lock();
+    _filling = nullptr;
+
+    // a board of a dropped custom board: its slot is free again
+    if (queue == _custom.get() && generation != _customGeneration) {
+      continue;
+    }
+    queue->count++;
+    _produced++;
+  }
+}
@@ -0,0 +1,139 @@
+#pragma once
+
+#include "topology.hpp"
+
+class BoardGenerator;
+
+/// @brief A generated board and what the game needs to know about it.
+struct PreparedBoard {
+  std::vector<int> tiles;  //!< The zone values (see BoardGenerator).
+  int size{0};
+  int mines{0};
+  TopologyKind topology{TopologyKind::Square};
+  int openings{0};             //!< The number of openings.
+  int largestOpeningTile{-1};  //!< The first tile of the largest opening.
+  int bbbv{0};                 //!< The 3BV.
+};
+
+/// @brief The counters of a BoardPrefetcher.
+struct PrefetchStats {
+  std::size_t hits{0};      //!< The boards taken from a queue.
+  std::size_t misses{0};    //!< The requests which found an empty queue.
+  std::size_t produced{0};  //!< The boards generated in the background.
+  std::size_t queued{0};    //!< The boards waiting in the queues.
+
+  /// @brief Returns the fraction of the requests served from a queue.
+  double hitRate() const {
+    std::size_t requests = hits + misses;
+    return requests ? static_cast<double>(hits) / requests : 0;
+  }
+};
+
+/// @brief Generates boards on a background thread, ahead of the games which
+/// will play them.
+///
+/// The prefetcher keeps a small queue of ready boards for each wanted board
+/// (dimension, number of mines and topology), the difficulty levels, and for
+/// the current custom board: a single slot whose queue is replaced when
+/// another custom board is played. Starting a new game takes the oldest board
+/// of its queue by swapping the tiles buffers, and the producer thread refills
+/// the queue while the game is played. After the first boards the buffers are
+/// only swapped, never allocated. An empty queue is a miss: the caller
+/// generates the board itself, as it would without a prefetcher.
+class BoardPrefetcher {
+ public:
+  /// The number of boards kept ready for each wanted board.
+  static constexpr std::size_t kDepth = 2;
+
+  BoardPrefetcher();
+
+  /// @brief The destructor. Stops the producer thread.
+  ~BoardPrefetcher();
+
+  BoardPrefetcher(const BoardPrefetcher&) = delete;
+  BoardPrefetcher& operator=(const BoardPrefetcher&) = delete;
+
+  /// @brief Starts the producer thread; it fills the queues of the wanted
+  /// boards, then sleeps until a board is taken.
+  void start();
+
+  /// @brief Stops and joins the producer thread. The queued boards are kept.
+  void stop();
+
+  /// @brief Adds a permanent queue for a board, if there is none yet. Throws
+  /// std::invalid_argument if the board cannot be generated.
+  void want(int size, int mines, TopologyKind topology);
+
+  /// @brief Sets the board of the custom slot: the boards of the previous
+  /// custom board are dropped. If the board already has a permanent queue the
+  /// slot is emptied and its buffers are released. Throws
+  /// std::invalid_argument if the board cannot be generated.
+  void setCustom(int size, int mines, TopologyKind topology);
+
+  /// @brief Takes the oldest ready board of a queue.
+  /// @param size The dimension of the board.
+  /// @param mines The number of mines.
+  /// @param topology The topology.
+  /// @param board Receives the board; its previous tiles buffer is recycled
+  /// by the queue.
+  /// @return true if a board was ready (a hit); false otherwise (a miss).
+  bool take(int size, int mines, TopologyKind topology, PreparedBoard& board);
+
+  /// @brief Returns the number of ready boards of a queue.
+  std::size_t depth(int size, int mines, TopologyKind topology) const;
+
+  /// @brief Returns the counters.
+  PrefetchStats stats() const;
+
+  /// @brief Generates a board with a generator and copies it, the generator
+  /// being already reset to the dimension and number of mines of the board.
+  /// @param generator The generator.
+  /// @param topology The topology.
+  /// @param board Receives the board.
+  static void prepare(BoardGenerator& generator, TopologyKind topology,
+                      PreparedBoard& board);
+
+ private:
+  /// @brief The ready boards of a wanted board, in a ring.
+  struct Queue {
+    int size;
+    int mines;
+    TopologyKind topology;
+    std::array<PreparedBoard, kDepth> boards;
+    std::size_t head{0};   //!< The oldest board.
+    std::size_t count{0};  //!< The number of ready boards.
+  };
+
+  /// @brief Throws std::invalid_argument if a board cannot be generated.
+  static void checkBoard(int size, int mines, TopologyKind topology);
+
+  /// @brief Returns the queue of a board, or nullptr (with _mutex held).
+  Queue* find(int size, int mines, TopologyKind topology) const;
+
+  /// @brief Returns the permanent queue of a board, or nullptr (with _mutex
+  /// held).
+  Queue* findPermanent(int size, int mines, TopologyKind topology) const;
+
+  /// @brief The loop of the producer thread.
+  void produce();
+
+ private:
+  std::unique_ptr<BoardGenerator> _generator;  //!< Used by the producer only.
+  std::vector<std::unique_ptr<Queue>> _queues;  //!< The permanent queues.
+
+  // the custom slot: its queue is reset in place, and the generation tells the
+  // producer that the board it was filling belongs to a dropped custom board
+  std::unique_ptr<Queue> _custom;
+  bool _customWanted{false};
+  std::uint64_t _customGeneration{0};
+  const Queue* _filling{nullptr};  //!< The queue the producer fills.
+
+  mutable std::mutex _mutex;  //!< Guards the queues and the counters.
+  std::condition_variable _wakeUp;
+  std::thread _thread;
+  bool _stop{false};
+
+  std::size_t _hits{0};
+  std::size_t _misses{0};
+  std::size_t _produced{0};
+};
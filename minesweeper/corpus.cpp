@@ -0,0 +1,399 @@
+// clang-format off
+#include "pch.h"
+#include "board.hpp"
+#include "boardgenerator.hpp"
+#include "solver.hpp"
+#include "threadpool.hpp"
+#include "corpus.hpp"
+
+// clang-format on
+
+namespace fs = std::filesystem;
+
+namespace {
+const char kMagic[8] = {'M', 'S', 'C', 'O', 'R', 'P', 'U', 'S'};
+// version 2 widened the mines column to 32 bits: a 256x256 board holds more
+// than 65535 mines
+const std::uint32_t kVersion = 2;
+
+/// @brief The header of a segment, followed by the columns.
+struct SegmentHeader {
+  char magic[8];
+  std::uint32_t version;
+  std::uint32_t count;  //!< The number of records.
+  std::uint64_t bytes;  //!< The size of the segment, header included.
+};
+
+std::size_t align8(std::size_t n) { return (n + 7) & ~std::size_t{7}; }
+
+/// @brief The offsets of the columns in a segment; each column starts on an
+/// 8 bytes boundary.
+struct SegmentLayout {
+  std::size_t seeds;
+  std::size_t sizes;
+  std::size_t mines;
+  std::size_t bbbv;
+  std::size_t openings;
+  std::size_t starts;
+  std::size_t noGuess;
+  std::size_t bytes;
+
+  explicit SegmentLayout(std::size_t count) {
+    std::size_t offset = sizeof(SegmentHeader);
+    seeds = offset;
+    offset = align8(offset + count * sizeof(std::uint64_t));
+    sizes = offset;
+    offset = align8(offset + count * sizeof(std::uint16_t));
+    mines = offset;
+    offset = align8(offset + count * sizeof(std::uint32_t));
+    bbbv = offset;
+    offset = align8(offset + count * sizeof(std::uint32_t));
+    openings = offset;
+    offset = align8(offset + count * sizeof(std::uint32_t));
+    starts = offset;
+    offset = align8(offset + count * sizeof(std::uint32_t));
+    noGuess = offset;
+    bytes = align8(offset + count * sizeof(std::uint8_t));
+  }
+};
+
+/// @brief The state of the segment at an offset of a corpus file.
+enum class SegmentState {
+  Complete,
+  Torn,     //!< Cut short: an append did not complete.
+  Invalid,  //!< Not a segment of this version.
+};
+
+/// @brief Checks the header of a segment.
+/// @param header The header, zero past the end of the file.
+/// @param remaining The bytes of the file from the segment on.
+SegmentState checkSegment(const SegmentHeader& header,
+                          std::uint64_t remaining) {
+  if (remaining < sizeof header) {
+    return SegmentState::Torn;
+  }
+  // the columns of the next segment must stay aligned
+  if (memcmp(header.magic, kMagic, sizeof kMagic) != 0 ||
+      header.version != kVersion ||
+      header.bytes < SegmentLayout(header.count).bytes ||
+      header.bytes % 8 != 0) {
+    return SegmentState::Invalid;
+  }
+  return header.bytes > remaining ? SegmentState::Torn
+                                  : SegmentState::Complete;
+}
+
+/// @brief Finds the end of the complete segments of a corpus file.
+/// @param length Receives the size of the complete segments.
+/// @return false if the file holds an invalid segment.
+bool completeLength(const fs::path& path, std::uint64_t& length) {
+  length = 0;
+  std::error_code error;
+  std::uint64_t size = fs::file_size(path, error);
+  if (error) {
+    return true;
+  }
+
+  std::ifstream file(path, std::ios::binary);
+  while (length < size) {
+    SegmentHeader header{};
+    file.seekg(static_cast<std::streamoff>(length));
+    file.read(reinterpret_cast<char*>(&header), sizeof header);
+    switch (checkSegment(header, size - length)) {
+      case SegmentState::Complete:
+        length += header.bytes;
+        break;
+      case SegmentState::Torn:
+        return true;
+      case SegmentState::Invalid:
+        return false;
+    }
+  }
+  return true;
+}
+
+/// @brief Writes a column of a record field into the segment buffer.
+template <typename T, typename F>
+void writeColumn(std::vector<char>& buffer, std::size_t offset,
+                 const std::vector<CorpusRecord>& records, F field) {
+  for (std::size_t i = 0; i < records.size(); i++) {
+    T value = static_cast<T>(field(records[i]));
+    memcpy(buffer.data() + offset + i * sizeof(T), &value, sizeof(T));
+  }
+}
+
+/// @brief The scratch data of a worker rating boards.
+struct Rater {
+  BoardGenerator generator;
+  Board board;
+  Solver solver;
+
+  Rater(int size, int mines) : generator{size, mines} {}
+};
+
+CorpusRecord rate(Rater& rater, int size, int mines, std::uint64_t seed) {
+  BoardGenerator& generator = rater.generator;
+  generator.reset(size, mines);
+  generator.seed(seed);
+  generator.generate();
+
+  const std::vector<int>& tiles = generator.getTiles();
+
+  // start in the largest opening, or on the first safe tile if there is none
+  std::size_t start = 0;
+  if (generator.getLargestOpeningTile() >= 0) {
+    start = static_cast<std::size_t>(generator.getLargestOpeningTile());
+  } else {
+    while (start < tiles.size() && tiles[start] == kMineTileValue) {
+      start++;
+    }
+  }
+
+  Board& board = rater.board;
+  board.setTiles(size, tiles);
+  board.reveal(static_cast<int>(start / size), static_cast<int>(start % size));
+
+  CorpusRecord record;
+  record.seed = seed;
+  record.size = static_cast<std::uint16_t>(size);
+  record.mines = static_cast<std::uint32_t>(mines);
+  record.bbbv = static_cast<std::uint32_t>(generator.get3BV());
+  record.openings = static_cast<std::uint32_t>(generator.getOpeningsCount());
+  record.start = static_cast<std::uint32_t>(start);
+  record.noGuess = rater.solver.solve(board) == Solver::Status::Won;
+  return record;
+}
+}  // namespace
+
+bool BoardCorpus::open(const fs::path& path) {
+  close();
+
+  if (!_file.open(path)) {
+    return false;
+  }
+
+  const std::uint8_t* data = _file.data();
+  std::size_t offset = 0;
+
+  while (offset < _file.size()) {
+    SegmentHeader header{};
+    memcpy(&header, data + offset,
+           std::min(sizeof header, _file.size() - offset));
+
+    SegmentState state = checkSegment(header, _file.size() - offset);
+    if (state == SegmentState::Torn) {
+      // the last append did not complete: the segments before it are valid
+      break;
+    }
+    if (state == SegmentState::Invalid) {
+      close();
+      return false;
+    }
+
+    SegmentLayout layout(header.count);
+
+    const std::uint8_t* base = data + offset;
+    Segment segment;
+    segment.count = header.count;
+    segment.seeds =
+        reinterpret_cast<const std::uint64_t*>(base + layout.seeds);
+    segment.sizes =
+        reinterpret_cast<const std::uint16_t*>(base + layout.sizes);
+    segment.mines =
+        reinterpret_cast<const std::uint32_t*>(base + layout.mines);
+    segment.bbbv = reinterpret_cast<const std::uint32_t*>(base + layout.bbbv);
+    segment.openings =
+        reinterpret_cast<const std::uint32_t*>(base + layout.openings);
+    segment.starts =
+        reinterpret_cast<const std::uint32_t*>(base + layout.starts);
+    segment.noGuess = base + layout.noGuess;
+
+    _segments.push_back(segment);
+    _recordsCount += segment.count;
+    offset += static_cast<std::size_t>(header.bytes);
+  }
+
+  return true;
+}
+
+void BoardCorpus::close() {
+  _segments.clear();
+  _recordsCount = 0;
+  _file.close();
+}
+
+std::size_t BoardCorpus::query(const CorpusQuery& query,
+                               std::vector<CorpusRecord>& records,
+                               std::size_t limit) const {
+  std::size_t found = 0;
+
+  for (const Segment& segment : _segments) {
+    for (int noGuess = query.noGuessOnly ? 1 : 0; noGuess <= 1; noGuess++) {
+      std::size_t first;
+      std::size_t last;
+      matchRange(segment, query, noGuess, first, last);
+
+      for (std::size_t i = first; i < last; i++) {
+        if (found == limit) {
+          return found;
+        }
+        records.push_back(record(segment, i));
+        found++;
+      }
+    }
+  }
+
+  return found;
+}
+
+std::size_t BoardCorpus::count(const CorpusQuery& query) const {
+  std::size_t found = 0;
+  for (const Segment& segment : _segments) {
+    for (int noGuess = query.noGuessOnly ? 1 : 0; noGuess <= 1; noGuess++) {
+      std::size_t first;
+      std::size_t last;
+      matchRange(segment, query, noGuess, first, last);
+      found += last - first;
+    }
+  }
+  return found;
+}
+
+bool BoardCorpus::at(const CorpusQuery& query, std::size_t index,
+                     CorpusRecord& result) const {
+  for (const Segment& segment : _segments) {
+    for (int noGuess = query.noGuessOnly ? 1 : 0; noGuess <= 1; noGuess++) {
+      std::size_t first;
+      std::size_t last;
+      matchRange(segment, query, noGuess, first, last);
+      if (index < last - first) {
+        result = record(segment, first + index);
+        return true;
+      }
+      index -= last - first;
+    }
+  }
+  return false;
+}
+
+void BoardCorpus::matchRange(const Segment& segment, const CorpusQuery& query,
+                             int noGuess, std::size_t& first,
+                             std::size_t& last) {
+  // the first record whose (size, mines, noGuess, 3BV) is not below the key,
+  // or above it if upper is set
+  auto bound = [&segment, &query, noGuess](std::uint32_t bbbv, bool upper) {
+    auto below = [&](std::size_t i) {
+      if (segment.sizes[i] != query.size) {
+        return segment.sizes[i] < query.size;
+      }
+      // the mines of a board fit an int, below kMaxBoardSize squared
+      const int mines = static_cast<int>(segment.mines[i]);
+      if (mines != query.mines) {
+        return mines < query.mines;
+      }
+      if (segment.noGuess[i] != noGuess) {
+        return segment.noGuess[i] < noGuess;
+      }
+      return upper ? segment.bbbv[i] <= bbbv : segment.bbbv[i] < bbbv;
+    };
+
+    std::size_t index = 0;
+    std::size_t count = segment.count;
+    while (count > 0) {
+      std::size_t step = count / 2;
+      if (below(index + step)) {
+        index += step + 1;
+        count -= step + 1;
+      } else {
+        count = step;
+      }
+    }
+    return index;
+  };
+
+  first = bound(query.min3BV, false);
+  last = query.min3BV <= query.max3BV ? bound(query.max3BV, true) : first;
+}
+
+CorpusRecord BoardCorpus::record(const Segment& segment, std::size_t i) {
+  CorpusRecord record;
+  record.seed = segment.seeds[i];
+  record.size = segment.sizes[i];
+  record.mines = segment.mines[i];
+  record.bbbv = segment.bbbv[i];
+  record.openings = segment.openings[i];
+  record.start = segment.starts[i];
+  record.noGuess = segment.noGuess[i] != 0;
+  return record;
+}
+
+void BoardCorpus::generate(ThreadPool& pool, int size, int mines,
+                           std::uint64_t firstSeed, std::size_t count,
+                           std::vector<CorpusRecord>& records) {
+  std::vector<std::unique_ptr<Rater>> raters;
+  for (std::size_t i = 0; i < pool.size(); i++) {
+    raters.emplace_back(std::make_unique<Rater>(size, mines));
+  }
+
+  records.resize(count);
+  pool.parallelFor(count, [&](std::size_t i, std::size_t worker) {
+    records[i] = rate(*raters[worker], size, mines, firstSeed + i);
+  });
+}
+
+bool BoardCorpus::append(const fs::path& path,
+                         std::vector<CorpusRecord>& records) {
+  if (records.empty() || records.size() > UINT32_MAX) {
+    return false;
+  }
+
+  std::sort(records.begin(), records.end(),
+            [](const CorpusRecord& a, const CorpusRecord& b) {
+              return std::tie(a.size, a.mines, a.noGuess, a.bbbv, a.seed) <
+                     std::tie(b.size, b.mines, b.noGuess, b.bbbv, b.seed);
+            });
+
+  // drop the tail left by an append which did not complete, so that the new
+  // segment follows the complete ones
+  std::uint64_t length;
+  if (!completeLength(path, length)) {
+    return false;
+  }
+  std::error_code error;
+  if (fs::exists(path, error) && fs::file_size(path, error) != length) {
+    fs::resize_file(path, length, error);
+    if (error) {
+      return false;
+    }
+  }
+
+  SegmentLayout layout(records.size());
+  std::vector<char> buffer(layout.bytes, 0);
+
+  SegmentHeader header;
+  memcpy(header.magic, kMagic, sizeof kMagic);
+  header.version = kVersion;
+  header.count = static_cast<std::uint32_t>(records.size());
+  header.bytes = layout.bytes;
+  memcpy(buffer.data(), &header, sizeof header);
+
+  using R = const CorpusRecord&;
+  writeColumn<std::uint64_t>(buffer, layout.seeds, records,
+                             [](R r) { return r.seed; });
+  writeColumn<std::uint16_t>(buffer, layout.sizes, records,
+                             [](R r) { return r.size; });
+  writeColumn<std::uint32_t>(buffer, layout.mines, records,
+                             [](R r) { return r.mines; });
+  writeColumn<std::uint32_t>(buffer, layout.bbbv, records,
+                             [](R r) { return r.bbbv; });
+  writeColumn<std::uint32_t>(buffer, layout.openings, records,
+                             [](R r) { return r.openings; });
+  writeColumn<std::uint32_t>(buffer, layout.starts, records,
+                             [](R r) { return r.start; });
+  writeColumn<std::uint8_t>(buffer, layout.noGuess, records,
+                            [](R r) { return r.noGuess; });
+
+  std::ofstream file(path, std::ios::binary | std::ios::app);
+  file.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+  return file.good();
+}
@@ -0,0 +1,123 @@
+#pragma once
+
+#include "mappedfile.hpp"
+
+class ThreadPool;
+
+/// @brief The description of a generated board. The board itself is
+/// recreated by seeding BoardGenerator with the seed.
+struct CorpusRecord {
+  std::uint64_t seed;      //!< The seed of BoardGenerator.
+  std::uint16_t size;      //!< The dimension of the board.
+  std::uint32_t mines;     //!< The number of mines.
+  std::uint32_t bbbv;      //!< The 3BV of the board.
+  std::uint32_t openings;  //!< The number of openings.
+  std::uint32_t start;     //!< The tile to click first (row-major index).
+  bool noGuess;  //!< The Solver wins from the start tile without guessing.
+};
+
+/// @brief A corpus query: the boards of a dimension and number of mines
+/// whose 3BV is in [min3BV, max3BV].
+struct CorpusQuery {
+  int size{9};
+  int mines{10};
+  std::uint32_t min3BV{0};
+  std::uint32_t max3BV{UINT32_MAX};
+  bool noGuessOnly{false};
+};
+
+/// @brief An on-disk collection of rated boards.
+///
+/// The file is a sequence of immutable segments and only grows by appending
+/// new segments. A segment cut short by an append which did not complete
+/// (e.g. the process died) is ignored when opening and overwritten by the
+/// next append. A segment stores its records column by column, sorted by
+/// (size, mines, noGuess, 3BV), so a query is a binary search per segment over
+/// the memory-mapped columns. The values are stored in the native byte order.
+class BoardCorpus {
+ public:
+  BoardCorpus() = default;
+  ~BoardCorpus() = default;
+
+  BoardCorpus(const BoardCorpus&) = delete;
+  BoardCorpus& operator=(const BoardCorpus&) = delete;
+
+  /// @brief Maps a corpus file.
+  /// @param path The corpus file.
+  /// @return true if the file was mapped and all its complete segments are
+  /// valid; false otherwise.
+  bool open(const std::filesystem::path& path);
+
+  /// @brief Unmaps the corpus file.
+  void close();
+
+  /// @brief Returns the number of records of all the segments.
+  std::size_t size() const { return _recordsCount; }
+
+  /// @brief Collects the records matching a query.
+  /// @param query The query.
+  /// @param records Receives the matching records.
+  /// @param limit The maximum number of records to collect.
+  /// @return The number of collected records.
+  std::size_t query(const CorpusQuery& query,
+                    std::vector<CorpusRecord>& records,
+                    std::size_t limit = SIZE_MAX) const;
+
+  /// @brief Counts the records matching a query, without reading them.
+  /// @param query The query.
+  /// @return The number of matching records.
+  std::size_t count(const CorpusQuery& query) const;
+
+  /// @brief Reads a record matching a query, e.g. to pick one uniformly.
+  /// @param query The query.
+  /// @param index The rank of the record among the matching records, in the
+  /// order of query(); below count(query).
+  /// @param result Receives the record.
+  /// @return true if the record exists; false otherwise.
+  bool at(const CorpusQuery& query, std::size_t index,
+          CorpusRecord& result) const;
+
+  /// @brief Generates and rates boards in parallel. The seeds are consecutive,
+  /// so the records come out in seed order whatever the number of threads.
+  /// @param pool The workers.
+  /// @param size The dimension of the boards.
+  /// @param mines The number of mines.
+  /// @param firstSeed The seed of the first board.
+  /// @param count The number of boards.
+  /// @param records Receives the records.
+  static void generate(ThreadPool& pool, int size, int mines,
+                       std::uint64_t firstSeed, std::size_t count,
+                       std::vector<CorpusRecord>& records);
+
+  /// @brief Appends the records to a corpus file as a new segment.
+  /// @param path The corpus file (created if it does not exist).
+  /// @param records The records; they are sorted in place.
+  /// @return true if the segment was written; false otherwise.
+  static bool append(const std::filesystem::path& path,
+                     std::vector<CorpusRecord>& records);
+
+ private:
+  /// @brief The columns of a segment, pointing into the mapped file.
+  struct Segment {
+    std::size_t count;
+    const std::uint64_t* seeds;
+    const std::uint16_t* sizes;
+    const std::uint32_t* mines;
+    const std::uint32_t* bbbv;
+    const std::uint32_t* openings;
+    const std::uint32_t* starts;
+    const std::uint8_t* noGuess;
+  };
+
+  /// @brief Finds the records of a segment matching a query with the given
+  /// noGuess flag: they are contiguous, in [first, last).
+  static void matchRange(const Segment& segment, const CorpusQuery& query,
+                         int noGuess, std::size_t& first, std::size_t& last);
+
+  /// @brief Reads a record of a segment.
+  static CorpusRecord record(const Segment& segment, std::size_t i);
+
+  MappedFile _file;
+  std::vector<Segment> _segments;
+  std::size_t _recordsCount{0};
+};
@@ -3,7 +3,9 @@
 #include "assets.hpp"
 #include "renderer.hpp"
 #include "components.hpp"
-#include "boardgenerator.hpp"
+#include "board.hpp"
+#include "montecarlo.hpp"
+#include "threadpool.hpp"
 #include "game.hpp"
 
 // clang-format on
@@ -13,6 +15,14 @@ const int kScreenHeight = 600;
 const int kTileSizeW = 21;
 const int kTileSizeH = 21;
 
+/// The largest board a hint is searched on: each round plays a rollout per
+/// sampled layout and hidden tile.
+const std::size_t kMaxHintTiles = 32 * 32;
+
+/// The time a hint searches for, checked after each round; the search runs
+/// besides the logic thread, which keeps applying the inputs.
+const std::chrono::milliseconds kHintTime{500};
+
 namespace fs = std::filesystem;
 
 Game::Game(const fs::path& assetsDir, std::shared_ptr<spdlog::logger> logger)
@@ -24,7 +34,8 @@ Game::Game(const fs::path& assetsDir, std::shared_ptr<spdlog::logger> logger)
       _logger{logger},
       _firstClick{true},
       _gameOver{false},
-      _revealedTilesCount{0} {
+      _revealedTilesCount{0},
+      _random{std::random_device{}()} {
   fs::path graphicsAssetsDir = assetsDir;
   graphicsAssetsDir /= "graphics/21x21";
   _graphicAssets = std::make_unique<GraphicsAssets>(graphicsAssetsDir);
@@ -32,29 +43,28 @@ Game::Game(const fs::path& assetsDir, std::shared_ptr<spdlog::logger> logger)
 
 Game::~Game() {}
 
-bool Game::init() {
+bool Game::init(Uint32 rendererFlags) {
   if (SDL_Init(SDL_INIT_VIDEO) < 0) {
     _logger->error("SDL could not initialize");
     return false;
   }
 
-  int width = kTileSizeW * _boardSize;
-  int height = kTileSizeH * _boardSize;
+  SDL_Point size = boardPixelSize(_boardSize, _topology);
 
   SDL_Window* window = SDL_CreateWindow(
-      "Mines", SDL_WINDOWPOS_CENTERED, SDL_WINDOWPOS_CENTERED, width, height,
+      "Mines", SDL_WINDOWPOS_CENTERED, SDL_WINDOWPOS_CENTERED, size.x, size.y,
       SDL_WINDOW_SHOWN | SDL_WINDOW_ALLOW_HIGHDPI);
   if (!window) {
     return false;
   }
 
-  SDL_Renderer* renderer = SDL_CreateRenderer(
-      window, -1, SDL_RENDERER_ACCELERATED | SDL_RENDERER_PRESENTVSYNC);
+  SDL_Renderer* renderer = SDL_CreateRenderer(window, -1, rendererFlags);
   if (!renderer) {
     return false;
   }
 
   _window = window;
+  _windowSize = size;
   _renderer = std::make_shared<Renderer>(renderer);
 
   _graphicAssets->setRenderer(_renderer);
@@ -64,7 +74,24 @@ bool Game::init() {
     return false;
   }
 
+  // the texture of each packed tile value, for drawing the snapshots
+  for (std::size_t cell = 0; cell < _cellTextures.size(); cell++) {
+    int value = static_cast<int>(cell & kCellValueMask);
+    if (!(cell & kCellRevealed)) {
+      _cellTextures[cell] = _graphicAssets->get(kUnexplored).get();
+    } else {
+      _cellTextures[cell] =
+          getTextureForZoneValue(cell & kCellExploded ? value + 1 : value);
+    }
+  }
+
+  _frameEvent = SDL_RegisterEvents(1);
+  if (_frameEvent == static_cast<Uint32>(-1)) {
+    return false;
+  }
+
   initEntities();
+  publishFrame(GameInput{});
 
   if (!_renderer->setDrawColor(0, 0, 0, SDL_ALPHA_OPAQUE) != 0) {
     return false;
@@ -85,58 +112,272 @@ void Game::startFrame() { _renderer.get()->clear(); }
 void Game::endFrame() { _renderer.get()->present(); }
 
 void Game::run() {
+  // the boards of the levels and of the current game are generated ahead
+  for (GameLevel level : {GameLevel::Beginner, GameLevel::Intermediate,
+                          GameLevel::Advanced}) {
+    int boardSize;
+    int minesCount;
+    getLevelSettings(level, boardSize, minesCount);
+    _prefetcher.want(boardSize, minesCount, _topology);
+  }
+  _prefetcher.setCustom(_boardSize, _minesCount, _topology);
+  _prefetcher.start();
+
+  _logicThread = std::thread([this]() { logicLoop(); });
+
+  _frames.acquire();
+  presentFrame();
+
   bool quit = false;
   SDL_Event ev;
 
   while (!quit) {
-    while (SDL_PollEvent(&ev)) {
-      if (ev.type == SDL_QUIT) {
-        quit = true;
-      } else if (ev.type == SDL_KEYDOWN) {
-        switch (ev.key.keysym.sym) {
-          case SDLK_n:
-            // reset the current game level
-            reset();
-            break;
-          case SDLK_b:
-            changeGameLevel(GameLevel::Beginner);
-            break;
-          case SDLK_i:
-            changeGameLevel(GameLevel::Intermediate);
-            break;
-          case SDLK_a:
-            changeGameLevel(GameLevel::Advanced);
-            break;
-          default:
-            break;
+    // sleep until an event or a snapshot arrives, then handle all the pending
+    // events before drawing a single frame
+    bool redraw = false;
+    if (SDL_WaitEvent(&ev)) {
+      do {
+        GameInput input;
+        if (ev.type == SDL_QUIT) {
+          quit = true;
+        } else if (ev.type == SDL_WINDOWEVENT) {
+          redraw = true;
+        } else if (translateEvent(ev, input)) {
+          sendInput(input);
         }
-      }
+      } while (SDL_PollEvent(&ev));
+    }
+
+    if (_frames.acquire() || redraw) {
+      presentFrame();
+    }
+  }
+
+  GameInput input;
+  input.kind = GameInput::Kind::Quit;
+  sendInput(input);
+  _logicThread.join();
+  _prefetcher.stop();
+
+  _logger->info(
+      "Input latency: {} inputs, mean {:.2f} ms, 99th percentile {:.2f} ms, "
+      "max {:.2f} ms",
+      _latency.count(), _latency.meanMs(), _latency.percentileMs(0.99),
+      _latency.maxMs());
+
+  PrefetchStats prefetch = _prefetcher.stats();
+  _logger->info(
+      "Prefetched boards: {} hits, {} misses ({:.0f}% hit rate), {} "
+      "generated, {} queued",
+      prefetch.hits, prefetch.misses, prefetch.hitRate() * 100,
+      prefetch.produced, prefetch.queued);
+}
+
+bool Game::translateEvent(const SDL_Event& ev, GameInput& input) const {
+  if (ev.type == SDL_KEYDOWN) {
+    switch (ev.key.keysym.sym) {
+      case SDLK_n:
+        // reset the current game level
+        input.kind = GameInput::Kind::NewGame;
+        return true;
+      case SDLK_b:
+        input.kind = GameInput::Kind::ChangeLevel;
+        input.level = GameLevel::Beginner;
+        return true;
+      case SDLK_i:
+        input.kind = GameInput::Kind::ChangeLevel;
+        input.level = GameLevel::Intermediate;
+        return true;
+      case SDLK_a:
+        input.kind = GameInput::Kind::ChangeLevel;
+        input.level = GameLevel::Advanced;
+        return true;
+      case SDLK_u:
+        input.kind = GameInput::Kind::Undo;
+        return true;
+      case SDLK_r:
+        input.kind = GameInput::Kind::Redo;
+        return true;
+      case SDLK_h:
+        input.kind = GameInput::Kind::Hint;
+        return true;
+      default:
+        return false;
+    }
+  }
+
+  if (ev.type == SDL_MOUSEBUTTONDOWN && ev.button.button == SDL_BUTTON_LEFT) {
+    // the player clicked on the board of the presented frame
+    const FrameSnapshot& frame = _frames.front();
+    int r = ev.button.y / kTileSizeH;
+    int c = ev.button.x - rowOffset(frame.topology, r);
+    if (ev.button.y < 0 || r >= frame.boardSize || c < 0 ||
+        c / kTileSizeW >= frame.boardSize) {
+      return false;
+    }
+
+    input.kind = GameInput::Kind::Reveal;
+    input.row = r;
+    input.col = c / kTileSizeW;
+    return true;
+  }
 
-      startFrame();
+  return false;
+}
 
-      update(&ev);
-      render();
+void Game::sendInput(GameInput input) {
+  input.id = ++_lastInputId;
+  input.time = std::chrono::steady_clock::now();
 
-      endFrame();
+  while (!_inputs.tryPush(input)) {
+    // the logic thread is far behind: drop the clicks, keep the commands
+    if (input.kind == GameInput::Kind::Reveal) {
+      _logger->warn("The input queue is full; dropped a click");
+      return;
     }
+    std::this_thread::yield();
   }
+
+  // the lock only orders this wake up with the wait of the logic thread
+  { std::lock_guard<std::mutex> lock(_inputMutex); }
+  _inputReady.notify_one();
+}
+
+void Game::presentFrame() {
+  const FrameSnapshot& frame = _frames.front();
+
+  SDL_Point size = boardPixelSize(frame.boardSize, frame.topology);
+  if (size.x != _windowSize.x || size.y != _windowSize.y) {
+    SDL_SetWindowSize(_window, size.x, size.y);
+    _windowSize = size;
+  }
+
+  startFrame();
+  render();
+  endFrame();
+
+  // the frame is on screen once present returns (after the vertical sync)
+  if (frame.inputId > _presentedInputId) {
+    _latency.add(std::chrono::steady_clock::now() - frame.inputTime);
+    _presentedInputId = frame.inputId;
+  }
+
+  if (frame.status != _presentedStatus) {
+    _presentedStatus = frame.status;
+    if (frame.status == GameStatus::Lost) {
+      SDL_ShowSimpleMessageBox(SDL_MESSAGEBOX_INFORMATION, "Mines",
+                               "You lost !", _window);
+    } else if (frame.status == GameStatus::Won) {
+      SDL_ShowSimpleMessageBox(SDL_MESSAGEBOX_INFORMATION, "Mines",
+                               "You won !", _window);
+    }
+  }
+}
+
+void Game::logicLoop() {
+  GameInput last;
+  for (;;) {
+    {
+      std::unique_lock<std::mutex> lock(_inputMutex);
+      _inputReady.wait(lock, [this]() {
+        return !_inputs.empty() || _hintDone.load(std::memory_order_acquire);
+      });
+    }
+
+    // apply all the pending inputs, then publish a single snapshot
+    GameInput input;
+    while (_inputs.tryPop(input)) {
+      if (input.kind == GameInput::Kind::Quit) {
+        if (_hintThread.joinable()) {
+          _hintThread.join();
+        }
+        return;
+      }
+      applyInput(input);
+      last = input;
+    }
+    if (_hintDone.exchange(false, std::memory_order_acq_rel)) {
+      finishHintSearch();
+    }
+
+    publishFrame(last);
+
+    SDL_Event wakeUp;
+    SDL_zero(wakeUp);
+    wakeUp.type = _frameEvent;
+    SDL_PushEvent(&wakeUp);
+  }
+}
+
+void Game::applyInput(const GameInput& input) {
+  // any input hides the hint and makes a running search stale
+  _boardVersion++;
+  _hintTile = -1;
+  _hintWanted = false;
+
+  switch (input.kind) {
+    case GameInput::Kind::Reveal:
+      clickTile(input.row, input.col);
+      break;
+    case GameInput::Kind::NewGame:
+      reset();
+      break;
+    case GameInput::Kind::ChangeLevel:
+      changeGameLevel(input.level);
+      break;
+    case GameInput::Kind::Undo:
+      undo();
+      break;
+    case GameInput::Kind::Redo:
+      redo();
+      break;
+    case GameInput::Kind::Hint:
+      showHint();
+      break;
+    default:
+      break;
+  }
+}
+
+void Game::publishFrame(const GameInput& input) {
+  FrameSnapshot& frame = _frames.back();
+  frame.boardSize = _boardSize;
+  frame.topology = _topology;
+  frame.status = _gameOver ? GameStatus::Lost
+                 : won()   ? GameStatus::Won
+                           : GameStatus::Playing;
+
+  frame.cells.resize(_boardState.entities.size());
+  for (std::size_t i = 0; i < frame.cells.size(); i++) {
+    frame.cells[i] = cell(i);
+  }
+
+  frame.hint = _hintTile;
+  frame.inputId = input.id;
+  frame.inputTime = input.time;
+  _frames.publish();
 }
 
 void Game::setGameLevel(GameLevel level) {
+  _gameLevel = level;
+  getLevelSettings(level, _boardSize, _minesCount);
+}
+
+void Game::getLevelSettings(GameLevel level, int& boardSize, int& minesCount) {
   switch (level) {
     case GameLevel::Beginner:
-      _boardSize = 9;
-      _minesCount = 10;
+      boardSize = 9;
+      minesCount = 10;
       break;
 
     case GameLevel::Intermediate:
-      _boardSize = 16;
-      _minesCount = 40;
+      boardSize = 16;
+      minesCount = 40;
       break;
 
     case GameLevel::Advanced:
-      _boardSize = 24;
-      _minesCount = 99;
+      boardSize = 24;
+      minesCount = 99;
       break;
 
     default:
@@ -144,23 +385,81 @@ void Game::setGameLevel(GameLevel level) {
   }
 }
 
+void Game::setCorpus(std::shared_ptr<BoardCorpus> corpus,
+                     const CorpusQuery& query) {
+  _corpus = corpus;
+  _corpusQuery = query;
+}
+
+bool Game::pickCorpusBoard(CorpusRecord& record) {
+  // the corpus boards are rated on the square topology
+  if (!_corpus || _topology != TopologyKind::Square) {
+    return false;
+  }
+
+  _corpusQuery.size = _boardSize;
+  _corpusQuery.mines = _minesCount;
+
+  // uniformly among all the matching boards, whatever their segment and 3BV
+  std::size_t count = _corpus->count(_corpusQuery);
+  if (count == 0) {
+    _logger->warn("No corpus board matches the query; using a random board");
+    return false;
+  }
+
+  std::uniform_int_distribution<std::size_t> pick(0, count - 1);
+  return _corpus->at(_corpusQuery, pick(_random), record);
+}
+
 void Game::initEntities() {
-  BoardGenerator bg(_boardSize, _minesCount);
-  bg.generate();
-  std::vector<int> tiles = bg.getTiles();
+  CorpusRecord record;
+  bool fromCorpus = pickCorpusBoard(record);
+  bool prefetched = !fromCorpus && _prefetcher.take(_boardSize, _minesCount,
+                                                    _topology, _board);
+
+  if (!prefetched) {
+    if (!_boardGenerator) {
+      _boardGenerator =
+          std::make_unique<BoardGenerator>(_boardSize, _minesCount);
+    } else {
+      _boardGenerator->reset(_boardSize, _minesCount);
+    }
+
+    if (fromCorpus) {
+      _logger->info("Playing the corpus board with seed {}", record.seed);
+      _boardGenerator->seed(record.seed);
+    }
+    BoardPrefetcher::prepare(*_boardGenerator, _topology, _board);
+  }
+  const std::vector<int>& tiles = _board.tiles;
+
+  _logger->info("New board: 3BV={}, openings={}, prefetched={}", _board.bbbv,
+                _board.openings, prefetched);
+
+  // the registry recycles the released entities and keeps the capacity of its
+  // pools, so after the first game no allocation happens here
+  _boardState.entities.reserve(tiles.size());
 
   for (std::size_t i = 0; i < tiles.size(); i++) {
     std::size_t row = i / _boardSize;
     std::size_t col = i % _boardSize;
 
     auto ent = _registry.create();
-    _registry.emplace<TileComponent>(ent, Position{row, col}, tiles[i], false);
-
-    std::shared_ptr<Texture> texture = _graphicAssets->get(kUnexplored);
-    _registry.emplace<GraphicsComponent>(ent, GraphicsComponent{texture});
+    _registry.emplace<TileComponent>(ent, Position{row, col}, tiles[i], false,
+                                     false);
 
     _boardState.entities.emplace_back(ent);
   }
+
+  if (fromCorpus) {
+    // the boards are rated (no guessing) from their start tile: open it
+    tryRevealNearbyTiles(static_cast<int>(record.start / _boardSize),
+                         static_cast<int>(record.start % _boardSize));
+    _firstClick = false;
+  }
+
+  // the opened start tile is part of the base state
+  _journal.clear();
 }
 
 void Game::reset() {
@@ -168,245 +467,385 @@ void Game::reset() {
   _boardState.entities.clear();
   _registry.clear();
 
-  initEntities();
   _gameOver = false;
   _firstClick = true;
   _revealedTilesCount = 0;
+  initEntities();
 }
 
 void Game::changeGameLevel(GameLevel level) {
   _logger->info("Changing the game level to {}", level);
   setGameLevel(level);
-  reset();
-
-  SDL_SetWindowSize(_window, kTileSizeW * _boardSize, kTileSizeH * _boardSize);
+  changeBoard(_boardSize, _minesCount);
 }
 
-void Game::update(SDL_Event* ev) {
-  if (ev->type == SDL_MOUSEBUTTONDOWN && ev->button.button == SDL_BUTTON_LEFT) {
-    if (_gameOver) {
-      return;
-    }
+void Game::changeBoard(int boardSize, int minesCount) {
+  _boardSize = boardSize;
+  _minesCount = minesCount;
+  // the next boards of a custom dimension are prepared too, until another
+  // board is played
+  _prefetcher.setCustom(_boardSize, _minesCount, _topology);
+  reset();
+}
 
-    int x, y;
-    SDL_GetMouseState(&x, &y);
+int Game::rowOffset(TopologyKind topology, int row) {
+  return topology == TopologyKind::Hex && (row & 1) ? kTileSizeW / 2 : 0;
+}
 
-    std::size_t col = static_cast<std::size_t>(x) / kTileSizeW;
-    std::size_t row = static_cast<std::size_t>(y) / kTileSizeH;
+SDL_Point Game::boardPixelSize(int boardSize, TopologyKind topology) {
+  int width = kTileSizeW * boardSize;
+  if (topology == TopologyKind::Hex && boardSize > 1) {
+    width += kTileSizeW / 2;
+  }
+  return SDL_Point{width, kTileSizeH * boardSize};
+}
 
-    std::size_t i = row * _boardSize + col;
-    auto& ent = _boardState.entities[i];
+void Game::clickTile(int row, int col) {
+  if (!isValid(row, col) || _gameOver || won()) {
+    return;
+  }
 
-    if (!_registry.all_of<TileComponent, GraphicsComponent>(ent)) {
-      return;
-    }
+  std::size_t i = static_cast<std::size_t>(row) * _boardSize + col;
+  auto& ent = _boardState.entities[i];
 
-    TileComponent& tile = _registry.get<TileComponent>(ent);
-    GraphicsComponent& graphics = _registry.get<GraphicsComponent>(ent);
+  if (!_registry.all_of<TileComponent>(ent)) {
+    return;
+  }
 
-    if (tile.zoneValue == kMineTileValue) {
-      _logger->info("Clicked on a mine at {} _firstClick={}", tile.position,
-                    _firstClick);
+  // the whole click (relocation, reveal, game over) is one action
+  JournalScope action(&_journal);
+  TileComponent& tile = _registry.get<TileComponent>(ent);
 
-      if (!_firstClick) {
-        // clicked on a mine: game is over
-        graphics.texture = getTextureForZoneValue(tile.zoneValue + 1);
-        tile.explored = true;
+  if (tile.zoneValue == kMineTileValue) {
+    _logger->info("Clicked on a mine at {} _firstClick={}", tile.position,
+                  _firstClick);
 
-        _gameOver = true;
+    if (!_firstClick) {
+      // clicked on a mine: game is over
+      setTile(i, static_cast<std::uint8_t>(cell(i) | kCellRevealed |
+                                           kCellExploded));
 
-        // reveal all mines
-        revealMines();
+      // reveal all mines
+      revealMines();
 
-        _logger->info("Game is over");
+      _logger->info("Game is over");
+      return;
+    }
 
-        SDL_ShowSimpleMessageBox(SDL_MESSAGEBOX_INFORMATION, "Mines",
-                                 "You lost !", _window);
+    // if the first click is on a "mine" tile then move the mine to the
+    // first tile which is not a "mine"
+    _logger->info(
+        "First clicked tile is a 'mine'. Move the mine to the first tile "
+        "which is not a 'mine'.");
 
-        return;
+    for (std::size_t j = 0; j < _boardState.entities.size(); j++) {
+      if ((cell(j) & kCellValueMask) == kMineTileValue) {
+        continue;
       }
 
-      // if the first click is on a "mine" tile then swap the clicked "entity"
-      // with the first entity which is not a "mine"
-      _logger->info(
-          "First clicked tile is a 'mine'. Swap it with the first tile which "
-          "is not a 'mine'.");
-
-      for (auto& e : _boardState.entities) {
-        if (_registry.all_of<TileComponent, GraphicsComponent>(e)) {
-          auto& tc = _registry.get<TileComponent>(e);
-          if (tc.zoneValue == kMineTileValue) {
-            continue;
-          }
-          std::swap(tile, tc);
-
-          auto& gc = _registry.get<GraphicsComponent>(e);
-          std::swap(graphics, gc);
+      withTopology(_topology, [this, i, j](auto topology) {
+        relocateMine<decltype(topology)>(i, j);
+      });
 
-          _logger->info("Swapped the mine from {} with tile at {}",
-                        tile.position, tc.position);
-
-          break;
-        }
-      }
+      _logger->info(
+          "Moved the mine from {} to {}", tile.position,
+          _registry.get<TileComponent>(_boardState.entities[j]).position);
+      break;
     }
+  }
 
-    if (!tile.explored) {
-      if (tile.zoneValue != kEmptyTileValue) {
-        graphics.texture = getTextureForZoneValue(tile.zoneValue);
-        tile.explored = true;
-        _revealedTilesCount++;
-      } else {
-        // try to reveal the nearby tiles
-        int r = static_cast<int>(row);
-        int c = static_cast<int>(col);
-        _logger->debug(
-            "Try revealing nearby tiles starting from {}",
-            Position{static_cast<std::size_t>(r), static_cast<std::size_t>(c)});
-        tryRevealNearbyTiles(r, c);
-      }
+  if (!tile.explored) {
+    if (tile.zoneValue != kEmptyTileValue) {
+      setTile(i, static_cast<std::uint8_t>(cell(i) | kCellRevealed));
+    } else {
+      // try to reveal the nearby tiles
+      _logger->debug("Try revealing nearby tiles starting from {}",
+                     tile.position);
+      tryRevealNearbyTiles(row, col);
     }
+  }
 
-    _firstClick = false;
+  _firstClick = false;
 
-    if (won()) {
-      SDL_ShowSimpleMessageBox(SDL_MESSAGEBOX_INFORMATION, "Mines", "You won !",
-                               _window);
-      revealMines();
-    }
+  if (won()) {
+    _logger->info("Game is won");
+    revealMines();
   }
 }
 
-void Game::render() {
-  auto view = _registry.view<TileComponent, GraphicsComponent>();
-  view.each([=](const auto& tile, const auto& graphics) {
-    SDL_Rect dstRect{static_cast<int>(tile.position.col) * kTileSizeW,
-                     static_cast<int>(tile.position.row) * kTileSizeH,
-                     kTileSizeW, kTileSizeH};
-
-    SDL_RenderCopy(_renderer.get()->raw_ptr(), graphics.texture->raw_ptr(),
-                   nullptr, &dstRect);
-  });
+void Game::undo() {
+  if (_journal.undo(*this)) {
+    // back to the base state of a random board: the first click is again
+    // protected from the mines
+    _firstClick = !_journal.canUndo() && _revealedTilesCount == 0;
+  }
 }
 
-void Game::tryRevealNearbyTiles(int row, int col) {
-  std::size_t i = static_cast<std::size_t>(row) * _boardSize +
-                  static_cast<std::size_t>(col);
+void Game::redo() {
+  if (_journal.redo(*this)) {
+    _firstClick = false;
+  }
+}
 
-  auto ent = _boardState.entities[i];
-  auto& tile = _registry.get<TileComponent>(ent);
-  if (tile.explored) {
+void Game::showHint() {
+  if (_gameOver || won()) {
     return;
   }
-
-  if (tile.zoneValue != kEmptyTileValue && tile.zoneValue != kMineTileValue) {
-    // reveal the nearby tiles that touch the empty tiles
-    tile.explored = true;
-    _revealedTilesCount++;
-
-    auto& graphics = _registry.get<GraphicsComponent>(ent);
-    graphics.texture = getTextureForZoneValue(tile.zoneValue);
+  if (_firstClick) {
+    _logger->info("Hint: the first click is never on a mine");
     return;
   }
-
-  // revel the nearby empty tiles
-  tile.explored = true;
-  _revealedTilesCount++;
-
-  auto& graphics = _registry.get<GraphicsComponent>(ent);
-  graphics.texture = getTextureForZoneValue(kEmptyTileValue);
-
-  // W
-  if (isValid(row, col - 1)) {
-    tryRevealNearbyTiles(row, col - 1);
+  // the engine plays the classic board
+  if (_topology != TopologyKind::Square ||
+      _boardState.entities.size() > kMaxHintTiles) {
+    _logger->info("Hint: not available on this board");
+    return;
   }
 
-  // N-W
-  if (isValid(row - 1, col - 1)) {
-    tryRevealNearbyTiles(row - 1, col - 1);
+  // the search of an older board goes on: search again once it ends
+  if (_hintSearching) {
+    _hintWanted = true;
+    return;
   }
+  startHintSearch();
+}
 
-  // N
-  if (isValid(row - 1, col)) {
-    tryRevealNearbyTiles(row - 1, col);
+void Game::startHintSearch() {
+  if (!_hintEngine) {
+    _hintPool = std::make_unique<ThreadPool>();
+    _hintEngine = std::make_unique<MonteCarloEngine>(*_hintPool);
+  }
+  // the previous search ended, its thread only has to be joined
+  if (_hintThread.joinable()) {
+    _hintThread.join();
   }
 
-  // N-E
-  if (isValid(row - 1, col + 1)) {
-    tryRevealNearbyTiles(row - 1, col + 1);
+  // the engine only reads the revealed tiles and the number of mines
+  if (_hintView.size() != _boardSize) {
+    _hintView = Board(_boardSize, 0);
+  }
+  for (std::size_t i = 0; i < _boardState.entities.size(); i++) {
+    _hintView.restoreCell(i, cell(i));
   }
 
-  // E
-  if (isValid(row, col + 1)) {
-    tryRevealNearbyTiles(row, col + 1);
+  // a round of one layout per worker keeps the search within its time
+  MonteCarloOptions options;
+  options.seed = _random();
+  options.timeBudget = kHintTime;
+  options.samplesPerRound = _hintPool->size();
+
+  _hintSearching = true;
+  _hintVersion = _boardVersion;
+  _hintThread = std::thread([this, options]() {
+    _hintResult = _hintEngine->bestGuess(_hintView, options);
+    _hintDone.store(true, std::memory_order_release);
+
+    // the lock only orders this wake up with the wait of the logic thread
+    { std::lock_guard<std::mutex> lock(_inputMutex); }
+    _inputReady.notify_one();
+  });
+}
+
+void Game::finishHintSearch() {
+  _hintThread.join();
+  _hintSearching = false;
+
+  if (_hintVersion != _boardVersion) {
+    // the board changed during the search
+    if (_hintWanted) {
+      _hintWanted = false;
+      startHintSearch();
+    }
+    return;
   }
+  if (_hintResult.estimates.empty()) {
+    return;
+  }
+
+  const GuessEstimate& best = _hintResult.estimates.front();
+  _hintTile = static_cast<int>(best.position.row * _boardSize +
+                               best.position.col);
+  _logger->info(
+      "Hint: {} wins {:.1f}% (mine {:.1f}%); {} rollouts in {:.3f}s, {:.0f} "
+      "rollouts/s/core",
+      best.position, best.winProbability * 100, best.mineProbability * 100,
+      _hintResult.rollouts, _hintResult.elapsed.count(),
+      _hintResult.rolloutsPerSecondPerCore());
+}
 
-  // S-E
-  if (isValid(row + 1, col + 1)) {
-    tryRevealNearbyTiles(row + 1, col + 1);
+void Game::render() {
+  const FrameSnapshot& frame = _frames.front();
+  SDL_Renderer* renderer = _renderer.get()->raw_ptr();
+
+  for (int row = 0; row < frame.boardSize; row++) {
+    int x = rowOffset(frame.topology, row);
+    const std::uint8_t* cells =
+        frame.cells.data() + static_cast<std::size_t>(row) * frame.boardSize;
+
+    for (int col = 0; col < frame.boardSize; col++) {
+      SDL_Rect dstRect{x + col * kTileSizeW, row * kTileSizeH, kTileSizeW,
+                       kTileSizeH};
+      SDL_RenderCopy(renderer, _cellTextures[cells[col]]->raw_ptr(), nullptr,
+                     &dstRect);
+    }
   }
 
-  // S
-  if (isValid(row + 1, col)) {
-    tryRevealNearbyTiles(row + 1, col);
+  if (frame.hint >= 0) {
+    int row = frame.hint / frame.boardSize;
+    int col = frame.hint % frame.boardSize;
+    SDL_Rect hintRect{rowOffset(frame.topology, row) + col * kTileSizeW,
+                      row * kTileSizeH, kTileSizeW, kTileSizeH};
+    SDL_SetRenderDrawColor(renderer, 255, 0, 0, SDL_ALPHA_OPAQUE);
+    SDL_RenderDrawRect(renderer, &hintRect);
+    SDL_SetRenderDrawColor(renderer, 0, 0, 0, SDL_ALPHA_OPAQUE);
   }
+}
 
-  // S-W
-  if (isValid(row + 1, col - 1)) {
-    tryRevealNearbyTiles(row + 1, col - 1);
+void Game::tryRevealNearbyTiles(int row, int col) {
+  std::size_t i = static_cast<std::size_t>(row) * _boardSize +
+                  static_cast<std::size_t>(col);
+  withTopology(_topology, [this, i](auto topology) {
+    revealRegion<decltype(topology)>(i);
+  });
+}
+
+template <typename Topology>
+void Game::revealRegion(std::size_t start) {
+  _revealStack.clear();
+  _revealStack.push_back(start);
+
+  while (!_revealStack.empty()) {
+    std::size_t i = _revealStack.back();
+    _revealStack.pop_back();
+
+    auto ent = _boardState.entities[i];
+    auto& tile = _registry.get<TileComponent>(ent);
+    if (tile.explored) {
+      continue;
+    }
+
+    _journal.record(i, static_cast<std::uint8_t>(tile.zoneValue),
+                    static_cast<std::uint8_t>(tile.zoneValue | kCellRevealed));
+    tile.explored = true;
+    _revealedTilesCount++;
+
+    // only the empty tiles reveal their neighbours
+    if (tile.zoneValue != kEmptyTileValue) {
+      continue;
+    }
+
+    int row = static_cast<int>(i / _boardSize);
+    int col = static_cast<int>(i % _boardSize);
+    Topology::forEachNeighbour(row, col, _boardSize, [this](int r, int c) {
+      std::size_t j = static_cast<std::size_t>(r) * _boardSize + c;
+      if (!_registry.get<TileComponent>(_boardState.entities[j]).explored) {
+        _revealStack.push_back(j);
+      }
+    });
   }
 }
 
 void Game::revealMines() {
   _logger->debug("Reveal all mines");
-  for (auto& e : _boardState.entities) {
-    if (_registry.all_of<TileComponent, GraphicsComponent>(e)) {
+  for (std::size_t i = 0; i < _boardState.entities.size(); i++) {
+    auto e = _boardState.entities[i];
+    if (_registry.all_of<TileComponent>(e)) {
       auto& tc = _registry.get<TileComponent>(e);
       if (!tc.explored && tc.zoneValue == kMineTileValue) {
+        _journal.record(i, kMineTileValue,
+                        static_cast<std::uint8_t>(kMineTileValue |
+                                                  kCellRevealed));
         tc.explored = true;
-
-        auto& graphics = _registry.get<GraphicsComponent>(e);
-        graphics.texture = getTextureForZoneValue(tc.zoneValue);
       }
     }
   }
 }
 
-std::shared_ptr<Texture> Game::getTextureForZoneValue(int value) {
-  std::shared_ptr<Texture> texture;
+template <typename Topology>
+void Game::relocateMine(std::size_t from, std::size_t to) {
+  // the same relocation as the boards, each tile change being journaled
+  relocateMineCells<Topology>(
+      _boardSize, from, to, [this](std::size_t i) { return cell(i); },
+      [this](std::size_t i, std::uint8_t cell) { setTile(i, cell); });
+}
+
+std::uint8_t Game::cell(std::size_t i) const {
+  const auto& tile = _registry.get<TileComponent>(_boardState.entities[i]);
+  int cell = tile.zoneValue;
+  if (tile.explored) {
+    cell |= kCellRevealed;
+  }
+  if (tile.exploded) {
+    cell |= kCellExploded;
+  }
+  return static_cast<std::uint8_t>(cell);
+}
+
+void Game::setTile(std::size_t i, std::uint8_t cell) {
+  _journal.record(i, this->cell(i), cell);
+  restoreCell(i, cell);
+}
+
+void Game::restoreCell(std::size_t i, std::uint8_t cell) {
+  auto& tile = _registry.get<TileComponent>(_boardState.entities[i]);
+  bool wasExploded = tile.exploded;
+
+  // the revealed count only counts the tiles which are not mines
+  if (tile.explored && tile.zoneValue != kMineTileValue) {
+    _revealedTilesCount--;
+  }
+
+  tile.zoneValue = cell & kCellValueMask;
+  tile.explored = cell & kCellRevealed;
+  tile.exploded = cell & kCellExploded;
+
+  if (tile.explored && tile.zoneValue != kMineTileValue) {
+    _revealedTilesCount++;
+  }
+
+  // only the lost mine is exploded, so it tells whether the game is over
+  if (tile.exploded) {
+    _gameOver = true;
+  } else if (wasExploded) {
+    _gameOver = false;
+  }
+}
+
+Texture* Game::getTextureForZoneValue(int value) {
+  Texture* texture = nullptr;
   switch (value) {
     case 0:
-      texture = _graphicAssets->get(k0);
+      texture = _graphicAssets->get(k0).get();
       break;
     case 1:
-      texture = _graphicAssets->get(k1);
+      texture = _graphicAssets->get(k1).get();
       break;
     case 2:
-      texture = _graphicAssets->get(k2);
+      texture = _graphicAssets->get(k2).get();
       break;
     case 3:
-      texture = _graphicAssets->get(k3);
+      texture = _graphicAssets->get(k3).get();
       break;
     case 4:
-      texture = _graphicAssets->get(k4);
+      texture = _graphicAssets->get(k4).get();
       break;
     case 5:
-      texture = _graphicAssets->get(k5);
+      texture = _graphicAssets->get(k5).get();
       break;
     case 6:
-      texture = _graphicAssets->get(k6);
+      texture = _graphicAssets->get(k6).get();
       break;
     case 7:
-      texture = _graphicAssets->get(k7);
+      texture = _graphicAssets->get(k7).get();
       break;
     case 8:
-      texture = _graphicAssets->get(k8);
+      texture = _graphicAssets->get(k8).get();
       break;
     case kMineTileValue:
-      texture = _graphicAssets->get(kMine);
+      texture = _graphicAssets->get(kMine).get();
       break;
     default:
-      texture = _graphicAssets->get(kMineHit);
+      texture = _graphicAssets->get(kMineHit).get();
       break;
   }
   return texture;
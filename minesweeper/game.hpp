@@ -1,9 +1,20 @@
 #pragma once
 
+#include "board.hpp"
+#include "boardprefetcher.hpp"
+#include "corpus.hpp"
+#include "inputlatency.hpp"
+#include "journal.hpp"
+#include "montecarlo.hpp"
+#include "spscqueue.hpp"
 #include "structs.hpp"
+#include "topology.hpp"
+#include "triplebuffer.hpp"
 
+class BoardGenerator;
 class GraphicsAssets;
 class Renderer;
+class ThreadPool;
 
 /// @brief Game levels.
 enum class GameLevel { Beginner, Intermediate, Advanced };
@@ -44,8 +55,48 @@ struct BoardState {
   std::vector<entt::entity> entities;  /// the entities
 };
 
+/// @brief The outcome of the current game.
+enum class GameStatus { Playing, Won, Lost };
+
+/// @brief An input forwarded by the render thread to the logic thread.
+struct GameInput {
+  enum class Kind { Reveal, NewGame, ChangeLevel, Undo, Redo, Hint, Quit };
+
+  Kind kind{Kind::Quit};
+  int row{0};                                  //!< The clicked tile (Reveal).
+  int col{0};                                  //!< The clicked tile (Reveal).
+  GameLevel level{GameLevel::Beginner};        //!< The new level (ChangeLevel).
+  std::uint64_t id{0};                         //!< The sequence number.
+  std::chrono::steady_clock::time_point time;  //!< When it was received.
+};
+
+/// @brief The state of the board published by the logic thread for the
+/// render thread: a copy which the render thread reads while the logic thread
+/// goes on.
+struct FrameSnapshot {
+  int boardSize{0};
+  TopologyKind topology{TopologyKind::Square};
+  GameStatus status{GameStatus::Playing};
+  std::vector<std::uint8_t> cells;  //!< The packed tiles (see Game::cell()).
+  int hint{-1};                     //!< The hinted tile; -1 if none.
+  std::uint64_t inputId{0};         //!< The last input applied; 0 if none.
+  std::chrono::steady_clock::time_point inputTime;  //!< When it was received.
+};
+
 /// @brief Game class
+///
+/// While running, the game logic (the registry, the journal, the board
+/// generator) belongs to a logic thread and SDL belongs to the main thread.
+/// The main thread forwards the inputs through a lock-free queue and draws the
+/// snapshots the logic thread publishes through a triple buffer, so a long
+/// flood fill never delays a frame and a frame waiting for the vertical sync
+/// never delays an input. The next boards of the difficulty levels and of the
+/// current board are generated ahead by a prefetcher thread, so a new game or
+/// a level change does not wait for the board generator.
 class Game {
+  friend class Benchmarks;
+  friend class BoardJournal;
+
  public:
   /// @brief The constructor.
   /// @param assetsDir The directory the assets are loaded from.
@@ -56,16 +107,43 @@ class Game {
   /// @brief The destructor.
   ~Game();
 
-  /// @brief Runs the game logic.
+  /// @brief Runs the game: starts the logic thread and runs the event and
+  /// render loop until the window is closed.
   void run();
 
   /// @brief Sets the difficulty level.
   /// @param level The difficulty level.
   void setGameLevel(GameLevel level);
 
+  /// @brief Returns the dimension of the board and the number of mines of a
+  /// difficulty level.
+  /// @param level The difficulty level.
+  /// @param boardSize Receives the dimension of the board.
+  /// @param minesCount Receives the number of mines.
+  static void getLevelSettings(GameLevel level, int& boardSize,
+                               int& minesCount);
+
+  /// @brief Plays boards pulled from a corpus instead of random boards. The
+  /// dimension and the number of mines of the query follow the difficulty
+  /// level; the game falls back to random boards if nothing matches.
+  /// @param corpus The corpus.
+  /// @param query The 3BV range and the no guessing filter.
+  void setCorpus(std::shared_ptr<BoardCorpus> corpus, const CorpusQuery& query);
+
+  /// @brief Returns the counters of the board prefetcher.
+  PrefetchStats prefetchStats() const { return _prefetcher.stats(); }
+
+  /// @brief Sets the topology of the board (see topology.hpp). The hexagonal
+  /// boards are drawn with the odd rows shifted by half a tile. The corpus is
+  /// only used by the square boards.
+  /// @param topology The topology.
+  void setTopology(TopologyKind topology) { _topology = topology; }
+
   /// @brief Initializes the game.
+  /// @param rendererFlags The flags of the SDL renderer.
   /// @return Returns true if the initialization succeedes; false otherwise.
-  bool init();
+  bool init(Uint32 rendererFlags = SDL_RENDERER_ACCELERATED |
+                                   SDL_RENDERER_PRESENTVSYNC);
 
   /// @brief Releases the renderer and the game window and then quits the
   /// application.
@@ -75,12 +153,42 @@ class Game {
   /// @brief Creates the games entities.
   void initEntities();
 
+  /// @brief Picks a board from the corpus, if any.
+  /// @param record Receives the picked board.
+  /// @return true if a board was picked; false otherwise.
+  bool pickCorpusBoard(CorpusRecord& record);
+
   /// @brief Starts rendering the current frame.
   void startFrame();
 
   /// @brief Ends rendering the current frame.
   void endFrame();
 
+  /// @brief Converts an SDL event into an input for the logic thread.
+  /// @param ev The event.
+  /// @param input Receives the input.
+  /// @return true if the event is an input of the game; false otherwise.
+  bool translateEvent(const SDL_Event& ev, GameInput& input) const;
+
+  /// @brief Sends an input to the logic thread.
+  void sendInput(GameInput input);
+
+  /// @brief Draws the latest snapshot, resizes the window to it and shows the
+  /// outcome of the game (render thread).
+  void presentFrame();
+
+  /// @brief Applies the inputs and publishes the snapshots until a Quit input
+  /// (logic thread).
+  void logicLoop();
+
+  /// @brief Applies an input (logic thread).
+  void applyInput(const GameInput& input);
+
+  /// @brief Copies the state of the board into the back snapshot and
+  /// publishes it (logic thread).
+  /// @param input The last applied input.
+  void publishFrame(const GameInput& input);
+
   /// @brief Recreates the components of a terminated game.
   void reset();
 
@@ -88,12 +196,37 @@ class Game {
   /// @param level The difficulty level.
   void changeGameLevel(GameLevel level);
 
-  /// @brief Checks the input (keyboard and mouse) events and updates the game
-  /// components.
-  /// @param ev The input level.
-  void update(SDL_Event* ev);
+  /// @brief Changes the board dimension and the number of mines; the window is
+  /// resized to the board by the next presented frame.
+  /// @param boardSize The dimension of the board.
+  /// @param minesCount The number of mines.
+  void changeBoard(int boardSize, int minesCount);
 
-  /// @brief Renders the graphics elements.
+  /// @brief Reverts the last click of the current game.
+  void undo();
+
+  /// @brief Applies again the last undone click.
+  void redo();
+
+  /// @brief Asks for the best guess of the current board. The Monte Carlo
+  /// engine searches it on the hint thread while the inputs keep being
+  /// applied; the tile is outlined from the end of the search, unless an
+  /// input came in between, until the next input.
+  void showHint();
+
+  /// @brief Starts the hint search of the current board (logic thread).
+  void startHintSearch();
+
+  /// @brief Collects the result of the hint search which ended (logic
+  /// thread).
+  void finishHintSearch();
+
+  /// @brief Reveals the clicked tile, moving the mine of a first click away.
+  /// @param row The row.
+  /// @param col The column.
+  void clickTile(int row, int col);
+
+  /// @brief Renders the acquired snapshot.
   void render();
 
   /// @brief Returns a texture (corresponding to a tile zone value) to be
@@ -101,16 +234,45 @@ class Game {
   /// @param value The "zone" value of a tile (0: empty space; 1-8: the number
   /// of neighbours; 9: mine).
   /// @return The texture to be rendered in a tile.
-  std::shared_ptr<Texture> getTextureForZoneValue(int value);
+  Texture* getTextureForZoneValue(int value);
 
-  /// @brief Reveals (recursively) all the touching tiles of an empty tile.
+  /// @brief Reveals all the touching tiles of an empty tile.
   /// @param row The row coordinate of the empty tile.
   /// @param col The column coordinate of the empty tile.
   void tryRevealNearbyTiles(int row, int col);
 
+  /// @brief Reveals a tile and, through the empty tiles, the region around it
+  /// (iterative; no recursion).
+  template <typename Topology>
+  void revealRegion(std::size_t start);
+
+  /// @brief Returns the horizontal offset of the tiles of a row, in pixels.
+  static int rowOffset(TopologyKind topology, int row);
+
+  /// @brief Returns the size of a drawn board, in pixels.
+  static SDL_Point boardPixelSize(int boardSize, TopologyKind topology);
+
+  /// @brief Moves the mine of the first clicked tile to another tile and
+  /// updates the zone values around both tiles.
+  /// @param from The index of the clicked tile.
+  /// @param to The index of the new position of the mine.
+  template <typename Topology>
+  void relocateMine(std::size_t from, std::size_t to);
+
   /// @brief Show all the mines.
   void revealMines();
 
+  /// @brief Returns the state of a tile as a packed board cell (see
+  /// board.hpp), the lost mine being marked with kCellExploded.
+  std::uint8_t cell(std::size_t i) const;
+
+  /// @brief Changes the state of a tile, recording the change in the journal.
+  void setTile(std::size_t i, std::uint8_t cell);
+
+  /// @brief Changes the state of a tile without recording it (used by
+  /// BoardJournal to undo and redo the clicks).
+  void restoreCell(std::size_t i, std::uint8_t cell);
+
   /// @brief Checks if a tile coordinate is a valid board coordinate.
   /// @param row The row.
   /// @param col The column.
@@ -136,17 +298,64 @@ class Game {
   std::shared_ptr<Renderer> _renderer{
       nullptr};  //!< The renderer (used to render the graphics
                  //!< objetcs in the game window).
+  std::array<Texture*, 256> _cellTextures{};  //!< The texture of each packed
+                                              //!< tile value.
+  Uint32 _frameEvent{0};  //!< Wakes the render thread up on a new snapshot.
 
   GameLevel _gameLevel;  //!< The current difficulty level.
   int _boardSize;        //!< The dimension of the board.
   int _minesCount;       //!< The number of mines.
+  TopologyKind _topology{TopologyKind::Square};  //!< The board topology.
 
+  std::unique_ptr<BoardGenerator>
+      _boardGenerator;  //!< Generates the corpus boards and the boards the
+                        //!< prefetcher did not have ready; kept across games
+                        //!< to reuse its buffers.
+  BoardPrefetcher _prefetcher;  //!< Generates the next boards ahead.
+  PreparedBoard _board;         //!< The board of the current game.
   BoardState _boardState;  //!< The state of the board.
   bool _firstClick;
   bool _gameOver;
   std::size_t _revealedTilesCount;  //!< The number of tiles which are currently
                                     //!< revealed.
+  std::vector<std::size_t> _revealStack;  //!< The work list of revealRegion.
+  BoardJournal _journal;  //!< The undo/redo history of the current game; each
+                          //!< click is one action.
+
+  // the hint search runs on its own thread (and the engine on a pool): the
+  // logic thread only starts it and collects its result
+  std::unique_ptr<ThreadPool> _hintPool;  //!< Created by the first hint.
+  std::unique_ptr<MonteCarloEngine> _hintEngine;
+  Board _hintView;  //!< The board as the player sees it, read by the search;
+                    //!< reused across the hints.
+  std::thread _hintThread;        //!< Runs a search.
+  MonteCarloResult _hintResult;   //!< Written by the search before _hintDone.
+  std::atomic<bool> _hintDone{false};  //!< The search ended.
+  bool _hintSearching{false};          //!< A search is running.
+  bool _hintWanted{false};  //!< A hint was asked during the search of an
+                            //!< older board.
+  std::uint64_t _boardVersion{0};  //!< Counts the applied inputs.
+  std::uint64_t _hintVersion{0};   //!< The version of the searched board.
+  int _hintTile{-1};               //!< The hinted tile; -1 if none.
+
+  std::shared_ptr<BoardCorpus> _corpus;  //!< The boards to play, if any.
+  CorpusQuery _corpusQuery;              //!< The boards to pick.
+  std::mt19937 _random;                  //!< Picks the corpus boards.
 
   std::shared_ptr<spdlog::logger> _logger;  //!< The logger.
   entt::registry _registry;                 //!< The entities register.
+
+  std::thread _logicThread;  //!< Runs logicLoop() while the game runs.
+  SpscQueue<GameInput, 256> _inputs;  //!< From the render to the logic thread.
+  std::mutex _inputMutex;  //!< Only parks the idle logic thread.
+  std::condition_variable _inputReady;
+  TripleBuffer<FrameSnapshot> _frames;  //!< From the logic to the render
+                                        //!< thread.
+
+  // render thread state
+  std::uint64_t _lastInputId{0};       //!< The last input sent.
+  std::uint64_t _presentedInputId{0};  //!< The last input presented.
+  GameStatus _presentedStatus{GameStatus::Playing};
+  SDL_Point _windowSize{0, 0};
+  InputLatency _latency;
 };
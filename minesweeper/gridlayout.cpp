@@ -0,0 +1,93 @@
+// clang-format off
+#include "pch.h"
+#include "board.hpp"
+#include "gridlayout.hpp"
+
+// clang-format on
+
+template <typename Layout>
+void LayoutGrid<Layout>::generate(std::size_t mines,
+                                  std::mt19937_64& random) {
+  const int size = _layout.size();
+  std::fill(_cells.begin(), _cells.end(), 0);
+
+  std::uniform_int_distribution<int> coord(0, size - 1);
+  for (std::size_t placed = 0; placed < mines;) {
+    std::size_t i = _layout.index(coord(random), coord(random));
+    if (_cells[i] != kMineTileValue) {
+      _cells[i] = static_cast<std::uint8_t>(kMineTileValue);
+      placed++;
+    }
+  }
+
+  _layout.forEachCell([this](int row, int col, std::size_t i) {
+    if (_cells[i] == kMineTileValue) {
+      return;
+    }
+    std::uint8_t value = 0;
+    _layout.forEachNeighbour(row, col, [this, &value](int, int, std::size_t j) {
+      value += _cells[j] == kMineTileValue;
+    });
+    _cells[i] = value;
+  });
+}
+
+template <typename Layout>
+std::size_t LayoutGrid<Layout>::reveal(int row, int col) {
+  std::size_t start = _layout.index(row, col);
+  if (_cells[start] & (kCellRevealed | kCellFlagged)) {
+    return 0;
+  }
+
+  std::size_t revealed = 1;
+  _cells[start] = static_cast<std::uint8_t>(_cells[start] | kCellRevealed);
+  if ((_cells[start] & kCellValueMask) == kMineTileValue) {
+    return revealed;
+  }
+
+  _stack.clear();
+  _stack.push_back(Coord{row, col});
+  while (!_stack.empty()) {
+    Coord tile = _stack.back();
+    _stack.pop_back();
+
+    if ((_cells[_layout.index(tile.row, tile.col)] & kCellValueMask) != 0) {
+      continue;
+    }
+
+    _layout.forEachNeighbour(
+        tile.row, tile.col, [this, &revealed](int r, int c, std::size_t j) {
+          if (_cells[j] & (kCellRevealed | kCellFlagged)) {
+            return;
+          }
+          _cells[j] = static_cast<std::uint8_t>(_cells[j] | kCellRevealed);
+          revealed++;
+          _stack.push_back(Coord{r, c});
+        });
+  }
+  return revealed;
+}
+
+template <typename Layout>
+void LayoutGrid<Layout>::hideAll() {
+  for (std::uint8_t& cell : _cells) {
+    cell &= kCellValueMask;
+  }
+}
+
+template <typename Layout>
+void LayoutGrid<Layout>::copyRowMajor(std::uint8_t* cells) const {
+  const int size = _layout.size();
+  for (int row = 0; row < size; row++) {
+    std::uint8_t* dst = cells + static_cast<std::size_t>(row) * size;
+    _layout.forEachRowSpan(row, [this, dst](int col, std::size_t i,
+                                            int length) {
+      std::memcpy(dst + col, _cells.data() + i, length);
+    });
+  }
+}
+
+template class LayoutGrid<RowMajorLayout>;
+template class LayoutGrid<BlockedLayout<8>>;
+template class LayoutGrid<BlockedLayout<64>>;
+template class LayoutGrid<MortonLayout>;
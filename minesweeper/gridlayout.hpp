@@ -0,0 +1,307 @@
+#pragma once
+
+#include "board.hpp"
+
+/// @brief Layout policies: where the tile (row, col) of a size x size board
+/// is stored.
+///
+/// index(row, col) gives the position of a tile in the storage, which holds
+/// storageSize() tiles (a layout may pad the board). forEachCell(f) calls
+/// f(row, col, index) for each tile of the board in storage order, and
+/// forEachNeighbour(row, col, f) calls f(r, c, index) for each of the 8
+/// surrounding tiles. forEachRowSpan(row, f) calls f(col, index, length) for
+/// the runs of tiles of a row which are contiguous in the storage, from left
+/// to right.
+///
+/// With row-major storage, the tiles above and below a tile are a whole row
+/// away, so on large boards every vertical step of a flood fill or of a
+/// neighbour count misses the cache and, past a few rows, the TLB. The blocked
+/// layout stores the board as B x B blocks, each one row-major, so that the
+/// neighbours of all the tiles but the ones on the border of a block are in
+/// the same block, at constant offsets. The Morton (Z-order) layout
+/// interleaves the bits of the row and of the column, which keeps the nearby
+/// tiles close at every scale.
+///
+/// Board, BoardGenerator and Game keep the row-major layout, which measured
+/// fastest; the layouts are used by LayoutGrid, which runs the generation,
+/// flood fill and row traversal on any of them for the grid<size>/<layout>_*
+/// benchmarks, so that the comparison can be run again on other machines.
+
+/// @brief The row-major layout.
+class RowMajorLayout {
+ public:
+  static std::string name() { return "row_major"; }
+
+  explicit RowMajorLayout(int size) : _size{size} {}
+
+  int size() const { return _size; }
+
+  std::size_t storageSize() const {
+    return static_cast<std::size_t>(_size) * _size;
+  }
+
+  std::size_t index(int row, int col) const {
+    return static_cast<std::size_t>(row) * _size + col;
+  }
+
+  template <typename F>
+  void forEachCell(F&& f) const {
+    std::size_t i = 0;
+    for (int row = 0; row < _size; row++) {
+      for (int col = 0; col < _size; col++) {
+        f(row, col, i++);
+      }
+    }
+  }
+
+  template <typename F>
+  void forEachNeighbour(int row, int col, F&& f) const {
+    constexpr int kRows[] = {0, -1, -1, -1, 0, 1, 1, 1};
+    constexpr int kCols[] = {-1, -1, 0, 1, 1, 1, 0, -1};
+    std::size_t i = index(row, col);
+    std::ptrdiff_t stride = _size;
+
+    // away from the edges, all the neighbours are on the board
+    if (row > 0 && row < _size - 1 && col > 0 && col < _size - 1) {
+      for (int k = 0; k < 8; k++) {
+        f(row + kRows[k], col + kCols[k], i + kRows[k] * stride + kCols[k]);
+      }
+      return;
+    }
+
+    for (int k = 0; k < 8; k++) {
+      int r = row + kRows[k];
+      int c = col + kCols[k];
+      if (r >= 0 && r < _size && c >= 0 && c < _size) {
+        f(r, c, i + kRows[k] * stride + kCols[k]);
+      }
+    }
+  }
+
+  template <typename F>
+  void forEachRowSpan(int row, F&& f) const {
+    f(0, index(row, 0), _size);
+  }
+
+ private:
+  int _size;
+};
+
+/// @brief The blocked layout: B x B blocks (B a power of two), stored
+/// row-major, of B x B tiles, stored row-major. The blocks of the last row
+/// and column are padded.
+template <int B>
+class BlockedLayout {
+  static_assert(B >= 2 && (B & (B - 1)) == 0,
+                "the block size must be a power of two");
+
+ public:
+  static std::string name() { return "blocked" + std::to_string(B); }
+
+  explicit BlockedLayout(int size)
+      : _size{size}, _blocksPerRow{(size + B - 1) / B} {}
+
+  int size() const { return _size; }
+
+  std::size_t storageSize() const {
+    return static_cast<std::size_t>(_blocksPerRow) * _blocksPerRow * B * B;
+  }
+
+  std::size_t index(int row, int col) const {
+    // the coordinates are not negative: unsigned divisions are shifts
+    auto r = static_cast<std::size_t>(row);
+    auto c = static_cast<std::size_t>(col);
+    std::size_t block = (r / B) * _blocksPerRow + c / B;
+    return block * B * B + (r % B) * B + c % B;
+  }
+
+  template <typename F>
+  void forEachCell(F&& f) const {
+    for (int top = 0; top < _size; top += B) {
+      for (int left = 0; left < _size; left += B) {
+        std::size_t i = index(top, left);
+        int bottom = std::min(top + B, _size);
+        int right = std::min(left + B, _size);
+        for (int row = top; row < bottom; row++) {
+          for (int col = left; col < right; col++) {
+            f(row, col, i + (row - top) * B + (col - left));
+          }
+        }
+      }
+    }
+  }
+
+  template <typename F>
+  void forEachNeighbour(int row, int col, F&& f) const {
+    constexpr int kRows[] = {0, -1, -1, -1, 0, 1, 1, 1};
+    constexpr int kCols[] = {-1, -1, 0, 1, 1, 1, 0, -1};
+    int inRow = row & (B - 1);
+    int inCol = col & (B - 1);
+    std::size_t i = index(row, col);
+
+    // inside a block (and not on the last row or column of the board), the
+    // neighbours are in the block at constant offsets
+    if (inRow > 0 && inRow < B - 1 && inCol > 0 && inCol < B - 1 &&
+        row < _size - 1 && col < _size - 1) {
+      for (int k = 0; k < 8; k++) {
+        f(row + kRows[k], col + kCols[k], i + kRows[k] * B + kCols[k]);
+      }
+      return;
+    }
+
+    for (int k = 0; k < 8; k++) {
+      int r = row + kRows[k];
+      int c = col + kCols[k];
+      if (r >= 0 && r < _size && c >= 0 && c < _size) {
+        f(r, c, index(r, c));
+      }
+    }
+  }
+
+  template <typename F>
+  void forEachRowSpan(int row, F&& f) const {
+    for (int col = 0; col < _size; col += B) {
+      f(col, index(row, col), std::min(B, _size - col));
+    }
+  }
+
+ private:
+  int _size;
+  int _blocksPerRow;
+};
+
+/// @brief The Morton (Z-order) layout: the index of a tile interleaves the
+/// bits of its column (even bits) and of its row (odd bits). The board is
+/// padded to a power of two.
+class MortonLayout {
+ public:
+  static std::string name() { return "morton"; }
+
+  explicit MortonLayout(int size) : _size{size}, _side{1} {
+    while (_side < size) {
+      _side *= 2;
+    }
+  }
+
+  int size() const { return _size; }
+
+  std::size_t storageSize() const {
+    return static_cast<std::size_t>(_side) * _side;
+  }
+
+  std::size_t index(int row, int col) const {
+    return static_cast<std::size_t>(
+        spread(static_cast<std::uint32_t>(col)) |
+        spread(static_cast<std::uint32_t>(row)) << 1);
+  }
+
+  template <typename F>
+  void forEachCell(F&& f) const {
+    std::size_t count = storageSize();
+    for (std::size_t i = 0; i < count; i++) {
+      int row = static_cast<int>(compact(i >> 1));
+      int col = static_cast<int>(compact(i));
+      if (row < _size && col < _size) {
+        f(row, col, i);
+      }
+    }
+  }
+
+  template <typename F>
+  void forEachNeighbour(int row, int col, F&& f) const {
+    constexpr int kRows[] = {0, -1, -1, -1, 0, 1, 1, 1};
+    constexpr int kCols[] = {-1, -1, 0, 1, 1, 1, 0, -1};
+    for (int k = 0; k < 8; k++) {
+      int r = row + kRows[k];
+      int c = col + kCols[k];
+      if (r >= 0 && r < _size && c >= 0 && c < _size) {
+        f(r, c, index(r, c));
+      }
+    }
+  }
+
+  template <typename F>
+  void forEachRowSpan(int row, F&& f) const {
+    // an even column and the next one are adjacent
+    for (int col = 0; col < _size; col += 2) {
+      f(col, index(row, col), std::min(2, _size - col));
+    }
+  }
+
+ private:
+  /// @brief Moves the bit k of x to the bit 2k.
+  static std::uint64_t spread(std::uint32_t x) {
+    std::uint64_t v = x;
+    v = (v | v << 16) & 0x0000FFFF0000FFFFull;
+    v = (v | v << 8) & 0x00FF00FF00FF00FFull;
+    v = (v | v << 4) & 0x0F0F0F0F0F0F0F0Full;
+    v = (v | v << 2) & 0x3333333333333333ull;
+    v = (v | v << 1) & 0x5555555555555555ull;
+    return v;
+  }
+
+  /// @brief Moves the bit 2k of x to the bit k (the inverse of spread()).
+  static std::uint32_t compact(std::uint64_t x) {
+    x &= 0x5555555555555555ull;
+    x = (x | x >> 1) & 0x3333333333333333ull;
+    x = (x | x >> 2) & 0x0F0F0F0F0F0F0F0Full;
+    x = (x | x >> 4) & 0x00FF00FF00FF00FFull;
+    x = (x | x >> 8) & 0x0000FFFF0000FFFFull;
+    x = (x | x >> 16) & 0x00000000FFFFFFFFull;
+    return static_cast<std::uint32_t>(x);
+  }
+
+ private:
+  int _size;
+  int _side;  //!< The padded dimension.
+};
+
+/// @brief A square board of packed tiles (see board.hpp) stored in a layout,
+/// with the board operations whose memory accesses depend on the layout:
+/// generating the zone values, flood filling an opening and reading the
+/// board row by row (as a renderer or a snapshot copy does).
+template <typename Layout>
+class LayoutGrid {
+ public:
+  explicit LayoutGrid(int size)
+      : _layout{size}, _cells(_layout.storageSize(), 0) {}
+
+  LayoutGrid(const LayoutGrid&) = delete;
+  LayoutGrid& operator=(const LayoutGrid&) = delete;
+
+  const Layout& layout() const { return _layout; }
+  int size() const { return _layout.size(); }
+
+  std::uint8_t cell(int row, int col) const {
+    return _cells[_layout.index(row, col)];
+  }
+
+  /// @brief Places mines at random and computes the zone values, in storage
+  /// order. All tiles are hidden.
+  /// @param mines The number of mines (at most the number of tiles).
+  /// @param random The random generator.
+  void generate(std::size_t mines, std::mt19937_64& random);
+
+  /// @brief Reveals a tile and, through the empty tiles, the region around it
+  /// (iterative, like BasicBoard::reveal() on the square topology).
+  /// @return The number of revealed tiles.
+  std::size_t reveal(int row, int col);
+
+  /// @brief Hides all the tiles.
+  void hideAll();
+
+  /// @brief Copies the tiles row-major, row by row.
+  /// @param cells Receives size() * size() packed tiles.
+  void copyRowMajor(std::uint8_t* cells) const;
+
+ private:
+  struct Coord {
+    int row;
+    int col;
+  };
+
+ private:
+  Layout _layout;
+  std::vector<std::uint8_t> _cells;  //!< The packed tiles, in storage order.
+  std::vector<Coord> _stack;         //!< The flood fill work list.
+};
@@ -0,0 +1,26 @@
+// clang-format off
+#include "pch.h"
+#include "inputlatency.hpp"
+
+// clang-format on
+
+void InputLatency::add(std::chrono::steady_clock::duration latency) {
+  double ms = std::chrono::duration<double, std::milli>(latency).count();
+  _bins[std::min(static_cast<std::size_t>(ms * 10), kBins)]++;
+  _count++;
+  _totalMs += ms;
+  _maxMs = std::max(_maxMs, ms);
+}
+
+double InputLatency::percentileMs(double fraction) const {
+  std::size_t rank = static_cast<std::size_t>(fraction * _count);
+  std::size_t seen = 0;
+  for (std::size_t bin = 0; bin < kBins; bin++) {
+    seen += _bins[bin];
+    if (seen > rank) {
+      // the upper bound of the bin, which may be above the longest latency
+      return std::min((bin + 1) / 10.0, _maxMs);
+    }
+  }
+  return _maxMs;
+}
@@ -0,0 +1,26 @@
+#pragma once
+
+/// @brief The delays between receiving an input and presenting the first
+/// frame which shows its effect.
+class InputLatency {
+ public:
+  void add(std::chrono::steady_clock::duration latency);
+
+  std::size_t count() const { return _count; }
+  double meanMs() const { return _count ? _totalMs / _count : 0; }
+  double maxMs() const { return _maxMs; }
+
+  /// @brief Returns the latency under which a fraction of the inputs fall,
+  /// to the resolution of the histogram (0.1 ms, up to 100 ms); never above
+  /// maxMs().
+  double percentileMs(double fraction) const;
+
+ private:
+  /// The number of 0.1 ms bins; one more bin holds the longer latencies.
+  static constexpr std::size_t kBins = 1000;
+
+  std::array<std::uint32_t, kBins + 1> _bins{};
+  std::size_t _count{0};
+  double _totalMs{0};
+  double _maxMs{0};
+};
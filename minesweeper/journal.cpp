@@ -0,0 +1,41 @@
+// clang-format off
+#include "pch.h"
+#include "journal.hpp"
+
+// clang-format on
+
+void BoardJournal::clear() {
+  _actions.clear();
+  _actions.push_back(Action{kRoot, kNone, 0, 0, 0});
+  _changes.clear();
+  _current = kRoot;
+  _depth = 0;
+}
+
+void BoardJournal::begin() {
+  if (_depth++ > 0) {
+    return;
+  }
+
+  std::size_t first = _changes.size();
+  _actions.push_back(Action{_current, kNone, _actions[_current].depth + 1,
+                            first, first});
+}
+
+void BoardJournal::end() {
+  assert(_depth > 0);
+  if (--_depth > 0) {
+    return;
+  }
+
+  ActionId id = static_cast<ActionId>(_actions.size() - 1);
+  Action& action = _actions[id];
+  action.last = _changes.size();
+  if (action.first == action.last) {
+    _actions.pop_back();
+    return;
+  }
+
+  _actions[_current].redo = id;
+  _current = id;
+}
@@ -0,0 +1,183 @@
+#pragma once
+
+/// @brief A change of one packed cell (see board.hpp): the index of the cell
+/// and its values before and after the change.
+struct CellChange {
+  std::uint32_t index;
+  std::uint8_t before;
+  std::uint8_t after;
+};
+
+/// @brief The undo/redo history of a board, kept as a tree of actions.
+///
+/// An action (a reveal and its flood fill, a flag, a chord, a mine
+/// relocation) is stored as the list of the cells it changed, so undoing or
+/// redoing it costs time proportional to its delta, not to the board. Doing
+/// an action after an undo does not drop the undone actions: the new action
+/// starts another branch, and checkout() moves the board to any action of
+/// the tree by undoing up to the common ancestor and redoing down from it.
+/// All the branches share the one board, so a branch only costs the memory
+/// of its deltas.
+///
+/// The journal drives any target providing restoreCell(i, cell), such as
+/// BasicBoard and Game. The changes made outside an action are not
+/// recorded: they belong to the base state, and the history should be
+/// cleared after them.
+class BoardJournal {
+ public:
+  using ActionId = std::uint32_t;
+
+  /// The base state: the root of the tree.
+  static constexpr ActionId kRoot = 0;
+
+  BoardJournal() { clear(); }
+
+  /// @brief Drops the whole history; the current state becomes the base
+  /// state.
+  void clear();
+
+  /// @brief Starts recording an action. The nested begin() and end() calls
+  /// are merged into the outermost action (e.g. the reveals of a chord).
+  void begin();
+
+  /// @brief Ends recording an action. The action becomes the current action,
+  /// a child of the previous one; an action which changed nothing is dropped.
+  void end();
+
+  /// @brief Records the change of a cell if an action is being recorded.
+  void record(std::size_t index, std::uint8_t before, std::uint8_t after) {
+    if (_depth > 0 && before != after) {
+      _changes.push_back(
+          CellChange{static_cast<std::uint32_t>(index), before, after});
+    }
+  }
+
+  bool canUndo() const { return _current != kRoot; }
+  bool canRedo() const { return _actions[_current].redo != kNone; }
+
+  /// @brief Returns the action the target is at.
+  ActionId current() const { return _current; }
+
+  /// @brief Returns the action preceding an action (kRoot for the root).
+  ActionId parent(ActionId id) const { return _actions[id].parent; }
+
+  /// @brief Returns the number of actions, the root included.
+  std::size_t actionsCount() const { return _actions.size(); }
+
+  /// @brief Returns the number of recorded cell changes.
+  std::size_t changesCount() const { return _changes.size(); }
+
+  /// @brief Reverts the current action.
+  /// @return true if an action was reverted; false at the root.
+  template <typename Target>
+  bool undo(Target& target);
+
+  /// @brief Applies again the last undone child of the current action.
+  /// @return true if an action was applied; false if there is none.
+  template <typename Target>
+  bool redo(Target& target);
+
+  /// @brief Moves the target to the state after an action, on any branch.
+  template <typename Target>
+  void checkout(Target& target, ActionId id);
+
+ private:
+  static constexpr ActionId kNone = UINT32_MAX;
+
+  struct Action {
+    ActionId parent;
+    ActionId redo;        //!< The child redo() applies; kNone if none.
+    std::uint32_t depth;  //!< The distance to the root.
+    std::size_t first;    //!< The first change of the action.
+    std::size_t last;     //!< Past the last change of the action.
+  };
+
+ private:
+  std::vector<Action> _actions;      //!< The tree; the root is the first.
+  std::vector<CellChange> _changes;  //!< The changes of all the actions.
+  std::vector<ActionId> _path;       //!< The scratch path of checkout().
+  ActionId _current;                 //!< The action the target is at.
+  int _depth;                        //!< The begin() calls not yet ended.
+};
+
+/// @brief Records the changes made during its lifetime as one action of a
+/// journal; does nothing without a journal.
+class JournalScope {
+ public:
+  explicit JournalScope(BoardJournal* journal) : _journal{journal} {
+    if (_journal) {
+      _journal->begin();
+    }
+  }
+
+  ~JournalScope() {
+    if (_journal) {
+      _journal->end();
+    }
+  }
+
+  JournalScope(const JournalScope&) = delete;
+  JournalScope& operator=(const JournalScope&) = delete;
+
+ private:
+  BoardJournal* _journal;
+};
+
+template <typename Target>
+bool BoardJournal::undo(Target& target) {
+  assert(_depth == 0);
+  if (_current == kRoot) {
+    return false;
+  }
+
+  const Action& action = _actions[_current];
+  for (std::size_t k = action.last; k > action.first; k--) {
+    const CellChange& change = _changes[k - 1];
+    target.restoreCell(change.index, change.before);
+  }
+
+  _actions[action.parent].redo = _current;
+  _current = action.parent;
+  return true;
+}
+
+template <typename Target>
+bool BoardJournal::redo(Target& target) {
+  assert(_depth == 0);
+  ActionId id = _actions[_current].redo;
+  if (id == kNone) {
+    return false;
+  }
+
+  const Action& action = _actions[id];
+  for (std::size_t k = action.first; k < action.last; k++) {
+    const CellChange& change = _changes[k];
+    target.restoreCell(change.index, change.after);
+  }
+
+  _current = id;
+  return true;
+}
+
+template <typename Target>
+void BoardJournal::checkout(Target& target, ActionId id) {
+  // climb from both ends to the common ancestor, remembering the way down
+  _path.clear();
+  while (_actions[id].depth > _actions[_current].depth) {
+    _path.push_back(id);
+    id = _actions[id].parent;
+  }
+  while (_actions[_current].depth > _actions[id].depth) {
+    undo(target);
+  }
+  while (_current != id) {
+    undo(target);
+    _path.push_back(id);
+    id = _actions[id].parent;
+  }
+
+  for (std::size_t k = _path.size(); k > 0; k--) {
+    _actions[_current].redo = _path[k - 1];
+    redo(target);
+  }
+}
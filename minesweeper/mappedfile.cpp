@@ -0,0 +1,122 @@
+// clang-format off
+#include "pch.h"
+#include "mappedfile.hpp"
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+// clang-format on
+
+#ifdef _WIN32
+
+bool MappedFile::open(const std::filesystem::path& path) {
+  close();
+
+  HANDLE file = CreateFileW(path.wstring().c_str(), GENERIC_READ,
+                            FILE_SHARE_READ | FILE_SHARE_WRITE, nullptr,
+                            OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+  if (file == INVALID_HANDLE_VALUE) {
+    return false;
+  }
+  _file = file;
+
+  LARGE_INTEGER size;
+  if (!GetFileSizeEx(file, &size)) {
+    close();
+    return false;
+  }
+
+  _size = static_cast<std::size_t>(size.QuadPart);
+  if (_size == 0) {
+    return true;
+  }
+
+  HANDLE mapping =
+      CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+  if (mapping == nullptr) {
+    close();
+    return false;
+  }
+  _mapping = mapping;
+
+  void* data = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+  if (data == nullptr) {
+    close();
+    return false;
+  }
+  _data = static_cast<const std::uint8_t*>(data);
+
+  return true;
+}
+
+void MappedFile::close() {
+  if (_data != nullptr) {
+    UnmapViewOfFile(_data);
+  }
+  if (_mapping != nullptr) {
+    CloseHandle(_mapping);
+  }
+  if (_file != nullptr) {
+    CloseHandle(_file);
+  }
+
+  _data = nullptr;
+  _mapping = nullptr;
+  _file = nullptr;
+  _size = 0;
+}
+
+#else
+
+bool MappedFile::open(const std::filesystem::path& path) {
+  close();
+
+  int fd = ::open(path.c_str(), O_RDONLY);
+  if (fd < 0) {
+    return false;
+  }
+  _fd = fd;
+
+  struct stat st;
+  if (fstat(fd, &st) != 0) {
+    close();
+    return false;
+  }
+
+  _size = static_cast<std::size_t>(st.st_size);
+  if (_size == 0) {
+    return true;
+  }
+
+  void* data = mmap(nullptr, _size, PROT_READ, MAP_SHARED, fd, 0);
+  if (data == MAP_FAILED) {
+    close();
+    return false;
+  }
+  _data = static_cast<const std::uint8_t*>(data);
+
+  return true;
+}
+
+void MappedFile::close() {
+  if (_data != nullptr) {
+    munmap(const_cast<std::uint8_t*>(_data), _size);
+  }
+  if (_fd >= 0) {
+    ::close(_fd);
+  }
+
+  _data = nullptr;
+  _fd = -1;
+  _size = 0;
+}
+
+#endif
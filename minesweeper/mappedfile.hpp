@@ -0,0 +1,32 @@
+#pragma once
+
+/// @brief A read-only memory mapping of a whole file.
+class MappedFile {
+ public:
+  MappedFile() = default;
+  ~MappedFile() { close(); }
+
+  MappedFile(const MappedFile&) = delete;
+  MappedFile& operator=(const MappedFile&) = delete;
+
+  /// @brief Maps a file (an empty file maps to no data).
+  /// @param path The file path.
+  /// @return true if the file is mapped; false otherwise.
+  bool open(const std::filesystem::path& path);
+
+  /// @brief Unmaps the file.
+  void close();
+
+  const std::uint8_t* data() const { return _data; }
+  std::size_t size() const { return _size; }
+
+ private:
+#ifdef _WIN32
+  void* _file{nullptr};     //!< The file handle.
+  void* _mapping{nullptr};  //!< The file mapping handle.
+#else
+  int _fd{-1};  //!< The file descriptor.
+#endif
+  const std::uint8_t* _data{nullptr};  //!< The mapped bytes.
+  std::size_t _size{0};                //!< The size of the file.
+};
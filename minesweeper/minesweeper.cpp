@@ -5,6 +5,11 @@
 // clang-format off
 #include "pch.h"
 #include "assets.hpp"
+#include "batchrenderer.hpp"
+#include "board.hpp"
+#include "corpus.hpp"
+#include "solver.hpp"
+#include "threadpool.hpp"
 #include "game.hpp"
 
 
@@ -27,6 +32,177 @@ Tfp lambda_ptr(T& v) {
 
 namespace fs = std::filesystem;
 
+namespace {
+/// The number of records of a corpus segment written by the generator.
+const std::size_t kCorpusSegmentSize = 1 << 20;
+
+/// @brief Generates boards of a difficulty level and appends them to a corpus.
+/// @return true if all the boards were written; false otherwise.
+bool generateCorpus(const fs::path& path, GameLevel level, std::size_t count,
+                    std::uint64_t firstSeed, std::size_t threads,
+                    std::shared_ptr<spdlog::logger> logger) {
+  int boardSize = 0;
+  int minesCount = 0;
+  Game::getLevelSettings(level, boardSize, minesCount);
+
+  ThreadPool pool(threads);
+  logger->info("Generating {} boards ({}) into {} with {} threads", count,
+               level, path.string(), pool.size());
+
+  auto start = std::chrono::steady_clock::now();
+  std::vector<CorpusRecord> records;
+
+  for (std::size_t done = 0; done < count;) {
+    std::size_t n = std::min(kCorpusSegmentSize, count - done);
+    BoardCorpus::generate(pool, boardSize, minesCount, firstSeed + done, n,
+                          records);
+    if (!BoardCorpus::append(path, records)) {
+      logger->error("Cannot write the corpus {}", path.string());
+      return false;
+    }
+    done += n;
+  }
+
+  std::chrono::duration<double> elapsed =
+      std::chrono::steady_clock::now() - start;
+  logger->info("Generated {} boards in {:.3f}s ({:.0f} boards/s)", count,
+               elapsed.count(), count / elapsed.count());
+  return true;
+}
+
+/// The number of boards whose images are prepared and rendered together.
+const std::size_t kRenderChunkSize = 1024;
+
+/// @brief Appends the states to render of a board: the whole board revealed,
+/// or every step of a replay in which the Solver plays from the largest
+/// opening (one state per journal action, starting from the hidden board).
+/// @return The number of appended states.
+template <typename Topology>
+std::size_t appendRenderStates(BoardGenerator& generator,
+                               BasicBoard<Topology>& board,
+                               BoardJournal& journal, Solver& solver,
+                               int boardSize, bool replay,
+                               std::vector<std::uint8_t>& states) {
+  generator.generate<Topology>();
+  board.setTiles(boardSize, generator.getTiles());
+
+  if (!replay) {
+    for (std::uint8_t cell : board.cells()) {
+      states.push_back(static_cast<std::uint8_t>(cell | kCellRevealed));
+    }
+    return 1;
+  }
+
+  int start = generator.getLargestOpeningTile();
+  for (std::size_t i = 0; start < 0; i++) {
+    start = board.isMine(i) ? -1 : static_cast<int>(i);
+  }
+
+  journal.clear();
+  board.setJournal(&journal);
+  if (board.reveal(start / boardSize, start % boardSize) !=
+      RevealResult::Mine) {
+    solver.solve(board);
+  }
+  board.setJournal(nullptr);
+
+  // replay the game from its start
+  while (journal.undo(board)) {
+  }
+  std::size_t count = 0;
+  do {
+    states.insert(states.end(), board.cells().begin(), board.cells().end());
+    count++;
+  } while (journal.redo(board));
+  return count;
+}
+
+/// @brief Renders boards of a difficulty level to PNG files: the revealed
+/// boards for thumbnails, or the frames of their replays.
+/// @return true if all the images were written; false otherwise.
+bool renderBoards(const fs::path& directory, GameLevel level,
+                  TopologyKind topology, std::size_t count,
+                  std::uint64_t firstSeed, bool replays, std::size_t threads,
+                  const fs::path& assetsDir,
+                  std::shared_ptr<spdlog::logger> logger) {
+  int boardSize = 0;
+  int minesCount = 0;
+  Game::getLevelSettings(level, boardSize, minesCount);
+
+  BatchRenderer renderer(assetsDir);
+  if (!renderer.load()) {
+    logger->error("Cannot load the tiles. Error: {}", SDL_GetError());
+    return false;
+  }
+
+  std::error_code error;
+  fs::create_directories(directory, error);
+  if (error) {
+    logger->error("Cannot create {}: {}", directory.string(), error.message());
+    return false;
+  }
+
+  ThreadPool pool(threads);
+  logger->info("Rendering {} {} ({}) into {} with {} threads", count,
+               replays ? "replays" : "boards", level, directory.string(),
+               pool.size());
+
+  BoardGenerator generator(boardSize, minesCount);
+  BoardJournal journal;
+  Solver solver;
+  std::vector<std::uint8_t> states;
+  std::vector<RenderJob> jobs;
+  std::size_t cellsCount = static_cast<std::size_t>(boardSize) * boardSize;
+  std::size_t imagesCount = 0;
+  std::size_t writtenCount = 0;
+  std::chrono::steady_clock::duration renderTime{0};
+
+  for (std::size_t done = 0; done < count;) {
+    std::size_t n = std::min(kRenderChunkSize, count - done);
+    states.clear();
+    jobs.clear();
+
+    for (std::size_t b = 0; b < n; b++) {
+      std::uint64_t seed = firstSeed + done + b;
+      generator.seed(seed);
+      std::size_t frames = withTopology(topology, [&](auto t) {
+        BasicBoard<decltype(t)> board(boardSize, minesCount);
+        return appendRenderStates(generator, board, journal, solver,
+                                  boardSize, replays, states);
+      });
+
+      for (std::size_t f = 0; f < frames; f++) {
+        std::string name = replays ? fmt::format("replay_{}_{:04}.png", seed, f)
+                                   : fmt::format("board_{}.png", seed);
+        jobs.push_back(
+            RenderJob{nullptr, boardSize, topology, directory / name});
+      }
+    }
+
+    // the states do not move any more
+    for (std::size_t j = 0; j < jobs.size(); j++) {
+      jobs[j].cells = states.data() + j * cellsCount;
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    writtenCount += renderer.render(pool, jobs);
+    renderTime += std::chrono::steady_clock::now() - start;
+    imagesCount += jobs.size();
+    done += n;
+  }
+
+  std::chrono::duration<double> elapsed = renderTime;
+  logger->info("Rendered {} images in {:.3f}s ({:.0f} images/s)", imagesCount,
+               elapsed.count(), imagesCount / elapsed.count());
+  if (writtenCount != imagesCount) {
+    logger->error("{} images could not be written",
+                  imagesCount - writtenCount);
+    return false;
+  }
+  return true;
+}
+}  // namespace
+
 int main(int argc, char* argv[]) {
   fs::path assetsDir = fs::current_path().append("..").append("assets");
   GameLevel level = GameLevel::Beginner;
@@ -36,7 +212,18 @@ int main(int argc, char* argv[]) {
   // clang-format off
   options.add_options()
       ("l,level", "Difficulty level", cxxopts::value<std::string>()->default_value("b"))
-      ("assets_dir", "Assest directory", cxxopts::value<std::string>());
+      ("assets_dir", "Assest directory", cxxopts::value<std::string>())
+      ("corpus", "Board corpus file", cxxopts::value<std::string>())
+      ("generate_corpus", "Appends N boards of the difficulty level to the corpus and exits", cxxopts::value<std::size_t>())
+      ("seed", "The seed of the first generated board", cxxopts::value<std::uint64_t>())
+      ("threads", "Generator and renderer threads (0: one per core)", cxxopts::value<std::size_t>()->default_value("0"))
+      ("min_3bv", "Minimum 3BV of the corpus boards", cxxopts::value<std::uint32_t>()->default_value("0"))
+      ("max_3bv", "Maximum 3BV of the corpus boards", cxxopts::value<std::uint32_t>()->default_value("4294967295"))
+      ("no_guess", "Only play corpus boards solvable without guessing")
+      ("render_boards", "Renders N revealed boards of the difficulty level to PNG files and exits", cxxopts::value<std::size_t>())
+      ("render_replays", "Renders the frames of N solver replays of the difficulty level to PNG files and exits", cxxopts::value<std::size_t>())
+      ("render_dir", "The directory of the rendered images", cxxopts::value<std::string>()->default_value("render"))
+      ("topology", "Board topology: square, torus, hex or knight", cxxopts::value<std::string>()->default_value("square"));
   // clang-format on
 
   auto result = options.parse(argc, argv);
@@ -77,8 +264,62 @@ int main(int argc, char* argv[]) {
   logger->info("Assets directory: {}, Difficulty: {}", assetsDir.string(),
                level);
 
+  if (result.count("generate_corpus")) {
+    if (!result.count("corpus")) {
+      logger->error("--generate_corpus needs --corpus");
+      exit(1);
+    }
+
+    std::uint64_t seed = result.count("seed")
+                             ? result["seed"].as<std::uint64_t>()
+                             : static_cast<std::uint64_t>(time(nullptr));
+    bool generated = generateCorpus(
+        result["corpus"].as<std::string>(), level,
+        result["generate_corpus"].as<std::size_t>(), seed,
+        result["threads"].as<std::size_t>(), logger);
+    logger->flush();
+    return generated ? 0 : 1;
+  }
+
+  TopologyKind topology = TopologyKind::Square;
+  if (!parseTopology(result["topology"].as<std::string>(), topology)) {
+    logger->error("Unknown topology {}", result["topology"].as<std::string>());
+    exit(1);
+  }
+
+  if (result.count("render_boards") || result.count("render_replays")) {
+    bool replays = result.count("render_replays") > 0;
+    std::uint64_t seed = result.count("seed")
+                             ? result["seed"].as<std::uint64_t>()
+                             : static_cast<std::uint64_t>(time(nullptr));
+    bool rendered = renderBoards(
+        result["render_dir"].as<std::string>(), level, topology,
+        result[replays ? "render_replays" : "render_boards"]
+            .as<std::size_t>(),
+        seed, replays, result["threads"].as<std::size_t>(), assetsDir, logger);
+    logger->flush();
+    return rendered ? 0 : 1;
+  }
+
   std::unique_ptr<Game> game = std::make_unique<Game>(assetsDir, logger);
   game->setGameLevel(level);
+  game->setTopology(topology);
+
+  if (result.count("corpus")) {
+    auto corpus = std::make_shared<BoardCorpus>();
+    std::string corpusPath = result["corpus"].as<std::string>();
+    if (!corpus->open(corpusPath)) {
+      logger->error("Cannot open the corpus {}", corpusPath);
+      exit(1);
+    }
+    logger->info("Corpus {}: {} boards", corpusPath, corpus->size());
+
+    CorpusQuery query;
+    query.min3BV = result["min_3bv"].as<std::uint32_t>();
+    query.max3BV = result["max_3bv"].as<std::uint32_t>();
+    query.noGuessOnly = result.count("no_guess") > 0;
+    game->setCorpus(corpus, query);
+  }
 
   if (!game->init()) {
     logger->error("Failed to initialize the game. Error: {}", SDL_GetError());
@@ -0,0 +1,256 @@
+// clang-format off
+#include "pch.h"
+#include "board.hpp"
+#include "boardgenerator.hpp"
+#include "minesweeper_api.h"
+#include "vectorenv.hpp"
+
+// clang-format on
+
+static_assert(MS_TILE_VALUE_MASK == kCellValueMask &&
+                  MS_TILE_REVEALED == kCellRevealed &&
+                  MS_TILE_FLAGGED == kCellFlagged &&
+                  MS_TILE_MINE == kMineTileValue,
+              "the C tile layout must match the Board tile layout");
+static_assert(MS_MAX_BOARD_SIZE == kMaxBoardSize,
+              "the C board limit must match the generator limit");
+
+static_assert(sizeof(ms_action) == sizeof(EnvAction) &&
+                  offsetof(ms_action, row) == offsetof(EnvAction, row) &&
+                  offsetof(ms_action, col) == offsetof(EnvAction, col) &&
+                  offsetof(ms_action, kind) == offsetof(EnvAction, kind),
+              "the C actions must match the VectorEnv actions");
+static_assert(MS_ACTION_REVEAL == static_cast<int>(EnvActionKind::Reveal) &&
+                  MS_ACTION_FLAG == static_cast<int>(EnvActionKind::Flag) &&
+                  MS_ACTION_CHORD == static_cast<int>(EnvActionKind::Chord),
+              "the C action kinds must match the VectorEnv action kinds");
+
+/// @brief The board behind the C handle.
+struct ms_board {
+  BoardGenerator generator;
+  Board board;
+  std::uint32_t state;
+
+  ms_board(int size, int mines) : generator{size, mines}, state{0} {}
+};
+
+/// @brief The vectorized environment behind the C handle.
+struct ms_vec_env {
+  VectorEnv env;
+
+  ms_vec_env(std::size_t count, int size, int mines, std::uint64_t seed,
+             std::size_t threads)
+      : env{count, size, mines, seed, threads} {}
+};
+
+namespace {
+/// The sizes of the structs in the version which introduced them: a caller
+/// built against an older header passes a smaller struct_size than ours, but
+/// never smaller than these.
+const std::size_t kBoardViewMinSize =
+    offsetof(ms_board_view, tiles) + sizeof(ms_board_view::tiles);
+const std::size_t kVecRewardsMinSize =
+    offsetof(ms_vec_rewards, noop) + sizeof(ms_vec_rewards::noop);
+
+/// @brief Reads a struct of the caller: the members beyond its struct_size
+/// (the caller's header is older) keep their value in to.
+template <typename T>
+void copyFromCaller(T& to, const T& from) {
+  std::size_t size = std::min<std::size_t>(from.struct_size, sizeof(T));
+  std::memcpy(&to, &from, size);
+  to.struct_size = sizeof(T);
+}
+
+/// @brief Writes a struct of the caller: only the members within its
+/// struct_size are written (the caller's header may be older or newer).
+template <typename T>
+void copyToCaller(T& to, const T& from) {
+  std::uint32_t callerSize = to.struct_size;
+  std::memcpy(&to, &from, std::min<std::size_t>(callerSize, sizeof(T)));
+  to.struct_size = callerSize;
+}
+
+/// @brief Checks the dimension and the number of mines of a board: the
+/// generator needs size * size, and so the mines, to fit an int.
+bool validBoard(std::uint32_t size, std::uint32_t mines) {
+  return size != 0 && size <= MS_MAX_BOARD_SIZE &&
+         static_cast<std::uint64_t>(mines) <
+             static_cast<std::uint64_t>(size) * size;
+}
+
+void newGame(ms_board* board, std::uint64_t seed) {
+  board->generator.seed(seed);
+  board->generator.generate();
+  board->board.setTiles(board->board.size(), board->generator.getTiles());
+  board->state = MS_STATE_PLAYING;
+}
+
+std::int8_t apply(ms_board* board, const ms_action& action) {
+  Board& b = board->board;
+  if (action.row >= static_cast<std::uint32_t>(b.size()) ||
+      action.col >= static_cast<std::uint32_t>(b.size())) {
+    return MS_RESULT_INVALID;
+  }
+  if (board->state != MS_STATE_PLAYING) {
+    return MS_RESULT_GAME_OVER;
+  }
+
+  int row = static_cast<int>(action.row);
+  int col = static_cast<int>(action.col);
+  RevealResult result;
+
+  switch (action.kind) {
+    case MS_ACTION_REVEAL:
+      result = b.reveal(row, col);
+      break;
+    case MS_ACTION_CHORD:
+      result = b.chord(row, col);
+      break;
+    case MS_ACTION_FLAG:
+      return b.toggleFlag(row, col) ? MS_RESULT_CHANGED : MS_RESULT_NONE;
+    default:
+      return MS_RESULT_INVALID;
+  }
+
+  if (result == RevealResult::Mine) {
+    board->state = MS_STATE_LOST;
+    return MS_RESULT_MINE;
+  }
+  if (b.won()) {
+    board->state = MS_STATE_WON;
+  }
+  return result == RevealResult::Revealed ? MS_RESULT_CHANGED : MS_RESULT_NONE;
+}
+}  // namespace
+
+extern "C" {
+
+uint32_t ms_api_version(void) {
+  return (MS_API_VERSION_MAJOR << 16) | MS_API_VERSION_MINOR;
+}
+
+ms_board* ms_board_create(uint32_t size, uint32_t mines, uint64_t seed) {
+  if (!validBoard(size, mines)) {
+    return nullptr;
+  }
+
+  // no exception may cross the C boundary
+  try {
+    auto board = std::make_unique<ms_board>(static_cast<int>(size),
+                                            static_cast<int>(mines));
+    board->board = Board(static_cast<int>(size), static_cast<int>(mines));
+    newGame(board.get(), seed);
+    return board.release();
+  } catch (...) {
+    return nullptr;
+  }
+}
+
+void ms_board_destroy(ms_board* board) { delete board; }
+
+int ms_board_new_game(ms_board* board, uint64_t seed) {
+  if (board == nullptr) {
+    return MS_ERROR_INVALID_ARGUMENT;
+  }
+
+  newGame(board, seed);
+  return MS_OK;
+}
+
+size_t ms_board_apply(ms_board* board, const ms_action* actions, size_t count,
+                      int8_t* results) {
+  if (board == nullptr || (actions == nullptr && count != 0)) {
+    if (results != nullptr) {
+      std::fill(results, results + count, MS_RESULT_INVALID);
+    }
+    return 0;
+  }
+
+  size_t changed = 0;
+  for (size_t i = 0; i < count; i++) {
+    std::int8_t result = apply(board, actions[i]);
+    if (result == MS_RESULT_CHANGED || result == MS_RESULT_MINE) {
+      changed++;
+    }
+    if (results != nullptr) {
+      results[i] = result;
+    }
+  }
+  return changed;
+}
+
+int ms_board_get_view(const ms_board* board, ms_board_view* view) {
+  if (board == nullptr || view == nullptr ||
+      view->struct_size < kBoardViewMinSize) {
+    return MS_ERROR_INVALID_ARGUMENT;
+  }
+
+  const Board& b = board->board;
+  ms_board_view v{};
+  v.struct_size = sizeof(ms_board_view);
+  v.size = static_cast<uint32_t>(b.size());
+  v.mines = static_cast<uint32_t>(b.minesCount());
+  v.state = board->state;
+  v.revealed = b.revealedCount();
+  v.tiles = b.cells().data();
+  copyToCaller(*view, v);
+  return MS_OK;
+}
+
+ms_vec_env* ms_vec_env_create(uint32_t count, uint32_t size, uint32_t mines,
+                              uint64_t seed, uint32_t threads) {
+  if (count == 0 || !validBoard(size, mines)) {
+    return nullptr;
+  }
+
+  try {
+    return new ms_vec_env(count, static_cast<int>(size),
+                          static_cast<int>(mines), seed, threads);
+  } catch (...) {
+    return nullptr;
+  }
+}
+
+void ms_vec_env_destroy(ms_vec_env* env) { delete env; }
+
+int ms_vec_env_set_rewards(ms_vec_env* env, const ms_vec_rewards* rewards) {
+  if (env == nullptr || rewards == nullptr ||
+      rewards->struct_size < kVecRewardsMinSize) {
+    return MS_ERROR_INVALID_ARGUMENT;
+  }
+
+  EnvRewards r = env->env.rewards();
+  ms_vec_rewards known{sizeof(ms_vec_rewards), r.win, r.lose, r.progress,
+                       r.noop};
+  copyFromCaller(known, *rewards);
+
+  r.win = known.win;
+  r.lose = known.lose;
+  r.progress = known.progress;
+  r.noop = known.noop;
+  env->env.setRewards(r);
+  return MS_OK;
+}
+
+int ms_vec_env_reset(ms_vec_env* env, uint8_t* observations) {
+  if (env == nullptr) {
+    return MS_ERROR_INVALID_ARGUMENT;
+  }
+
+  env->env.reset(observations);
+  return MS_OK;
+}
+
+int ms_vec_env_step(ms_vec_env* env, const ms_action* actions,
+                    uint8_t* observations, uint32_t* revealed, float* rewards,
+                    uint8_t* dones) {
+  if (env == nullptr || actions == nullptr) {
+    return MS_ERROR_INVALID_ARGUMENT;
+  }
+
+  env->env.step(reinterpret_cast<const EnvAction*>(actions), observations,
+                revealed, rewards, dones);
+  return MS_OK;
+}
+
+}  // extern "C"
@@ -0,0 +1,171 @@
+/* minesweeper_api.h: the C interface of the board engine.
+ *
+ * The interface only uses opaque handles, fixed width integers and structs
+ * whose first member is their size, so it stays binary compatible across
+ * minor versions: new functions and new trailing struct members may be
+ * added, nothing is ever removed or reordered.
+ */
+
+#ifndef MINESWEEPER_API_H
+#define MINESWEEPER_API_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#if defined(_WIN32) && defined(MS_API_EXPORTS)
+#define MS_API __declspec(dllexport)
+#elif defined(_WIN32) && defined(MS_API_IMPORTS)
+#define MS_API __declspec(dllimport)
+#else
+#define MS_API
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define MS_API_VERSION_MAJOR 1
+#define MS_API_VERSION_MINOR 2
+
+/* The layout of a tile byte: the low nibble is the zone value (0: empty
+ * space; 1-8: the number of neighbouring mines; 9: mine), the high bits are
+ * the state of the tile. The value of a hidden tile must not be shown to the
+ * player. */
+#define MS_TILE_VALUE_MASK 0x0F
+#define MS_TILE_MINE 9
+#define MS_TILE_REVEALED 0x10
+#define MS_TILE_FLAGGED 0x20
+
+/* The largest dimension of a board (size * size tiles must fit a signed
+ * 32-bit index). */
+#define MS_MAX_BOARD_SIZE 46340
+
+/* The kinds of actions. */
+#define MS_ACTION_REVEAL 0
+#define MS_ACTION_FLAG 1 /* toggles the flag */
+#define MS_ACTION_CHORD 2
+
+/* The outcome of an action. */
+#define MS_RESULT_INVALID -1  /* bad coordinates or kind */
+#define MS_RESULT_NONE 0      /* nothing changed */
+#define MS_RESULT_CHANGED 1   /* tiles were revealed or a flag toggled */
+#define MS_RESULT_MINE 2      /* a mine was revealed: the game is lost */
+#define MS_RESULT_GAME_OVER 3 /* the game was already won or lost */
+
+/* The status of the functions returning an int. */
+#define MS_OK 0
+#define MS_ERROR_INVALID_ARGUMENT -1 /* a NULL handle or struct, or a struct
+                                        older than the function (since 1.2) */
+
+/* The state of a game. */
+#define MS_STATE_PLAYING 0
+#define MS_STATE_WON 1
+#define MS_STATE_LOST 2
+
+typedef struct ms_board ms_board;
+typedef struct ms_vec_env ms_vec_env;
+
+typedef struct ms_action {
+  uint32_t row;
+  uint32_t col;
+  uint32_t kind; /* MS_ACTION_* */
+} ms_action;
+
+/* A read-only view of a board. The tiles point into the board itself: they
+ * are updated in place by the actions and stay valid until the board is
+ * destroyed or a new game is started. */
+typedef struct ms_board_view {
+  uint32_t struct_size; /* set by the caller to sizeof(ms_board_view) */
+  uint32_t size;        /* the dimension of the board */
+  uint32_t mines;       /* the number of mines */
+  uint32_t state;       /* MS_STATE_* */
+  uint64_t revealed;    /* the number of revealed tiles */
+  const uint8_t* tiles; /* size * size bytes, row-major */
+} ms_board_view;
+
+/* The rewards of the steps of a vectorized environment (since 1.1). */
+typedef struct ms_vec_rewards {
+  uint32_t struct_size; /* set by the caller to sizeof(ms_vec_rewards) */
+  float win;            /* added when the step wins the game (1) */
+  float lose;           /* when the step reveals a mine (-1) */
+  float progress;       /* scaled by the revealed fraction of the safe
+                           tiles (1) */
+  float noop;           /* when the step changed nothing (-0.01) */
+} ms_vec_rewards;
+
+/* Returns (MS_API_VERSION_MAJOR << 16) | MS_API_VERSION_MINOR of the library;
+ * the major version of the library must match the one of the header. */
+MS_API uint32_t ms_api_version(void);
+
+/* Creates a board and generates a first game. The same seed always gives the
+ * same board. The size must be in [1, MS_MAX_BOARD_SIZE] and the mines fewer
+ * than size * size. Returns NULL if the arguments are invalid or on
+ * failure. */
+MS_API ms_board* ms_board_create(uint32_t size, uint32_t mines, uint64_t seed);
+
+/* Destroys a board (NULL is ignored). */
+MS_API void ms_board_destroy(ms_board* board);
+
+/* Generates a new game on a board, reusing its memory. Returns MS_OK, or
+ * MS_ERROR_INVALID_ARGUMENT if the board is NULL (since 1.2; void before). */
+MS_API int ms_board_new_game(ms_board* board, uint64_t seed);
+
+/* Applies the actions in order. If results is not NULL it receives the
+ * outcome (MS_RESULT_*) of each action. Returns the number of actions which
+ * changed the board. If the board is NULL, or the actions are NULL while
+ * count is not 0, nothing is applied: every result is MS_RESULT_INVALID and
+ * 0 is returned. */
+MS_API size_t ms_board_apply(ms_board* board, const ms_action* actions,
+                             size_t count, int8_t* results);
+
+/* Fills a view of the board. Only the members covered by the struct_size of
+ * the view are written, so a view of an older or a newer version of the
+ * header can be passed. Returns MS_OK, or MS_ERROR_INVALID_ARGUMENT if the
+ * board or the view is NULL or if the struct_size is smaller than the 1.0
+ * view. */
+MS_API int ms_board_get_view(const ms_board* board, ms_board_view* view);
+
+/* Creates a vectorized environment of count boards, stepped in lockstep on
+ * threads threads (0: one per hardware thread). Board b plays the seeds
+ * seed + b, seed + b + count, seed + b + 2 * count, ... whatever the number
+ * of threads. The size and the mines are limited as in ms_board_create.
+ * Returns NULL if the arguments are invalid or on failure (since 1.1). */
+MS_API ms_vec_env* ms_vec_env_create(uint32_t count, uint32_t size,
+                                     uint32_t mines, uint64_t seed,
+                                     uint32_t threads);
+
+/* Destroys a vectorized environment (NULL is ignored; since 1.1). */
+MS_API void ms_vec_env_destroy(ms_vec_env* env);
+
+/* Sets the rewards of the steps. Only the members covered by the struct_size
+ * of the rewards are read; the others keep their value. Returns MS_OK, or
+ * MS_ERROR_INVALID_ARGUMENT if the environment or the rewards are NULL or if
+ * the struct_size is smaller than the 1.1 rewards (since 1.1). */
+MS_API int ms_vec_env_set_rewards(ms_vec_env* env,
+                                  const ms_vec_rewards* rewards);
+
+/* Starts a new game on every board, with the next seeds. If observations is
+ * not NULL it receives count * size * size tile bytes, board after board,
+ * with the values of the hidden tiles cleared. Returns MS_OK, or
+ * MS_ERROR_INVALID_ARGUMENT if the environment is NULL (since 1.1; void
+ * before 1.2). */
+MS_API int ms_vec_env_reset(ms_vec_env* env, uint8_t* observations);
+
+/* Applies actions[b] to board b for every board. The first reveal of a game
+ * never hits a mine. Each buffer may be NULL and otherwise receives, for
+ * every board: its observation (as in ms_vec_env_reset), its number of
+ * revealed tiles, its reward and 1 if its game ended, 0 otherwise. A board
+ * whose game ended starts the next game of its seeds at once: its
+ * observation is the one of the new game. The call does not allocate memory.
+ * Returns MS_OK, or MS_ERROR_INVALID_ARGUMENT if the environment or the
+ * actions are NULL, in which case no board is stepped (since 1.1; void
+ * before 1.2). */
+MS_API int ms_vec_env_step(ms_vec_env* env, const ms_action* actions,
+                           uint8_t* observations, uint32_t* revealed,
+                           float* rewards, uint8_t* dones);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* MINESWEEPER_API_H */
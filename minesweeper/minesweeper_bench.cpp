@@ -0,0 +1,60 @@
+// minesweeper_bench.cpp : the benchmarks executable. It is separate from the
+// game so that the game keeps the default allocator: the benchmarks replace
+// the global operator new to count the allocations.
+//
+
+// clang-format off
+#include "pch.h"
+#include "benchmark.hpp"
+
+
+#pragma comment(lib, "SDL2.lib")
+#pragma comment(lib, "SDL2main.lib")
+#pragma comment(lib, "SDL2_image.lib")
+
+// clang-format on
+
+namespace fs = std::filesystem;
+
+int main(int argc, char* argv[]) {
+  fs::path assetsDir = fs::current_path().append("..").append("assets");
+
+  cxxopts::Options options("minesweeper_bench", "minesweeper benchmarks");
+
+  // clang-format off
+  options.add_options()
+      ("assets_dir", "Assest directory", cxxopts::value<std::string>())
+      ("filter", "Only runs the benchmarks whose name contains it", cxxopts::value<std::string>()->default_value(""))
+      ("baseline", "Fails if a benchmark is slower than in this results file", cxxopts::value<std::string>())
+      ("output", "Writes the benchmark results (JSON) to this file", cxxopts::value<std::string>())
+      ("tolerance", "The allowed slow down relative to the baseline", cxxopts::value<double>()->default_value("0.10"));
+  // clang-format on
+
+  auto result = options.parse(argc, argv);
+
+  if (result.count("assets_dir")) {
+    assetsDir = result["assets_dir"].as<std::string>();
+  }
+
+  auto max_size = 1048576 * 5;
+  auto max_files = 3;
+  auto logger = spdlog::rotating_logger_mt(
+      "basic_logger", "logs/minesweeper_bench.log", max_size, max_files);
+  logger->set_level(spdlog::level::debug);
+
+  logger->info("Assets directory: {}", assetsDir.string());
+
+  BenchmarkOptions benchOptions;
+  benchOptions.filter = result["filter"].as<std::string>();
+  benchOptions.tolerance = result["tolerance"].as<double>();
+  if (result.count("baseline")) {
+    benchOptions.baseline = result["baseline"].as<std::string>();
+  }
+  if (result.count("output")) {
+    benchOptions.output = result["output"].as<std::string>();
+  }
+
+  bool passed = Benchmarks(assetsDir, logger).run(benchOptions);
+  logger->flush();
+  return passed ? 0 : 1;
+}
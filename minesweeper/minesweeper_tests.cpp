@@ -0,0 +1,1741 @@
+// minesweeper_tests.cpp : the correctness tests of the board engine. They
+// only link the engine library, so they need no SDL, and they run in
+// seconds; the benchmarks only measure. The only argument, if any, runs the
+// tests whose name contains it.
+//
+
+// clang-format off
+#include "pch.h"
+#include "allocations.hpp"
+#include "bitboard.hpp"
+#include "board.hpp"
+#include "boardcodec.hpp"
+#include "boardgenerator.hpp"
+#include "boardprefetcher.hpp"
+#include "corpus.hpp"
+#include "inputlatency.hpp"
+#include "minesweeper_api.h"
+#include "montecarlo.hpp"
+#include "parallelreveal.hpp"
+#include "patterns.hpp"
+#include "solver.hpp"
+#include "spscqueue.hpp"
+#include "threadpool.hpp"
+#include "triplebuffer.hpp"
+#include "vectorenv.hpp"
+
+// clang-format on
+
+namespace {
+/// The largest error of the mine probabilities of the Monte Carlo sampler
+/// against their exact enumeration; a biased sampler is off by tenths.
+const double kMaxSamplerError = 0.05;
+
+/// The workers of the Monte Carlo determinism check, against a single one.
+const std::size_t kMonteCarloThreads = 4;
+
+/// @brief A board of the allocation checks.
+struct BoardSettings {
+  int size;
+  int mines;
+};
+
+/// The boards of the allocation checks: the difficulty levels and a large
+/// custom board.
+const BoardSettings kAllocationBoards[] = {
+    {9, 10}, {16, 40}, {24, 99}, {256, 9830}};
+
+/// The games of the allocation checks: played once to warm up, then played
+/// again while counting the allocations.
+const std::uint64_t kAllocationGames = 8;
+
+/// The boards, the workers and the batches of random actions of the
+/// vectorized environment allocation check; 256 boards are 4 shards.
+const std::size_t kVecEnvBoards = 256;
+const std::size_t kVecEnvThreads = 2;
+const std::size_t kVecEnvBatches = 64;
+
+/// The largest dimension of the vectorized environment allocation check:
+/// agents train on the difficulty levels.
+const int kVecEnvMaxSize = 24;
+
+/// @brief A position of the chaining check: the mines in the top row, on a
+/// board whose other rows hold no mine.
+struct ChainingPosition {
+  const char* name;
+  int size;
+  std::vector<std::size_t> mines;
+};
+
+/// The canonical positions which the single point rule cannot start but the
+/// pair patterns solve by chaining: the zero rows below reveal a wall of
+/// numbers under the hidden top row.
+const ChainingPosition kChainingPositions[] = {
+    {"1-2-1", 3, {0, 2}},
+    {"1-1-2-1-1", 5, {1, 3}},
+    {"1-2-2-1", 4, {1, 2}},
+};
+
+/// The games and the random actions per game of the bitboard checks.
+const std::uint64_t kBitBoardGames = 200;
+const int kBitBoardActions = 60;
+
+/// The dimensions of the codec checks: the levels, and the boards around
+/// 64x64, the largest one which may be stored as a rank.
+const int kCodecSizes[] = {1, 2, 3, 9, 16, 24, 63, 64, 65, 100};
+
+/// The boards of each dimension of the codec checks, and the workers of
+/// their batches.
+const std::uint64_t kCodecBoards = 24;
+const std::size_t kCodecThreads = 4;
+
+/// The games and the random actions per game of the journal check.
+const std::uint64_t kJournalGames = 50;
+const int kJournalActions = 200;
+
+/// @brief A state of a board of the journal check, after an action.
+struct JournalState {
+  std::vector<std::uint8_t> cells;
+  std::size_t revealed;
+  bool won;
+};
+
+/// The dimension and the mines of the parallel reveal check: at 2% of mines
+/// most of the board is one opening.
+const int kParallelRevealSize = 128;
+const int kParallelRevealMines = kParallelRevealSize * kParallelRevealSize / 50;
+
+/// The block dimensions and the workers of the parallel reveal check; blocks
+/// of one tile hand every neighbour over to another block.
+const int kParallelRevealBlocks[] = {1, 3, 16, 64};
+const std::size_t kParallelRevealThreads[] = {1, 2, 4};
+
+/// The boards of each topology of the parallel reveal check, and their
+/// flags placed at random before the reveal.
+const std::uint64_t kParallelRevealGames = 4;
+const int kParallelRevealFlags = 200;
+
+/// The segments of the corpus check: two of beginner boards and one of
+/// intermediate boards, appended in that order.
+const BoardSettings kCorpusSegments[] = {{9, 10}, {16, 40}, {9, 10}};
+const std::size_t kCorpusRecords = 300;
+
+/// The random 3BV ranges queried by the corpus check.
+const int kCorpusQueries = 50;
+
+/// The boards the generator must reject: no tile, no safe tile, a negative
+/// number of mines, and a dimension whose tiles overflow an int.
+const BoardSettings kInvalidBoards[] = {
+    {0, 0}, {-1, 0}, {3, 9}, {3, 10}, {3, -1}, {kMaxBoardSize + 1, 0}};
+
+/// The dense boards of the generator check, placed by the shuffle: the
+/// boards around half of the tiles and the boards with a single safe tile.
+const BoardSettings kDenseBoards[] = {{9, 40},    {9, 41},     {3, 8},
+                                      {9, 80},    {100, 9999}, {256, 65535},
+                                      {256, 50000}};
+
+/// The boards of each dense board of the generator check: each tile of a
+/// 3x3 board is then the safe one about 30 times.
+const std::uint64_t kDenseGames = 270;
+
+/// The dimensions of the topology checks: the boards too small for some
+/// neighbours, and boards where every offset stays inside.
+const int kTopologySizes[] = {1, 2, 3, 4, 5, 8, 9, 16};
+
+/// The boards of the openings check: dimensions and mines from the smallest
+/// boards to dense and sparse large ones, so that the openings touch the
+/// edges, wrap around the torus and merge through long chains.
+const BoardSettings kOpeningBoards[] = {{1, 0}, {2, 1},  {3, 1},  {9, 10},
+                                        {16, 40}, {24, 99}, {50, 100},
+                                        {50, 1000}};
+const std::uint64_t kOpeningGames = 20;
+
+/// @brief A board of the prefetcher check.
+struct PrefetchBoard {
+  int size;
+  int mines;
+  TopologyKind topology;
+};
+
+/// The permanent queues of the prefetcher check.
+const PrefetchBoard kPrefetchWanted[] = {{9, 10, TopologyKind::Square},
+                                         {16, 40, TopologyKind::Hex}};
+
+/// The custom boards of the prefetcher check: large enough for the producer
+/// to be filling one when the custom board is switched, and a permanent one,
+/// which empties the custom slot.
+const PrefetchBoard kPrefetchCustom[] = {{200, 4000, TopologyKind::Square},
+                                         {200, 4000, TopologyKind::Torus},
+                                         {201, 4000, TopologyKind::Square},
+                                         {150, 9000, TopologyKind::Knight},
+                                         {9, 10, TopologyKind::Square}};
+
+/// The switches of the custom board, and the longest wait of the prefetcher
+/// check for the producer to fill a queue.
+const int kPrefetchSwitches = 300;
+const auto kPrefetchTimeout = std::chrono::seconds(30);
+
+/// The clicks of the frame handoff check, sent in bursts as a frame of the
+/// game collects the pending events.
+const std::uint64_t kHandoffInputs = 4000;
+const std::uint64_t kHandoffBurst = 4;
+
+/// @brief A click of the frame handoff check; id 0 stops the logic thread.
+struct HandoffInput {
+  int row;
+  int col;
+  std::uint64_t id;
+  std::chrono::steady_clock::time_point time;
+};
+
+/// @brief A snapshot of the frame handoff check.
+struct HandoffFrame {
+  std::vector<std::uint8_t> cells;
+  std::size_t revealed{0};    //!< The revealed safe tiles of the cells.
+  std::uint64_t inputId{0};  //!< The last input applied.
+  std::chrono::steady_clock::time_point inputTime;
+};
+
+/// @brief A test: run() returns true if it passed, and prints why it failed
+/// otherwise.
+struct Test {
+  const char* name;
+  bool (*run)();
+};
+
+/// @brief Returns a board with its largest opening revealed, the position at
+/// which a player first has to guess.
+Board openedBoard(int size, int mines) {
+  BoardGenerator generator(size, mines);
+  generator.seed(1);
+  generator.generate();
+
+  Board board;
+  board.setTiles(size, generator.getTiles());
+  int start = std::max(generator.getLargestOpeningTile(), 0);
+  board.reveal(start / size, start % size);
+  return board;
+}
+
+/// @brief Returns count distinct tiles of n, in increasing order.
+std::vector<std::size_t> randomMines(std::size_t n, std::size_t count,
+                                     std::mt19937_64& random) {
+  std::vector<std::size_t> tiles(n);
+  std::iota(tiles.begin(), tiles.end(), std::size_t{0});
+  for (std::size_t i = 0; i < count; i++) {
+    std::swap(tiles[i], tiles[i + random() % (n - i)]);
+  }
+  tiles.resize(count);
+  std::sort(tiles.begin(), tiles.end());
+  return tiles;
+}
+
+/// @brief The solver trusts the pattern table: checks it against the brute
+/// force enumeration of the layouts of each window.
+bool pairTable() {
+  std::size_t wrong = verifyPairTable();
+  if (wrong != 0) {
+    fmt::print("  {} wrong entries in the pair pattern table\n", wrong);
+  }
+  return wrong == 0;
+}
+
+/// @brief The Monte Carlo guesses are only as good as the sampled layouts:
+/// checks their mine probabilities against the exact ones.
+bool monteCarloSampler() {
+  ThreadPool pool;
+  double error = verifyMonteCarloSampler(pool);
+  if (error > kMaxSamplerError) {
+    fmt::print("  the sampler is off by {:.3f}\n", error);
+  }
+  return error <= kMaxSamplerError;
+}
+
+/// @brief Checks that a Monte Carlo search ranks the guesses the same with one
+/// worker and with several: its random streams only depend on the seed.
+bool monteCarloDeterministic() {
+  Board view = openedBoard(16, 40);
+
+  MonteCarloOptions options;
+  options.seed = 1;
+  options.samplesPerRound = 2 * kMonteCarloThreads;
+  options.maxRounds = 2;
+  // the rounds must not be cut short by the budget
+  options.timeBudget = std::chrono::hours(1);
+
+  ThreadPool one(1);
+  ThreadPool many(kMonteCarloThreads);
+  MonteCarloResult a = MonteCarloEngine(one).bestGuess(view, options);
+  MonteCarloResult b = MonteCarloEngine(many).bestGuess(view, options);
+
+  if (a.estimates.empty() || a.estimates.size() != b.estimates.size()) {
+    fmt::print("  {} estimates with 1 worker, {} with {}\n",
+               a.estimates.size(), b.estimates.size(), kMonteCarloThreads);
+    return false;
+  }
+  for (std::size_t i = 0; i < a.estimates.size(); i++) {
+    const GuessEstimate& x = a.estimates[i];
+    const GuessEstimate& y = b.estimates[i];
+    if (x.position.row != y.position.row || x.position.col != y.position.col ||
+        x.winProbability != y.winProbability ||
+        x.mineProbability != y.mineProbability) {
+      fmt::print("  estimate {} differs with 1 and {} workers\n", i,
+                 kMonteCarloThreads);
+      return false;
+    }
+  }
+  return true;
+}
+
+/// @brief Checks that the rollouts are counted where they are played: a
+/// candidate which is a mine in a sample plays no rollout in it.
+bool monteCarloRolloutsCount() {
+  Board view = openedBoard(16, 40);
+
+  MonteCarloOptions options;
+  options.seed = 1;
+  options.samplesPerRound = 16;
+  options.maxRounds = 2;
+  options.timeBudget = std::chrono::hours(1);
+
+  ThreadPool pool(2);
+  MonteCarloResult result = MonteCarloEngine(pool).bestGuess(view, options);
+  const std::size_t samples =
+      options.samplesPerRound * result.rounds - result.rejectedSamples;
+
+  std::size_t rollouts = 0;
+  for (const GuessEstimate& estimate : result.estimates) {
+    rollouts += estimate.rollouts;
+    if (estimate.rollouts > samples ||
+        (estimate.mineProbability > 0 && estimate.rollouts == samples)) {
+      fmt::print("  {} rollouts from ({}, {}) in {} samples, mine {:.3f}\n",
+                 estimate.rollouts, estimate.position.row,
+                 estimate.position.col, samples, estimate.mineProbability);
+      return false;
+    }
+  }
+  if (rollouts != result.rollouts) {
+    fmt::print("  {} rollouts in total, {} from the candidates\n",
+               result.rollouts, rollouts);
+    return false;
+  }
+  return true;
+}
+
+/// @brief The pair table only holds the windows of two tiles: checks that
+/// chaining its deductions solves the patterns of three and four tiles.
+bool pairChaining() {
+  bool passed = true;
+  for (const ChainingPosition& position : kChainingPositions) {
+    const int size = position.size;
+    auto play = [&position, size](bool pairPatterns, Board& board) {
+      board = Board(size, static_cast<int>(position.mines.size()));
+      board.setMines(position.mines);
+      board.reveal(size - 1, 0);
+
+      Solver solver;
+      solver.setPairPatterns(pairPatterns);
+      return solver.solve(board);
+    };
+
+    Board board;
+    if (play(false, board) != Solver::Status::Stuck) {
+      fmt::print("  {}: the single point rule does not get stuck\n",
+                 position.name);
+      passed = false;
+    }
+    if (play(true, board) != Solver::Status::Won) {
+      fmt::print("  {}: the pair patterns do not solve it\n", position.name);
+      passed = false;
+    }
+    for (std::size_t i = 0; i < board.cellsCount(); i++) {
+      if (board.isFlagged(i) && !board.isMine(i)) {
+        fmt::print("  {}: tile {} is flagged but safe\n", position.name, i);
+        passed = false;
+      }
+    }
+  }
+  return passed;
+}
+
+/// @brief Plays the same random actions on a Board and on a bitboard of a
+/// level and compares what a player sees after each one.
+template <typename B>
+bool bitBoardMatches(int size, int mines) {
+  BoardGenerator generator(size, mines);
+  Board board;
+  B bits;
+  std::vector<std::uint8_t> expected(static_cast<std::size_t>(size) * size);
+  std::vector<std::uint8_t> actual(expected.size());
+  std::mt19937 random(1);
+  std::uniform_int_distribution<int> coord(0, size - 1);
+  std::uniform_int_distribution<int> kind(0, 5);
+
+  for (std::uint64_t seed = 1; seed <= kBitBoardGames; seed++) {
+    generator.seed(seed);
+    generator.generate();
+    board.setTiles(size, generator.getTiles());
+    bits.setTiles(generator.getTiles());
+
+    // the first click moves its mine away, as VectorEnv does
+    int row = coord(random);
+    int col = coord(random);
+    std::size_t i = board.index(row, col);
+    std::size_t to = 0;
+    while (board.isMine(to) || to == i) {
+      to++;
+    }
+    if (board.relocateMine(i, to) != bits.relocateMine(i, to)) {
+      fmt::print("  {}x{} game {}: the relocations differ\n", size, size,
+                 seed);
+      return false;
+    }
+    board.reveal(row, col);
+    bits.reveal(row, col);
+
+    for (int k = 0; k < kBitBoardActions && !board.won(); k++) {
+      row = coord(random);
+      col = coord(random);
+      int action = kind(random);
+      RevealResult a = RevealResult::None;
+      RevealResult b = RevealResult::None;
+      if (action == 0) {
+        a = board.toggleFlag(row, col) ? RevealResult::Revealed
+                                       : RevealResult::None;
+        b = bits.toggleFlag(row, col) ? RevealResult::Revealed
+                                      : RevealResult::None;
+      } else if (action == 1) {
+        a = board.chord(row, col);
+        b = bits.chord(row, col);
+      } else if (!board.isMine(board.index(row, col))) {
+        a = board.reveal(row, col);
+        b = bits.reveal(row, col);
+      }
+
+      for (std::size_t j = 0; j < expected.size(); j++) {
+        std::uint8_t cell = board.cells()[j];
+        expected[j] = static_cast<std::uint8_t>(
+            cell & (cell & kCellRevealed ? 0xFF : kCellFlagged));
+      }
+      bits.observe(actual.data());
+      if (a != b || expected != actual ||
+          board.revealedCount() != bits.revealedCount() ||
+          board.won() != bits.won()) {
+        fmt::print("  {}x{} game {}: action {} on ({}, {}) differs\n", size,
+                   size, seed, action, row, col);
+        return false;
+      }
+      if (a == RevealResult::Mine) {
+        break;
+      }
+    }
+  }
+  return true;
+}
+
+/// @brief Checks that the bitboards of the levels, which VectorEnv plays,
+/// follow the rules of Board, and that Solver deduces the same with and
+/// without them.
+bool bitBoards() {
+  bool passed = bitBoardMatches<BeginnerBitBoard>(9, 10) &&
+                bitBoardMatches<IntermediateBitBoard>(16, 40) &&
+                bitBoardMatches<AdvancedBitBoard>(24, 99);
+
+  for (const BoardSettings& settings : kAllocationBoards) {
+    const int size = settings.size;
+    if (size > kVecEnvMaxSize) {
+      continue;
+    }
+
+    BoardGenerator generator(size, settings.mines);
+    Board a;
+    Board b;
+    Solver bits;
+    Solver scalar;
+    scalar.setBitBoards(false);
+    for (std::uint64_t seed = 1; seed <= kBitBoardGames; seed++) {
+      generator.seed(seed);
+      generator.generate();
+      int start = std::max(generator.getLargestOpeningTile(), 0);
+      for (Board* board : {&a, &b}) {
+        board->setTiles(size, generator.getTiles());
+        board->reveal(start / size, start % size);
+      }
+
+      if (bits.solve(a) != scalar.solve(b) || a.cells() != b.cells()) {
+        fmt::print("  {}x{} game {}: the solvers differ\n", size, size,
+                   seed);
+        passed = false;
+        break;
+      }
+    }
+  }
+  return passed;
+}
+
+/// @brief Encodes random boards, in both formats, and checks that they decode
+/// to the same mines and tiles, one by one and in batches, and that their
+/// truncated records are rejected.
+bool codecRoundTrip() {
+  BoardCodec codec;
+  ThreadPool pool(kCodecThreads);
+  std::mt19937_64 random(1);
+  std::vector<std::uint8_t> record;
+  std::vector<std::uint8_t> cells;
+  std::vector<std::size_t> mines;
+  bool formats[2] = {false, false};
+
+  for (int size : kCodecSizes) {
+    const std::size_t n = static_cast<std::size_t>(size) * size;
+    std::vector<std::uint8_t> boards;
+
+    for (std::uint64_t b = 0; b < kCodecBoards; b++) {
+      // an empty and a full board, then random densities
+      std::size_t count = b == 0 ? 0 : (b == 1 ? n : random() % (n + 1));
+      std::vector<std::size_t> expected = randomMines(n, count, random);
+      Board board(size, static_cast<int>(count));
+      board.setMines(expected);
+      BasicBoard<HexTopology> hex(size, static_cast<int>(count));
+      hex.setMines(expected);
+
+      BoardCodec::Format format;
+      record.resize(codec.encodedSize(size, count, format));
+      formats[static_cast<int>(format)] = true;
+      int decodedSize = 0;
+      if (codec.encode(board.cells().data(), size, record.data()) !=
+              record.size() ||
+          record[0] != static_cast<std::uint8_t>(format) ||
+          codec.decodeMines(record.data(), record.size(), decodedSize,
+                            mines) != record.size() ||
+          decodedSize != size || mines != expected ||
+          codec.decode(record.data(), record.size(), decodedSize, cells) !=
+              record.size() ||
+          cells != board.cells() ||
+          codec.decode<HexTopology>(record.data(), record.size(),
+                                    decodedSize, cells) != record.size() ||
+          cells != hex.cells()) {
+        fmt::print("  {}x{} with {} mines: the round trip differs\n", size,
+                   size, count);
+        return false;
+      }
+
+      for (std::size_t length = 0; length < record.size(); length++) {
+        if (codec.decodeMines(record.data(), length, decodedSize, mines) !=
+            0) {
+          fmt::print("  {}x{} with {} mines: accepted {} of {} bytes\n", size,
+                     size, count, length, record.size());
+          return false;
+        }
+      }
+      boards.insert(boards.end(), board.cells().begin(), board.cells().end());
+    }
+
+    std::vector<std::uint8_t> records;
+    std::vector<std::size_t> offsets;
+    BoardCodec::encodeBatch(pool, boards.data(), size, kCodecBoards, records,
+                            offsets);
+    int decodedSize = 0;
+    if (BoardCodec::decodeBatch(pool, records.data(), records.size(),
+                                decodedSize, cells) != kCodecBoards ||
+        decodedSize != size || cells != boards ||
+        BoardCodec::decodeBatch(pool, records.data(), records.size() - 1,
+                                decodedSize, cells) != 0) {
+      fmt::print("  {}x{}: the batch round trip differs\n", size, size);
+      return false;
+    }
+  }
+
+  if (!formats[0] || !formats[1]) {
+    fmt::print("  the boards did not use both formats\n");
+    return false;
+  }
+  return true;
+}
+
+/// @brief Checks that the decoder accepts exactly one record per board:
+/// every rank of small boards is tried, and records in the other format,
+/// with padding bits, with long varints or with mixed dimensions are
+/// rejected.
+bool codecRejectsMalformed() {
+  // dimension, mines and C(size * size, mines), in 1 and 2 byte ranks
+  const struct {
+    int size;
+    std::size_t mines;
+    std::size_t boards;
+  } kRanks[] = {{3, 2, 36}, {4, 2, 120}, {5, 3, 2300}};
+
+  BoardCodec codec;
+  std::vector<std::size_t> mines;
+  std::vector<std::uint8_t> encoded;
+  int size = 0;
+
+  for (const auto& rank : kRanks) {
+    BoardCodec::Format format;
+    std::size_t length = codec.encodedSize(rank.size, rank.mines, format);
+    std::size_t bytes = length - 3;
+    std::vector<std::uint8_t> record = {
+        static_cast<std::uint8_t>(BoardCodec::Format::Rank),
+        static_cast<std::uint8_t>(rank.size),
+        static_cast<std::uint8_t>(rank.mines)};
+    record.resize(length);
+
+    // the ranks below C(n, m) are the boards, each one encoded back into
+    // its rank; the ones above it are rejected
+    std::size_t accepted = 0;
+    for (std::size_t value = 0; value < (std::size_t{1} << (8 * bytes));
+         value++) {
+      for (std::size_t b = 0; b < bytes; b++) {
+        record[3 + b] = static_cast<std::uint8_t>(value >> (8 * b));
+      }
+      if (codec.decodeMines(record.data(), length, size, mines) == 0) {
+        continue;
+      }
+      Board board(rank.size, static_cast<int>(rank.mines));
+      board.setMines(mines);
+      encoded.resize(length);
+      codec.encode(board.cells().data(), rank.size, encoded.data());
+      if (value >= rank.boards || encoded != record) {
+        fmt::print("  {}x{} with {} mines: rank {} is not canonical\n",
+                   rank.size, rank.size, rank.mines, value);
+        return false;
+      }
+      accepted++;
+    }
+    if (format != BoardCodec::Format::Rank || accepted != rank.boards) {
+      fmt::print("  {}x{} with {} mines: {} ranks accepted, expected {}\n",
+                 rank.size, rank.size, rank.mines, accepted, rank.boards);
+      return false;
+    }
+  }
+
+  // 65x65: 4225 tiles, the last byte of the bitmap has 7 padding bits
+  Board board(65, 1);
+  board.setMines({4224});
+  BoardCodec::Format format;
+  std::vector<std::uint8_t> bitmap(codec.encodedSize(65, 1, format));
+  codec.encode(board.cells().data(), 65, bitmap.data());
+  std::vector<std::uint8_t> padded = bitmap;
+  padded.back() |= 0x80;
+
+  std::vector<std::uint8_t> records = bitmap;
+  std::vector<std::uint8_t> rank(codec.encodedSize(9, 10, format));
+  Board level(9, 10);
+  level.setMines({0, 1, 2, 3, 4, 5, 6, 7, 8, 9});
+  codec.encode(level.cells().data(), 9, rank.data());
+  records.insert(records.end(), rank.begin(), rank.end());
+
+  const std::vector<std::uint8_t> kInvalid[] = {
+      padded,
+      {static_cast<std::uint8_t>(BoardCodec::Format::Bitmap), 3, 2, 0x03,
+       0x00},
+      {static_cast<std::uint8_t>(BoardCodec::Format::Rank), 0x83, 0x00, 2,
+       0x00},
+      {static_cast<std::uint8_t>(BoardCodec::Format::Rank), 3, 0x82, 0x00,
+       0x00},
+      {2, 3, 2, 0x00},
+      {static_cast<std::uint8_t>(BoardCodec::Format::Rank), 0, 0},
+      {static_cast<std::uint8_t>(BoardCodec::Format::Bitmap), 3, 10, 0xFF,
+       0x01},
+  };
+  if (codec.decodeMines(bitmap.data(), bitmap.size(), size, mines) !=
+      bitmap.size()) {
+    fmt::print("  the 65x65 bitmap was rejected\n");
+    return false;
+  }
+  for (std::size_t i = 0; i < std::size(kInvalid); i++) {
+    if (codec.decodeMines(kInvalid[i].data(), kInvalid[i].size(), size,
+                          mines) != 0) {
+      fmt::print("  malformed record {} accepted\n", i);
+      return false;
+    }
+  }
+
+  ThreadPool pool(kCodecThreads);
+  std::vector<std::uint8_t> cells;
+  if (BoardCodec::decodeBatch(pool, records.data(), records.size(), size,
+                              cells) != 0) {
+    fmt::print("  a batch of mixed dimensions was accepted\n");
+    return false;
+  }
+  return true;
+}
+
+/// @brief Plays random actions on a journaled board, moving through the
+/// history at random with undo(), redo() and checkout() across the branches,
+/// and checks that the board is restored to the state it had after each
+/// action.
+template <typename Topology>
+bool journalCheckout(int size, int mines) {
+  BoardGenerator generator(size, mines);
+  BasicBoard<Topology> board;
+  BoardJournal journal;
+  std::vector<JournalState> states;
+  std::mt19937 random(1);
+  std::uniform_int_distribution<int> coord(0, size - 1);
+  std::uniform_int_distribution<int> kind(0, 7);
+
+  auto save = [&]() {
+    states.resize(journal.actionsCount());
+    states[journal.current()] = {board.cells(), board.revealedCount(),
+                                 board.won()};
+  };
+  auto restored = [&]() {
+    const JournalState& state = states[journal.current()];
+    return board.cells() == state.cells &&
+           board.revealedCount() == state.revealed &&
+           board.won() == state.won;
+  };
+
+  for (std::uint64_t seed = 1; seed <= kJournalGames; seed++) {
+    generator.seed(seed);
+    generator.generate<Topology>();
+    board.setTiles(size, generator.getTiles());
+    journal.clear();
+    board.setJournal(&journal);
+    save();
+
+    // a first click on a mine moves it away: Game records the relocation
+    // and the reveal as one action
+    std::size_t first = 0;
+    while (!board.isMine(first)) {
+      first++;
+    }
+    {
+      JournalScope click(&journal);
+      std::size_t to = 0;
+      while (board.isMine(to)) {
+        to++;
+      }
+      board.relocateMine(first, to);
+      board.reveal(static_cast<int>(first / size),
+                   static_cast<int>(first % size));
+    }
+    save();
+
+    for (int k = 0; k < kJournalActions; k++) {
+      int action = kind(random);
+      int row = coord(random);
+      int col = coord(random);
+      if (action == 0) {
+        journal.undo(board);
+      } else if (action == 1) {
+        journal.redo(board);
+      } else if (action == 2) {
+        journal.checkout(board, static_cast<BoardJournal::ActionId>(
+                                    random() % journal.actionsCount()));
+      } else {
+        if (action == 3) {
+          board.toggleFlag(row, col);
+        } else if (action == 4) {
+          board.chord(row, col);
+        } else if (!board.isMine(board.index(row, col))) {
+          board.reveal(row, col);
+        }
+        save();
+        continue;
+      }
+
+      if (!restored()) {
+        fmt::print("  {} {}x{} game {}: action {} did not restore action {}\n",
+                   Topology::kName, size, size, seed, action,
+                   journal.current());
+        return false;
+      }
+    }
+
+    // back to the base state, the relocated mine included
+    journal.checkout(board, BoardJournal::kRoot);
+    if (!restored() || !board.isMine(first)) {
+      fmt::print("  {} {}x{} game {}: the base state was not restored\n",
+                 Topology::kName, size, size, seed);
+      return false;
+    }
+    board.setJournal(nullptr);
+  }
+  return true;
+}
+
+/// @brief Checks the journal's undo, redo and checkout on the square and the
+/// hexagonal boards.
+bool journal() {
+  return journalCheckout<SquareTopology>(16, 40) &&
+         journalCheckout<HexTopology>(16, 40);
+}
+
+/// @brief Compares ParallelReveal with BasicBoard::reveal() on boards with
+/// flags, for each block dimension and number of workers, and checks that
+/// undoing its journaled action restores the board.
+template <typename Topology>
+bool parallelRevealMatches(std::vector<std::unique_ptr<ThreadPool>>& pools) {
+  const int size = kParallelRevealSize;
+  BoardGenerator generator(size, kParallelRevealMines);
+  BasicBoard<Topology> before;
+  BasicBoard<Topology> expected;
+  BasicBoard<Topology> board;
+  BoardJournal journal;
+  std::mt19937 random(1);
+  std::uniform_int_distribution<int> coord(0, size - 1);
+
+  for (std::uint64_t seed = 1; seed <= kParallelRevealGames; seed++) {
+    generator.seed(seed);
+    generator.generate<Topology>();
+    before.setTiles(size, generator.getTiles());
+    for (int k = 0; k < kParallelRevealFlags; k++) {
+      before.toggleFlag(coord(random), coord(random));
+    }
+
+    // the largest opening, then a random tile (maybe a number or a mine)
+    int start = std::max(generator.getLargestOpeningTile(), 0);
+    const int starts[][2] = {{start / size, start % size},
+                             {coord(random), coord(random)}};
+    for (const auto& tile : starts) {
+      expected = before;
+      RevealResult result = expected.reveal(tile[0], tile[1]);
+
+      for (int blockSize : kParallelRevealBlocks) {
+        ParallelReveal reveal(blockSize);
+        for (std::unique_ptr<ThreadPool>& pool : pools) {
+          board = before;
+          journal.clear();
+          board.setJournal(&journal);
+          RevealResult parallel = reveal.reveal(*pool, board, tile[0], tile[1]);
+
+          bool matches = parallel == result &&
+                         board.cells() == expected.cells() &&
+                         board.revealedCount() == expected.revealedCount();
+          // the reveal is a single action, or none if nothing changed
+          bool oneAction = journal.actionsCount() ==
+                           (board.cells() == before.cells() ? 1u : 2u);
+          journal.undo(board);
+          board.setJournal(nullptr);
+          if (!matches || !oneAction || board.cells() != before.cells() ||
+              board.revealedCount() != before.revealedCount()) {
+            fmt::print(
+                "  {} game {}: reveal ({}, {}) with {}x{} blocks and {} "
+                "workers {}\n",
+                Topology::kName, seed, tile[0], tile[1], blockSize, blockSize,
+                pool->size(),
+                matches ? "was not undone" : "differs from the sequential one");
+            return false;
+          }
+        }
+      }
+    }
+  }
+  return true;
+}
+
+/// @brief Checks the parallel reveal on the four topologies.
+bool parallelReveal() {
+  std::vector<std::unique_ptr<ThreadPool>> pools;
+  for (std::size_t threads : kParallelRevealThreads) {
+    pools.emplace_back(std::make_unique<ThreadPool>(threads));
+  }
+  return parallelRevealMatches<SquareTopology>(pools) &&
+         parallelRevealMatches<TorusTopology>(pools) &&
+         parallelRevealMatches<HexTopology>(pools) &&
+         parallelRevealMatches<KnightTopology>(pools);
+}
+
+/// @brief Returns the records matching a query, by brute force.
+std::vector<CorpusRecord> matchingRecords(
+    const std::vector<CorpusRecord>& records, const CorpusQuery& query) {
+  std::vector<CorpusRecord> matches;
+  for (const CorpusRecord& record : records) {
+    if (record.size == query.size &&
+        static_cast<int>(record.mines) == query.mines &&
+        record.bbbv >= query.min3BV && record.bbbv <= query.max3BV &&
+        (record.noGuess || !query.noGuessOnly)) {
+      matches.push_back(record);
+    }
+  }
+  return matches;
+}
+
+/// @brief Sorts records by seed, for comparing sets of records.
+void sortBySeed(std::vector<CorpusRecord>& records) {
+  std::sort(records.begin(), records.end(),
+            [](const CorpusRecord& a, const CorpusRecord& b) {
+              return std::tie(a.size, a.seed) < std::tie(b.size, b.seed);
+            });
+}
+
+/// @brief Returns true if two records have the same fields.
+bool sameRecord(const CorpusRecord& a, const CorpusRecord& b) {
+  return std::tie(a.seed, a.size, a.mines, a.bbbv, a.openings, a.start,
+                  a.noGuess) == std::tie(b.seed, b.size, b.mines, b.bbbv,
+                                         b.openings, b.start, b.noGuess);
+}
+
+/// @brief Generates and appends segments to a corpus file, then checks that
+/// the queries find the same records as a brute force filter, that a torn
+/// append is ignored and then overwritten, and that a misaligned segment is
+/// rejected.
+bool corpus() {
+  const std::filesystem::path path =
+      std::filesystem::temp_directory_path() / "minesweeper_tests.corpus";
+  std::filesystem::remove(path);
+
+  ThreadPool pool(2);
+  std::vector<CorpusRecord> all;
+  std::uint64_t seed = 1;
+  std::uintmax_t complete = 0;
+  for (const BoardSettings& settings : kCorpusSegments) {
+    std::vector<CorpusRecord> records;
+    BoardCorpus::generate(pool, settings.size, settings.mines, seed,
+                          kCorpusRecords, records);
+    seed += kCorpusRecords;
+    complete = std::filesystem::exists(path)
+                   ? std::filesystem::file_size(path)
+                   : 0;
+    if (!BoardCorpus::append(path, records)) {
+      fmt::print("  cannot append to {}\n", path.string());
+      return false;
+    }
+    all.insert(all.end(), records.begin(), records.end());
+  }
+
+  auto check = [&all](const BoardCorpus& corpus, std::size_t expected) {
+    if (corpus.size() != expected) {
+      fmt::print("  {} records, expected {}\n", corpus.size(), expected);
+      return false;
+    }
+    std::vector<CorpusRecord> present(all.begin(), all.begin() + expected);
+    std::mt19937 random(1);
+    for (int q = 0; q < kCorpusQueries; q++) {
+      const BoardSettings& settings = kCorpusSegments[q % 2];
+      CorpusQuery query;
+      query.size = settings.size;
+      query.mines = settings.mines;
+      query.min3BV = random() % 60;
+      query.max3BV = q % 5 == 0 ? UINT32_MAX : query.min3BV + random() % 30;
+      query.noGuessOnly = q % 3 == 0;
+
+      std::vector<CorpusRecord> expectedRecords =
+          matchingRecords(present, query);
+      std::vector<CorpusRecord> found;
+      corpus.query(query, found);
+      bool ordered = true;
+      for (std::size_t i = 0; i < found.size() && ordered; i++) {
+        CorpusRecord record;
+        ordered = corpus.at(query, i, record) && sameRecord(record, found[i]);
+      }
+      sortBySeed(expectedRecords);
+      sortBySeed(found);
+      if (!std::equal(found.begin(), found.end(), expectedRecords.begin(),
+                      expectedRecords.end(), sameRecord) ||
+          corpus.count(query) != expectedRecords.size() || !ordered) {
+        fmt::print("  {}x{} 3BV [{}, {}]{}: {} records, expected {}\n",
+                   query.size, query.size, query.min3BV, query.max3BV,
+                   query.noGuessOnly ? " no guess" : "", found.size(),
+                   expectedRecords.size());
+        return false;
+      }
+    }
+    return true;
+  };
+
+  BoardCorpus corpus;
+  bool passed = corpus.open(path) && check(corpus, all.size());
+  corpus.close();
+
+  // the last append dies halfway: the previous segments remain, and the
+  // next append replaces the torn one
+  std::uintmax_t full = std::filesystem::file_size(path);
+  std::filesystem::resize_file(path, (complete + full) / 2);
+  passed = passed && corpus.open(path) &&
+           check(corpus, all.size() - kCorpusRecords);
+  corpus.close();
+
+  std::vector<CorpusRecord> last(all.end() - kCorpusRecords, all.end());
+  passed = passed && BoardCorpus::append(path, last) &&
+           std::filesystem::file_size(path) == full && corpus.open(path) &&
+           check(corpus, all.size());
+  corpus.close();
+
+  // a segment size which is not a multiple of 8 misaligns the next columns
+  std::filesystem::resize_file(path, full + 4);
+  {
+    std::fstream file(path,
+                      std::ios::binary | std::ios::in | std::ios::out);
+    std::uint64_t bytes;
+    file.seekg(16);
+    file.read(reinterpret_cast<char*>(&bytes), sizeof bytes);
+    bytes += 4;
+    file.seekp(16);
+    file.write(reinterpret_cast<const char*>(&bytes), sizeof bytes);
+  }
+  if (passed && corpus.open(path)) {
+    fmt::print("  a misaligned segment was accepted\n");
+    passed = false;
+  }
+
+  std::filesystem::remove(path);
+  return passed;
+}
+
+/// @brief Checks that the generator rejects the invalid boards, that the
+/// dense boards hold their mines, and that each tile of a nearly full 3x3
+/// board is the safe one in some board.
+bool generatorBounds() {
+  BoardGenerator generator(9, 10);
+  for (const BoardSettings& settings : kInvalidBoards) {
+    try {
+      generator.reset(settings.size, settings.mines);
+      fmt::print("  accepted {} mines on {}x{}\n", settings.mines,
+                 settings.size, settings.size);
+      return false;
+    } catch (const std::invalid_argument&) {
+    }
+  }
+
+  for (const BoardSettings& settings : kDenseBoards) {
+    const std::size_t n = static_cast<std::size_t>(settings.size) *
+                          settings.size;
+    generator.reset(settings.size, settings.mines);
+    std::vector<std::uint64_t> safe(n);
+    for (std::uint64_t seed = 1; seed <= kDenseGames; seed++) {
+      generator.seed(seed);
+      generator.generate();
+      const std::vector<int>& tiles = generator.getTiles();
+      std::size_t mines = 0;
+      for (std::size_t i = 0; i < n; i++) {
+        bool mine = tiles[i] == static_cast<int>(kMineTileValue);
+        mines += mine;
+        safe[i] += !mine;
+      }
+      if (mines != static_cast<std::size_t>(settings.mines)) {
+        fmt::print("  {}x{}: {} mines instead of {}\n", settings.size,
+                   settings.size, mines, settings.mines);
+        return false;
+      }
+    }
+
+    if (settings.size == 3 &&
+        std::find(safe.begin(), safe.end(), 0) != safe.end()) {
+      fmt::print("  {}x{}: a tile always holds a mine\n", settings.size,
+                 settings.size);
+      return false;
+    }
+  }
+  return true;
+}
+
+/// @brief Checks the neighbours of a topology: distinct tiles of the board,
+/// other than the tile, at most 8 (exactly 8 on the torus), symmetric, and
+/// forEachHalfNeighbour visiting each pair of neighbours exactly once.
+template <typename Topology>
+bool topologyMatches() {
+  for (int size : kTopologySizes) {
+    if (size < Topology::kMinSize) {
+      continue;
+    }
+    const int n = size * size;
+    std::vector<std::vector<int>> neighbours(n);
+    for (int i = 0; i < n; i++) {
+      Topology::forEachNeighbour(i / size, i % size, size, [&](int r, int c) {
+        neighbours[i].push_back(r >= 0 && r < size && c >= 0 && c < size
+                                    ? r * size + c
+                                    : -1);
+      });
+      std::vector<int> sorted = neighbours[i];
+      std::sort(sorted.begin(), sorted.end());
+      bool torus = Topology::kKind == TopologyKind::Torus;
+      if (sorted.size() > 8 || (torus && sorted.size() != 8) ||
+          (!sorted.empty() && sorted[0] < 0) ||
+          std::binary_search(sorted.begin(), sorted.end(), i) ||
+          std::adjacent_find(sorted.begin(), sorted.end()) != sorted.end()) {
+        fmt::print("  {} {}x{}: tile {} has invalid neighbours\n",
+                   Topology::kName, size, size, i);
+        return false;
+      }
+    }
+
+    // the times each pair of tiles is visited by forEachHalfNeighbour
+    std::vector<int> visits(static_cast<std::size_t>(n) * n);
+    for (int i = 0; i < n; i++) {
+      Topology::forEachHalfNeighbour(i / size, i % size, size,
+                                     [&](int r, int c) {
+                                       int j = r * size + c;
+                                       visits[std::min(i, j) * n +
+                                              std::max(i, j)]++;
+                                     });
+    }
+    for (int i = 0; i < n; i++) {
+      for (int j = i + 1; j < n; j++) {
+        auto has = [&neighbours](int a, int b) {
+          return std::find(neighbours[a].begin(), neighbours[a].end(), b) !=
+                 neighbours[a].end();
+        };
+        if (has(i, j) != has(j, i) || visits[i * n + j] != has(i, j)) {
+          fmt::print("  {} {}x{}: tiles {} and {} are neighbours {}/{}, "
+                     "visited {} times\n",
+                     Topology::kName, size, size, i, j, has(i, j), has(j, i),
+                     visits[i * n + j]);
+          return false;
+        }
+      }
+    }
+  }
+  return true;
+}
+
+/// @brief Checks the neighbours of the four topologies, and that the boards
+/// too small for the torus are rejected.
+bool topologies() {
+  if (!topologyMatches<SquareTopology>() ||
+      !topologyMatches<TorusTopology>() || !topologyMatches<HexTopology>() ||
+      !topologyMatches<KnightTopology>()) {
+    return false;
+  }
+
+  BoardCodec codec;
+  ThreadPool pool(2);
+  BoardPrefetcher prefetcher;
+  std::vector<std::uint8_t> record;
+  std::vector<std::uint8_t> cells;
+  for (int size = 1; size < TorusTopology::kMinSize; size++) {
+    BoardGenerator generator(size, 0);
+    bool generated = true;
+    try {
+      generator.generate<TorusTopology>();
+    } catch (const std::invalid_argument&) {
+      generated = false;
+    }
+
+    bool prefetched = true;
+    try {
+      prefetcher.setCustom(size, 0, TopologyKind::Torus);
+    } catch (const std::invalid_argument&) {
+      prefetched = false;
+    }
+
+    Board board(size, 0);
+    BoardCodec::Format format;
+    record.resize(codec.encodedSize(size, 0, format));
+    codec.encode(board.cells().data(), size, record.data());
+    int decodedSize;
+    bool decoded = codec.decode<TorusTopology>(record.data(), record.size(),
+                                               decodedSize, cells) != 0 ||
+                   BoardCodec::decodeBatch<TorusTopology>(
+                       pool, record.data(), record.size(), decodedSize,
+                       cells) != 0;
+    if (generated || prefetched || decoded ||
+        codec.decode(record.data(), record.size(), decodedSize, cells) == 0) {
+      fmt::print("  a {}x{} torus was accepted\n", size, size);
+      return false;
+    }
+  }
+  return true;
+}
+
+/// @brief Compares the zone values, the openings, the largest opening and the
+/// 3BV of the generated boards with a breadth first search over the
+/// neighbours of each tile.
+template <typename Topology>
+bool openingsMatch() {
+  for (const BoardSettings& settings : kOpeningBoards) {
+    const int size = settings.size;
+    if (size < Topology::kMinSize) {
+      continue;
+    }
+    const int n = size * size;
+    const int empty = static_cast<int>(kEmptyTileValue);
+    const int mine = static_cast<int>(kMineTileValue);
+    BoardGenerator generator(size, settings.mines);
+    std::vector<int> component(n);
+    std::vector<int> componentSize;
+    std::vector<int> queue;
+
+    for (std::uint64_t seed = 1; seed <= kOpeningGames; seed++) {
+      generator.seed(seed);
+      generator.generate<Topology>();
+      const std::vector<int>& tiles = generator.getTiles();
+
+      bool valuesMatch = true;
+      int mines = 0;
+      for (int i = 0; i < n; i++) {
+        int value = 0;
+        Topology::forEachNeighbour(i / size, i % size, size, [&](int r, int c) {
+          value += tiles[r * size + c] == mine;
+        });
+        if (tiles[i] == mine) {
+          mines++;
+        } else {
+          valuesMatch = valuesMatch && tiles[i] == value;
+        }
+      }
+
+      // the openings, numbered in the order of their first tile
+      std::fill(component.begin(), component.end(), -1);
+      componentSize.clear();
+      for (int i = 0; i < n; i++) {
+        if (tiles[i] != empty || component[i] >= 0) {
+          continue;
+        }
+        int id = static_cast<int>(componentSize.size());
+        componentSize.push_back(0);
+        queue.assign(1, i);
+        component[i] = id;
+        for (std::size_t k = 0; k < queue.size(); k++) {
+          componentSize[id]++;
+          int row = queue[k] / size;
+          int col = queue[k] % size;
+          Topology::forEachNeighbour(row, col, size, [&](int r, int c) {
+            int j = r * size + c;
+            if (tiles[j] == empty && component[j] < 0) {
+              component[j] = id;
+              queue.push_back(j);
+            }
+          });
+        }
+      }
+
+      // one click per opening and per numbered tile out of the openings
+      int bbbv = static_cast<int>(componentSize.size());
+      for (int i = 0; i < n; i++) {
+        if (tiles[i] == empty || tiles[i] == mine) {
+          continue;
+        }
+        bool bordersOpening = false;
+        Topology::forEachNeighbour(i / size, i % size, size, [&](int r, int c) {
+          bordersOpening = bordersOpening || tiles[r * size + c] == empty;
+        });
+        bbbv += !bordersOpening;
+      }
+
+      bool labelsMatch = true;
+      for (int i = 0; i < n; i++) {
+        labelsMatch = labelsMatch &&
+                      generator.getOpening(i / size, i % size) == component[i];
+      }
+
+      // the first tile of an opening of the largest size
+      int largest = generator.getLargestOpeningTile();
+      int largestSize = componentSize.empty()
+                            ? 0
+                            : *std::max_element(componentSize.begin(),
+                                                componentSize.end());
+      bool largestMatches =
+          largest < 0
+              ? componentSize.empty()
+              : largest < n && component[largest] >= 0 &&
+                    componentSize[component[largest]] == largestSize &&
+                    std::find(component.begin(), component.end(),
+                              component[largest]) -
+                            component.begin() ==
+                        largest;
+
+      if (!valuesMatch || mines != settings.mines || !labelsMatch ||
+          generator.getOpeningsCount() !=
+              static_cast<int>(componentSize.size()) ||
+          generator.get3BV() != bbbv || !largestMatches) {
+        fmt::print(
+            "  {} {}x{} with {} mines, seed {}: {} openings (expected {}), "
+            "3BV {} (expected {}), largest opening at {}\n",
+            Topology::kName, size, size, settings.mines, seed,
+            generator.getOpeningsCount(), componentSize.size(),
+            generator.get3BV(), bbbv, largest);
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+/// @brief Checks the board generator on the four topologies.
+bool openings() {
+  return openingsMatch<SquareTopology>() && openingsMatch<TorusTopology>() &&
+         openingsMatch<HexTopology>() && openingsMatch<KnightTopology>();
+}
+
+/// @brief Waits until a queue of a prefetcher holds all its boards.
+/// @return false on a timeout.
+bool waitForDepth(const BoardPrefetcher& prefetcher, const PrefetchBoard& b) {
+  auto deadline = std::chrono::steady_clock::now() + kPrefetchTimeout;
+  while (prefetcher.depth(b.size, b.mines, b.topology) <
+         BoardPrefetcher::kDepth) {
+    if (std::chrono::steady_clock::now() > deadline) {
+      fmt::print("  {}x{} {} mines: the queue was not filled\n", b.size,
+                 b.size, b.mines);
+      return false;
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+  return true;
+}
+
+/// @brief Checks that a taken board is a board of the requested settings.
+bool isPrepared(const PreparedBoard& board, const PrefetchBoard& b) {
+  auto n = static_cast<std::size_t>(b.size) * b.size;
+  auto mines = std::count(board.tiles.begin(), board.tiles.end(),
+                          static_cast<int>(kMineTileValue));
+  if (board.size != b.size || board.mines != b.mines ||
+      board.topology != b.topology || board.tiles.size() != n ||
+      mines != b.mines || board.bbbv <= 0) {
+    fmt::print("  {}x{} {} mines: took a {}x{} board of {} mines\n", b.size,
+               b.size, b.mines, board.size, board.size, mines);
+    return false;
+  }
+  return true;
+}
+
+/// @brief Compares the counters of a prefetcher with the takes of the check.
+bool statsMatch(const BoardPrefetcher& prefetcher, std::size_t hits,
+                std::size_t misses, std::size_t queued) {
+  PrefetchStats stats = prefetcher.stats();
+  if (stats.hits != hits || stats.misses != misses || stats.queued != queued ||
+      stats.produced < hits + queued) {
+    fmt::print(
+        "  stats: {} hits, {} misses, {} queued, {} produced; expected {}, "
+        "{}, {}\n",
+        stats.hits, stats.misses, stats.queued, stats.produced, hits, misses,
+        queued);
+    return false;
+  }
+  return true;
+}
+
+/// @brief Checks the hits, the misses and the counters of the prefetcher, and
+/// switches its custom board while the producer fills it: a board taken from
+/// the custom slot must be a board of the current custom board.
+bool prefetcher() {
+  const std::size_t depth = BoardPrefetcher::kDepth;
+  BoardPrefetcher prefetcher;
+  PreparedBoard board;
+  std::size_t hits = 0;
+  std::size_t misses = 0;
+
+  // nothing is wanted yet
+  const PrefetchBoard& beginner = kPrefetchWanted[0];
+  if (prefetcher.take(beginner.size, beginner.mines, beginner.topology,
+                      board) ||
+      !statsMatch(prefetcher, 0, ++misses, 0)) {
+    fmt::print("  took a board which was not wanted\n");
+    return false;
+  }
+
+  // the permanent queues fill up, then the producer sleeps: the stopped
+  // prefetcher serves the ready boards, then misses
+  for (const PrefetchBoard& b : kPrefetchWanted) {
+    prefetcher.want(b.size, b.mines, b.topology);
+  }
+  prefetcher.start();
+  for (const PrefetchBoard& b : kPrefetchWanted) {
+    if (!waitForDepth(prefetcher, b)) {
+      return false;
+    }
+  }
+  prefetcher.stop();
+  const std::size_t wanted = std::size(kPrefetchWanted);
+  if (!statsMatch(prefetcher, 0, misses, wanted * depth) ||
+      prefetcher.stats().produced != wanted * depth) {
+    return false;
+  }
+  for (std::size_t i = 0; i < depth; i++) {
+    if (!prefetcher.take(beginner.size, beginner.mines, beginner.topology,
+                         board) ||
+        !isPrepared(board, beginner)) {
+      fmt::print("  missed a ready board\n");
+      return false;
+    }
+    hits++;
+  }
+  if (prefetcher.take(beginner.size, beginner.mines, beginner.topology,
+                      board)) {
+    fmt::print("  took a board from an empty queue\n");
+    return false;
+  }
+  misses++;
+  if (!statsMatch(prefetcher, hits, misses, (wanted - 1) * depth)) {
+    return false;
+  }
+
+  // the custom board changes while the producer fills it; the previous custom
+  // board must miss unless it has a permanent queue
+  std::mt19937_64 random(1);
+  prefetcher.start();
+  const PrefetchBoard* previous = nullptr;
+  for (int i = 0; i < kPrefetchSwitches; i++) {
+    const PrefetchBoard& custom =
+        kPrefetchCustom[random() % std::size(kPrefetchCustom)];
+    prefetcher.setCustom(custom.size, custom.mines, custom.topology);
+    std::this_thread::sleep_for(std::chrono::microseconds(random() % 2000));
+
+    if (prefetcher.take(custom.size, custom.mines, custom.topology, board)) {
+      if (!isPrepared(board, custom)) {
+        return false;
+      }
+      hits++;
+    } else {
+      misses++;
+    }
+
+    bool dropped = previous != nullptr && previous != &custom &&
+                   previous->size != beginner.size;
+    if (dropped) {
+      if (prefetcher.take(previous->size, previous->mines, previous->topology,
+                          board)) {
+        fmt::print("  took a board of a dropped custom board\n");
+        return false;
+      }
+      misses++;
+    }
+    previous = &custom;
+  }
+
+  // the last custom board fills up as a permanent queue would
+  const PrefetchBoard& last = kPrefetchCustom[0];
+  prefetcher.setCustom(last.size, last.mines, last.topology);
+  for (const PrefetchBoard& b : kPrefetchWanted) {
+    if (!waitForDepth(prefetcher, b)) {
+      return false;
+    }
+  }
+  if (!waitForDepth(prefetcher, last)) {
+    return false;
+  }
+  prefetcher.stop();
+  if (!statsMatch(prefetcher, hits, misses, (wanted + 1) * depth)) {
+    return false;
+  }
+  for (std::size_t i = 0; i < depth; i++) {
+    if (!prefetcher.take(last.size, last.mines, last.topology, board) ||
+        !isPrepared(board, last)) {
+      fmt::print("  missed a ready custom board\n");
+      return false;
+    }
+    hits++;
+  }
+  return statsMatch(prefetcher, hits, misses, wanted * depth);
+}
+
+/// @brief Runs an operation over a warm up pass, then counts its allocations
+/// over a second pass, as a steady state game loop runs it.
+/// @param name The name of the operation, printed if it allocated.
+/// @param passes The number of calls of each pass.
+/// @param op Called with the index of the call in its pass.
+/// @return true if the second pass did not allocate.
+template <typename Op>
+bool checkNoAllocations(const std::string& name, std::size_t passes, Op op) {
+  for (std::size_t i = 0; i < passes; i++) {
+    op(i);
+  }
+
+  std::uint64_t before = allocationsCount();
+  for (std::size_t i = 0; i < passes; i++) {
+    op(i);
+  }
+  std::uint64_t allocations = allocationsCount() - before;
+
+  if (allocations != 0) {
+    fmt::print("  {}: {} allocations in {} calls\n", name, allocations,
+               passes);
+  }
+  return allocations == 0;
+}
+
+/// @brief Checks that the engine paths do not allocate once a game of the
+/// board size was played: the generation, the loading of the tiles, the flood
+/// fill, the solver and the steps of the vectorized environment.
+bool noAllocations() {
+  bool passed = true;
+
+  for (const BoardSettings& settings : kAllocationBoards) {
+    const int size = settings.size;
+    const std::string prefix = fmt::format("{}x{}/", size, size);
+
+    BoardGenerator generator(size, settings.mines);
+    std::vector<std::vector<int>> tiles;
+    std::vector<int> starts;
+    for (std::uint64_t seed = 1; seed <= kAllocationGames; seed++) {
+      generator.seed(seed);
+      generator.generate();
+      tiles.push_back(generator.getTiles());
+      starts.push_back(std::max(generator.getLargestOpeningTile(), 0));
+    }
+
+    Board board;
+    Solver solver;
+
+    passed &= checkNoAllocations(
+        prefix + "generate", kAllocationGames, [&](std::size_t i) {
+          generator.seed(i + 1);
+          generator.generate();
+        });
+
+    passed &= checkNoAllocations(
+        prefix + "set_tiles", kAllocationGames,
+        [&](std::size_t i) { board.setTiles(size, tiles[i]); });
+
+    passed &= checkNoAllocations(
+        prefix + "reveal", kAllocationGames, [&](std::size_t i) {
+          board.setTiles(size, tiles[i]);
+          board.reveal(starts[i] / size, starts[i] % size);
+        });
+
+    passed &= checkNoAllocations(
+        prefix + "solve", kAllocationGames, [&](std::size_t i) {
+          board.setTiles(size, tiles[i]);
+          board.reveal(starts[i] / size, starts[i] % size);
+          solver.solve(board);
+        });
+
+    if (size > kVecEnvMaxSize) {
+      continue;
+    }
+
+    VectorEnv env(kVecEnvBoards, size, settings.mines, 1, kVecEnvThreads);
+    std::vector<std::uint8_t> observations(kVecEnvBoards * env.cellsCount());
+    std::vector<std::uint32_t> revealed(kVecEnvBoards);
+    std::vector<float> rewards(kVecEnvBoards);
+    std::vector<std::uint8_t> dones(kVecEnvBoards);
+
+    // mostly reveals, as a learning agent plays: the games keep ending and
+    // restarting
+    std::mt19937 random(1);
+    std::uniform_int_distribution<std::uint32_t> coord(0, size - 1);
+    std::uniform_int_distribution<std::uint32_t> kind(0, 9);
+    std::vector<EnvAction> actions(kVecEnvBoards * kVecEnvBatches);
+    for (EnvAction& action : actions) {
+      std::uint32_t k = kind(random);
+      action.row = coord(random);
+      action.col = coord(random);
+      action.kind = static_cast<std::uint32_t>(
+          k == 0 ? EnvActionKind::Flag
+                 : (k == 1 ? EnvActionKind::Chord : EnvActionKind::Reveal));
+    }
+
+    passed &= checkNoAllocations(
+        prefix + "vecenv_step", kVecEnvBatches, [&](std::size_t i) {
+          env.step(actions.data() + i * kVecEnvBoards, observations.data(),
+                   revealed.data(), rewards.data(), dones.data());
+        });
+  }
+  return passed;
+}
+
+/// @brief Runs the threads of the game without SDL: the clicks go through the
+/// input queue to a logic thread, which reveals them on an expert board and
+/// publishes the tiles through the triple buffer. Checks that the snapshots
+/// are whole and in order, and prints the latency from a click to the
+/// snapshot showing it, which the game adds its drawing and its vertical
+/// sync to.
+///
+/// The logic thread below mirrors Game::logicLoop() and Game::publishFrame()
+/// rather than running them: Game needs SDL, which the tests do not link, so
+/// the game's own handoff code is only exercised by running the game. The
+/// queue, the triple buffer and InputLatency are the ones the game uses.
+bool frameHandoff() {
+  const int size = 24;
+  const int mines = 99;
+
+  SpscQueue<HandoffInput, 256> inputs;
+  TripleBuffer<HandoffFrame> frames;
+  std::mutex mutex;
+  std::condition_variable ready;
+
+  std::thread logic([&]() {
+    BoardGenerator generator(size, mines);
+    Board board;
+    std::uint64_t seed = 0;
+    auto newGame = [&]() {
+      generator.seed(++seed);
+      generator.generate();
+      board.setTiles(size, generator.getTiles());
+    };
+    newGame();
+
+    for (;;) {
+      {
+        std::unique_lock<std::mutex> lock(mutex);
+        ready.wait(lock, [&inputs]() { return !inputs.empty(); });
+      }
+
+      HandoffInput input;
+      HandoffInput last{};
+      while (inputs.tryPop(input)) {
+        if (input.id == 0) {
+          return;
+        }
+        if (board.reveal(input.row, input.col) == RevealResult::Mine ||
+            board.won()) {
+          newGame();
+        }
+        last = input;
+      }
+
+      HandoffFrame& frame = frames.back();
+      frame.cells = board.cells();
+      frame.revealed = board.revealedCount();
+      frame.inputId = last.id;
+      frame.inputTime = last.time;
+      frames.publish();
+    }
+  });
+
+  auto send = [&](const HandoffInput& input) {
+    while (!inputs.tryPush(input)) {
+      std::this_thread::yield();
+    }
+    { std::lock_guard<std::mutex> lock(mutex); }
+    ready.notify_one();
+  };
+
+  std::mt19937 random(1);
+  std::uniform_int_distribution<int> coord(0, size - 1);
+  InputLatency latency;
+  std::uint64_t presented = 0;
+  bool passed = true;
+
+  for (std::uint64_t id = 1; id <= kHandoffInputs; id++) {
+    send({coord(random), coord(random), id, std::chrono::steady_clock::now()});
+    if (id % kHandoffBurst != 0) {
+      continue;
+    }
+
+    // the frame loop: draw each new snapshot until the burst shows
+    while (presented < id) {
+      if (!frames.acquire()) {
+        std::this_thread::yield();
+        continue;
+      }
+
+      const HandoffFrame& frame = frames.front();
+      std::size_t revealed = 0;
+      for (std::uint8_t cell : frame.cells) {
+        revealed += (cell & kCellRevealed) &&
+                    (cell & kCellValueMask) != kMineTileValue;
+      }
+      if (frame.inputId < presented || revealed != frame.revealed) {
+        fmt::print("  snapshot of input {} after {}: {} revealed of {}\n",
+                   frame.inputId, presented, revealed, frame.revealed);
+        passed = false;
+      }
+      if (frame.inputId > presented) {
+        latency.add(std::chrono::steady_clock::now() - frame.inputTime);
+        presented = frame.inputId;
+      }
+    }
+  }
+
+  send({0, 0, 0, std::chrono::steady_clock::now()});
+  logic.join();
+
+  fmt::print(
+      "  {} snapshots, latency mean {:.3f} ms, 99th percentile {:.3f} ms, "
+      "max {:.3f} ms\n",
+      latency.count(), latency.meanMs(), latency.percentileMs(0.99),
+      latency.maxMs());
+  if (latency.percentileMs(0.99) > latency.maxMs()) {
+    fmt::print("  the percentile is above the longest latency\n");
+    passed = false;
+  }
+  return passed;
+}
+
+/// @brief Checks that a vectorized environment refuses the boards without a
+/// safe tile, where the first reveal could not move its mine away.
+bool vecEnvRejectsFullBoards() {
+  const BoardSettings kInvalid[] = {{3, 9}, {3, 10}, {0, 0}, {3, -1}};
+  for (const BoardSettings& settings : kInvalid) {
+    try {
+      VectorEnv env(1, settings.size, settings.mines, 1, 1);
+      fmt::print("  accepted {} mines on {}x{}\n", settings.mines,
+                 settings.size, settings.size);
+      return false;
+    } catch (const std::invalid_argument&) {
+    }
+  }
+  return true;
+}
+
+/// @brief Checks that the C interface refuses the NULL handles and the NULL
+/// required pointers instead of dereferencing them.
+bool apiRejectsNull() {
+  ms_action action{0, 0, MS_ACTION_REVEAL};
+  ms_board_view view{};
+  view.struct_size = sizeof view;
+  ms_vec_rewards rewards{};
+  rewards.struct_size = sizeof rewards;
+  std::int8_t results[2] = {0, 0};
+
+  ms_board* board = ms_board_create(9, 10, 1);
+  ms_vec_env* env = ms_vec_env_create(1, 9, 10, 1, 1);
+  const bool failures[] = {
+      board == nullptr,
+      env == nullptr,
+      ms_board_new_game(nullptr, 1) != MS_ERROR_INVALID_ARGUMENT,
+      ms_board_apply(nullptr, &action, 1, results) != 0 ||
+          results[0] != MS_RESULT_INVALID,
+      ms_board_apply(board, nullptr, 2, results) != 0 ||
+          results[1] != MS_RESULT_INVALID,
+      ms_board_apply(board, nullptr, 0, nullptr) != 0,
+      ms_board_get_view(nullptr, &view) != MS_ERROR_INVALID_ARGUMENT,
+      ms_board_get_view(board, nullptr) != MS_ERROR_INVALID_ARGUMENT,
+      ms_vec_env_set_rewards(nullptr, &rewards) != MS_ERROR_INVALID_ARGUMENT,
+      ms_vec_env_set_rewards(env, nullptr) != MS_ERROR_INVALID_ARGUMENT,
+      ms_vec_env_reset(nullptr, nullptr) != MS_ERROR_INVALID_ARGUMENT,
+      ms_vec_env_step(nullptr, &action, nullptr, nullptr, nullptr, nullptr) !=
+          MS_ERROR_INVALID_ARGUMENT,
+      ms_vec_env_step(env, nullptr, nullptr, nullptr, nullptr, nullptr) !=
+          MS_ERROR_INVALID_ARGUMENT,
+      ms_board_get_view(board, &view) != MS_OK,
+      ms_vec_env_step(env, &action, nullptr, nullptr, nullptr, nullptr) !=
+          MS_OK,
+  };
+  ms_board_destroy(board);
+  ms_vec_env_destroy(env);
+
+  bool passed = true;
+  for (std::size_t i = 0; i < std::size(failures); i++) {
+    if (failures[i]) {
+      fmt::print("  check {} failed\n", i);
+      passed = false;
+    }
+  }
+  return passed;
+}
+
+const Test kTests[] = {
+    {"pair_table", pairTable},
+    {"pair_chaining", pairChaining},
+    {"montecarlo_sampler", monteCarloSampler},
+    {"montecarlo_deterministic", monteCarloDeterministic},
+    {"montecarlo_rollouts_count", monteCarloRolloutsCount},
+    {"topologies", topologies},
+    {"openings", openings},
+    {"prefetcher", prefetcher},
+    {"bitboards", bitBoards},
+    {"codec_round_trip", codecRoundTrip},
+    {"journal", journal},
+    {"parallel_reveal", parallelReveal},
+    {"corpus", corpus},
+    {"codec_rejects_malformed", codecRejectsMalformed},
+    {"no_allocations", noAllocations},
+    {"generator_bounds", generatorBounds},
+    {"vecenv_rejects_full_boards", vecEnvRejectsFullBoards},
+    {"api_rejects_null", apiRejectsNull},
+    {"frame_handoff", frameHandoff},
+};
+}  // namespace
+
+int main(int argc, char* argv[]) {
+  const std::string filter = argc > 1 ? argv[1] : "";
+
+  int failed = 0;
+  for (const Test& test : kTests) {
+    if (std::string(test.name).find(filter) == std::string::npos) {
+      continue;
+    }
+
+    bool passed = test.run();
+    fmt::print("{} {}\n", passed ? "PASS" : "FAIL", test.name);
+    failed += !passed;
+  }
+
+  if (failed != 0) {
+    fmt::print("{} tests failed\n", failed);
+  }
+  return failed == 0 ? 0 : 1;
+}
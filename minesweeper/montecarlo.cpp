@@ -0,0 +1,745 @@
+// clang-format off
+#include "pch.h"
+#include "board.hpp"
+#include "boardgenerator.hpp"
+#include "solver.hpp"
+#include "threadpool.hpp"
+#include "montecarlo.hpp"
+
+// clang-format on
+
+namespace {
+using Topology = Board::TopologyType;
+
+/// The bits of the outcome of a candidate in a sample.
+const std::uint8_t kOutcomeMine = 1;
+const std::uint8_t kOutcomeWon = 2;
+const std::uint8_t kOutcomePlayed = 4;  //!< A rollout was played.
+
+/// The search for a completion of a partial layout gives up after visiting
+/// this many nodes; the sample is then counted as rejected.
+const std::size_t kMaxSearchNodes = 100000;
+
+/// The bounds of the probability to draw a frontier mine: the proposal must
+/// be able to draw every consistent layout.
+const double kMinMineProposal = 0.05;
+const double kMaxMineProposal = 0.95;
+
+/// @brief Small and fast random generator, cheap to seed for every rollout.
+struct SplitMix64 {
+  using result_type = std::uint64_t;
+
+  std::uint64_t state;
+
+  static constexpr result_type min() { return 0; }
+  static constexpr result_type max() { return ~result_type{0}; }
+
+  result_type operator()() {
+    std::uint64_t z = (state += 0x9E3779B97F4A7C15ull);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    return z ^ (z >> 31);
+  }
+};
+
+/// @brief Derives the seed of a sub stream (a sample, a rollout).
+std::uint64_t mixSeed(std::uint64_t seed, std::uint64_t index) {
+  SplitMix64 rng{seed ^ (index * 0xD1B54A32D192ED03ull)};
+  return rng();
+}
+
+/// The boards of verifyMonteCarloSampler(): beginner boards opened on their
+/// largest opening, small enough to enumerate their layouts.
+const int kCheckSize = 9;
+const int kCheckMines = 10;
+const std::uint64_t kCheckBoards = 8;
+
+/// The samples drawn on each board of the check.
+const std::size_t kCheckSamplesPerRound = 1024;
+const std::size_t kCheckRounds = 16;
+
+/// @brief Returns the binomial coefficient C(n, k).
+double choose(int n, int k) {
+  double c = 1;
+  for (int i = 1; i <= k; i++) {
+    c = c * (n - k + i) / i;
+  }
+  return c;
+}
+
+/// @brief Computes the exact mine probability of every hidden tile of a view
+/// by enumerating the mine layouts of its frontier, each one standing for
+/// C(interior, mines left) boards.
+class ExactEnumeration {
+ public:
+  explicit ExactEnumeration(const Board& view) : _view{view} {
+    int size = view.size();
+    int hiddenMines = view.minesCount();
+    std::vector<int> frontierIndex(view.cellsCount(), -1);
+
+    for (std::size_t i = 0; i < view.cellsCount(); i++) {
+      if (view.isRevealed(i)) {
+        hiddenMines -= view.isMine(i) ? 1 : 0;
+        continue;
+      }
+
+      bool touches = false;
+      Topology::forEachNeighbour(
+          static_cast<int>(i / size), static_cast<int>(i % size), size,
+          [&](int r, int c) {
+            std::size_t j = view.index(r, c);
+            touches = touches || (view.isRevealed(j) && !view.isMine(j));
+          });
+      if (touches) {
+        frontierIndex[i] = static_cast<int>(_frontier.size());
+        _frontier.push_back(i);
+      } else {
+        _interior.push_back(i);
+      }
+    }
+    _hiddenMines = hiddenMines;
+
+    _tileConstraints.resize(_frontier.size());
+    for (std::size_t i = 0; i < view.cellsCount(); i++) {
+      if (!view.isRevealed(i) || view.isMine(i)) {
+        continue;
+      }
+      Constraint constraint{view.zoneValue(i), {}};
+      Topology::forEachNeighbour(
+          static_cast<int>(i / size), static_cast<int>(i % size), size,
+          [&](int r, int c) {
+            std::size_t j = view.index(r, c);
+            if (!view.isRevealed(j)) {
+              constraint.tiles.push_back(frontierIndex[j]);
+            } else if (view.isMine(j)) {
+              constraint.value--;
+            }
+          });
+      for (int t : constraint.tiles) {
+        _tileConstraints[t].push_back(_constraints.size());
+      }
+      _constraints.push_back(constraint);
+    }
+  }
+
+  /// @brief Returns the mine probability of every tile (0 if revealed).
+  std::vector<double> mineProbabilities() {
+    _value.assign(_frontier.size(), 0);
+    _weights.assign(_view.cellsCount(), 0);
+    _total = 0;
+    enumerate(0, 0);
+
+    std::vector<double> probabilities(_view.cellsCount(), 0);
+    if (_total > 0) {
+      for (std::size_t i = 0; i < probabilities.size(); i++) {
+        probabilities[i] = _weights[i] / _total;
+      }
+    }
+    return probabilities;
+  }
+
+ private:
+  struct Constraint {
+    int value;
+    std::vector<int> tiles;
+  };
+
+  /// @brief Returns false if the constraints of a tile cannot be satisfied
+  /// any more.
+  bool feasible(std::size_t t) const {
+    for (std::size_t c : _tileConstraints[t]) {
+      int mines = 0;
+      int unassigned = 0;
+      for (int u : _constraints[c].tiles) {
+        if (static_cast<std::size_t>(u) > t) {
+          unassigned++;
+        } else {
+          mines += _value[u];
+        }
+      }
+      if (mines > _constraints[c].value ||
+          mines + unassigned < _constraints[c].value) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  void enumerate(std::size_t t, int mines) {
+    if (t == _frontier.size()) {
+      int left = _hiddenMines - mines;
+      int interior = static_cast<int>(_interior.size());
+      if (left < 0 || left > interior) {
+        return;
+      }
+      double boards = choose(interior, left);
+      _total += boards;
+      for (std::size_t u = 0; u < _frontier.size(); u++) {
+        if (_value[u]) {
+          _weights[_frontier[u]] += boards;
+        }
+      }
+      for (std::size_t i : _interior) {
+        _weights[i] += boards * left / interior;
+      }
+      return;
+    }
+
+    for (int v = 0; v <= 1; v++) {
+      _value[t] = v;
+      if (feasible(t)) {
+        enumerate(t + 1, mines + v);
+      }
+    }
+    _value[t] = 0;
+  }
+
+ private:
+  const Board& _view;
+  std::vector<std::size_t> _frontier;
+  std::vector<std::size_t> _interior;
+  std::vector<Constraint> _constraints;
+  std::vector<std::vector<std::size_t>> _tileConstraints;
+  int _hiddenMines{0};
+
+  std::vector<int> _value;       //!< The mines of the frontier tiles.
+  std::vector<double> _weights;  //!< The boards with a mine on each tile.
+  double _total{0};              //!< The consistent boards.
+};
+
+/// @brief Returns a uniform number in [0, 1).
+double uniform(SplitMix64& rng) {
+  return static_cast<double>(rng() >> 11) * (1.0 / 9007199254740992.0);
+}
+}  // namespace
+
+/// @brief A revealed number: the count of mines among its frontier tiles.
+struct MonteCarloEngine::Constraint {
+  int value;          //!< The mines left to place.
+  std::size_t first;  //!< The first tile in _constraintTiles.
+  std::size_t count;  //!< The number of tiles.
+};
+
+/// @brief The scratch data of a worker thread, reused across the searches.
+struct MonteCarloEngine::Worker {
+  Board base;  //!< The sampled layout with the view revealed.
+  Board sim;   //!< The board of the running rollout.
+  Solver solver;
+
+  // the state of the draw, per frontier tile
+  std::vector<signed char> value;  //!< -1: unassigned, 0: safe, 1: mine.
+  std::vector<unsigned char> tried;
+
+  // the state of the draw, per constraint
+  std::vector<int> mines;
+  std::vector<int> unassigned;
+
+  std::vector<std::size_t> interior;  //!< Shuffled interior tiles.
+  std::vector<std::size_t> layout;    //!< The sampled mines.
+  std::vector<std::uint8_t> isMine;   //!< Per tile, set for the layout.
+  std::vector<std::size_t> hidden;    //!< The tiles a rollout may guess.
+};
+
+MonteCarloEngine::MonteCarloEngine(ThreadPool& pool) : _pool{pool} {}
+
+MonteCarloEngine::~MonteCarloEngine() {}
+
+MonteCarloResult MonteCarloEngine::bestGuess(const Board& view,
+                                             const MonteCarloOptions& options) {
+  auto start = std::chrono::steady_clock::now();
+
+  MonteCarloResult result;
+  result.threads = _pool.size();
+
+  prepare(view);
+  if (_candidates.empty()) {
+    return result;
+  }
+
+  while (_workers.size() < _pool.size()) {
+    _workers.emplace_back(std::make_unique<Worker>());
+  }
+
+  for (auto& worker : _workers) {
+    worker->base = Board(_size, _minesCount);
+    worker->isMine.assign(view.cellsCount(), 0);
+  }
+
+  const std::size_t samplesPerRound = std::max<std::size_t>(
+      1, options.samplesPerRound);
+  const std::size_t candidatesCount = _candidates.size();
+
+  _logWeights.resize(samplesPerRound);
+  _outcomes.resize(samplesPerRound * candidatesCount);
+  _logScale = -std::numeric_limits<double>::infinity();
+  _weightSum = 0;
+  _weightSquaresSum = 0;
+  _weightedWins.assign(candidatesCount, 0);
+  _weightedMines.assign(candidatesCount, 0);
+  _rollouts.assign(candidatesCount, 0);
+
+  for (std::size_t round = 0;; round++) {
+    if (options.maxRounds != 0 && round >= options.maxRounds) {
+      break;
+    }
+    if (round > 0 && std::chrono::steady_clock::now() - start >=
+                         options.timeBudget) {
+      break;
+    }
+
+    _pool.parallelFor(samplesPerRound, [&](std::size_t i, std::size_t w) {
+      Worker& worker = *_workers[w];
+      std::uint8_t* outcomes = &_outcomes[i * candidatesCount];
+
+      std::uint64_t sampleSeed =
+          mixSeed(options.seed, round * samplesPerRound + i);
+      if (!sample(worker, sampleSeed, _logWeights[i])) {
+        _logWeights[i] = -std::numeric_limits<double>::infinity();
+        return;
+      }
+
+      for (std::size_t j : worker.layout) {
+        worker.isMine[j] = 1;
+      }
+      if (options.playRollouts) {
+        setUpBoard(worker);
+      }
+
+      for (std::size_t k = 0; k < candidatesCount; k++) {
+        std::uint8_t outcome = 0;
+        if (worker.isMine[_candidates[k]]) {
+          outcome = kOutcomeMine;
+        } else if (options.playRollouts) {
+          outcome = kOutcomePlayed;
+          if (rollout(worker, _candidates[k], mixSeed(sampleSeed, k + 1))) {
+            outcome |= kOutcomeWon;
+          }
+        }
+        outcomes[k] = outcome;
+      }
+
+      for (std::size_t j : worker.layout) {
+        worker.isMine[j] = 0;
+      }
+    });
+
+    accumulate(samplesPerRound, result);
+    result.rounds++;
+  }
+
+  result.estimates.reserve(candidatesCount);
+  for (std::size_t k = 0; k < candidatesCount; k++) {
+    GuessEstimate estimate{
+        Position{_candidates[k] / _size, _candidates[k] % _size}, 0, 0,
+        _rollouts[k]};
+    if (_weightSum > 0) {
+      estimate.winProbability = _weightedWins[k] / _weightSum;
+      estimate.mineProbability = _weightedMines[k] / _weightSum;
+    }
+    result.estimates.push_back(estimate);
+  }
+
+  if (_weightSquaresSum > 0) {
+    result.effectiveSamples = _weightSum * _weightSum / _weightSquaresSum;
+  }
+
+  // the ties keep the board order to stay deterministic
+  std::stable_sort(result.estimates.begin(), result.estimates.end(),
+                   [](const GuessEstimate& a, const GuessEstimate& b) {
+                     return a.winProbability > b.winProbability;
+                   });
+
+  result.elapsed = std::chrono::steady_clock::now() - start;
+  return result;
+}
+
+void MonteCarloEngine::accumulate(std::size_t samples,
+                                  MonteCarloResult& result) {
+  const std::size_t candidatesCount = _candidates.size();
+
+  for (std::size_t i = 0; i < samples; i++) {
+    double logWeight = _logWeights[i];
+    if (logWeight == -std::numeric_limits<double>::infinity()) {
+      result.rejectedSamples++;
+      continue;
+    }
+
+    // the sums are kept relative to the heaviest sample so far
+    if (logWeight > _logScale) {
+      double factor = std::exp(_logScale - logWeight);
+      _weightSum *= factor;
+      _weightSquaresSum *= factor * factor;
+      for (std::size_t k = 0; k < candidatesCount; k++) {
+        _weightedWins[k] *= factor;
+        _weightedMines[k] *= factor;
+      }
+      _logScale = logWeight;
+    }
+
+    double weight = std::exp(logWeight - _logScale);
+    _weightSum += weight;
+    _weightSquaresSum += weight * weight;
+
+    // a candidate which is a mine in the sample plays no rollout
+    const std::uint8_t* outcomes = &_outcomes[i * candidatesCount];
+    for (std::size_t k = 0; k < candidatesCount; k++) {
+      if (outcomes[k] & kOutcomePlayed) {
+        _rollouts[k]++;
+        result.rollouts++;
+      }
+      if (outcomes[k] & kOutcomeWon) {
+        _weightedWins[k] += weight;
+      } else if (outcomes[k] & kOutcomeMine) {
+        _weightedMines[k] += weight;
+      }
+    }
+  }
+}
+
+void MonteCarloEngine::prepare(const Board& view) {
+  _size = view.size();
+  _minesCount = view.minesCount();
+  _frontier.clear();
+  _interior.clear();
+  _candidates.clear();
+  _revealed.clear();
+  _knownMines.clear();
+  _constraints.clear();
+  _constraintTiles.clear();
+  _frontierIndex.assign(view.cellsCount(), -1);
+
+  // the revealed mines (if the game is lost) are known, the others are hidden
+  _hiddenMines = _minesCount;
+
+  auto touchesNumber = [this, &view](int row, int col) {
+    bool touches = false;
+    Topology::forEachNeighbour(row, col, _size, [&](int r, int c) {
+      std::size_t j = view.index(r, c);
+      if (view.isRevealed(j) && !view.isMine(j)) {
+        touches = true;
+      }
+    });
+    return touches;
+  };
+
+  for (int row = 0; row < _size; row++) {
+    for (int col = 0; col < _size; col++) {
+      std::size_t i = view.index(row, col);
+      if (view.isRevealed(i)) {
+        if (view.isMine(i)) {
+          _knownMines.push_back(i);
+          _hiddenMines--;
+        } else {
+          _revealed.push_back(i);
+        }
+        continue;
+      }
+
+      if (!view.isFlagged(i)) {
+        _candidates.push_back(i);
+      }
+
+      if (touchesNumber(row, col)) {
+        _frontierIndex[i] = static_cast<int>(_frontier.size());
+        _frontier.push_back(i);
+      } else {
+        _interior.push_back(i);
+      }
+    }
+  }
+
+  for (std::size_t i : _revealed) {
+    int row = static_cast<int>(i / _size);
+    int col = static_cast<int>(i % _size);
+
+    Constraint constraint{view.zoneValue(i), _constraintTiles.size(), 0};
+    Topology::forEachNeighbour(row, col, _size, [&](int r, int c) {
+      std::size_t j = view.index(r, c);
+      if (!view.isRevealed(j)) {
+        _constraintTiles.push_back(_frontierIndex[j]);
+        constraint.count++;
+      } else if (view.isMine(j)) {
+        constraint.value--;
+      }
+    });
+
+    if (constraint.count > 0) {
+      _constraints.push_back(constraint);
+    }
+  }
+
+  // invert the lists: the constraints of each frontier tile
+  _tileOffsets.assign(_frontier.size() + 1, 0);
+  for (std::size_t t : _constraintTiles) {
+    _tileOffsets[t + 1]++;
+  }
+  for (std::size_t t = 0; t < _frontier.size(); t++) {
+    _tileOffsets[t + 1] += _tileOffsets[t];
+  }
+
+  _tileConstraints.resize(_constraintTiles.size());
+  _tileFill.assign(_tileOffsets.begin(), _tileOffsets.end() - 1);
+  for (std::size_t c = 0; c < _constraints.size(); c++) {
+    const Constraint& constraint = _constraints[c];
+    for (std::size_t k = 0; k < constraint.count; k++) {
+      std::size_t t = _constraintTiles[constraint.first + k];
+      _tileConstraints[_tileFill[t]++] = c;
+    }
+  }
+
+  // the interior draws its mines uniformly: C(interior, k) boards for each
+  // number k of mines left to it
+  const std::size_t interior = _interior.size();
+  _logChoose.resize(interior + 1);
+  for (std::size_t k = 0; k <= interior; k++) {
+    _logChoose[k] = std::lgamma(interior + 1.0) - std::lgamma(k + 1.0) -
+                    std::lgamma(interior - k + 1.0);
+  }
+
+  // the frontier draws its mines with the density of the hidden mines
+  std::size_t hiddenCount = _frontier.size() + interior;
+  _mineProposal =
+      hiddenCount == 0 ? 0.5
+                       : static_cast<double>(_hiddenMines) / hiddenCount;
+  _mineProposal =
+      std::min(std::max(_mineProposal, kMinMineProposal), kMaxMineProposal);
+}
+
+bool MonteCarloEngine::sample(Worker& worker, std::uint64_t seed,
+                              double& logWeight) {
+  SplitMix64 rng{seed};
+
+  const std::size_t n = _frontier.size();
+  const int interior = static_cast<int>(_interior.size());
+
+  worker.value.assign(n, -1);
+  worker.tried.assign(n, 0);
+  worker.mines.assign(_constraints.size(), 0);
+  worker.unassigned.resize(_constraints.size());
+  for (std::size_t c = 0; c < _constraints.size(); c++) {
+    worker.unassigned[c] = static_cast<int>(_constraints[c].count);
+  }
+  worker.layout.clear();
+
+  int frontierMines = 0;
+
+  // whether a value of tile t keeps the numbers and the number of mines
+  // satisfiable, the tiles being assigned in order
+  auto canAssign = [&](std::size_t t, int v) {
+    int mines = frontierMines + v;
+    int unassigned = static_cast<int>(n - t - 1);
+    if (mines > _hiddenMines || mines + unassigned + interior < _hiddenMines) {
+      return false;
+    }
+    for (std::size_t k = _tileOffsets[t]; k < _tileOffsets[t + 1]; k++) {
+      std::size_t c = _tileConstraints[k];
+      int constraintMines = worker.mines[c] + v;
+      int constraintUnassigned = worker.unassigned[c] - 1;
+      if (constraintMines > _constraints[c].value ||
+          constraintMines + constraintUnassigned < _constraints[c].value) {
+        return false;
+      }
+    }
+    return true;
+  };
+
+  auto assign = [&](std::size_t t, int v) {
+    worker.value[t] = static_cast<signed char>(v);
+    frontierMines += v;
+    for (std::size_t k = _tileOffsets[t]; k < _tileOffsets[t + 1]; k++) {
+      worker.mines[_tileConstraints[k]] += v;
+      worker.unassigned[_tileConstraints[k]]--;
+    }
+  };
+
+  auto unassign = [&](std::size_t t) {
+    int v = worker.value[t];
+    worker.value[t] = -1;
+    frontierMines -= v;
+    for (std::size_t k = _tileOffsets[t]; k < _tileOffsets[t + 1]; k++) {
+      worker.mines[_tileConstraints[k]] -= v;
+      worker.unassigned[_tileConstraints[k]]++;
+    }
+  };
+
+  // whether tile t can take a value and the tiles after it be completed into
+  // a consistent layout: a depth first search, undone before returning;
+  // -1 if it gave up
+  auto extends = [&](std::size_t t, int v) {
+    if (!canAssign(t, v)) {
+      return 0;
+    }
+    assign(t, v);
+
+    int found = 0;
+    std::size_t d = t + 1;
+    for (std::size_t nodes = 0;; nodes++) {
+      if (d == n) {
+        found = 1;
+        break;
+      }
+      if (nodes == kMaxSearchNodes) {
+        found = -1;
+        break;
+      }
+      if (worker.value[d] >= 0) {
+        unassign(d);
+      }
+      if (worker.tried[d] == 2) {
+        worker.tried[d] = 0;
+        if (--d == t) {
+          break;
+        }
+        continue;
+      }
+      int value = worker.tried[d]++;
+      if (canAssign(d, value)) {
+        assign(d, value);
+        d++;
+      }
+    }
+
+    for (std::size_t u = t; u < n; u++) {
+      if (worker.value[u] >= 0) {
+        unassign(u);
+      }
+      worker.tried[u] = 0;
+    }
+    return found;
+  };
+
+  // the frontier tiles in order: a tile which can be both is a mine with the
+  // proposal probability, a forced tile takes its only value; as every value
+  // drawn extends to a consistent layout, the draw never runs into a
+  // contradiction
+  const double logMine = std::log(_mineProposal);
+  const double logSafe = std::log(1.0 - _mineProposal);
+  double logProposal = 0;
+
+  for (std::size_t t = 0; t < n; t++) {
+    int safe = extends(t, 0);
+    int mine = extends(t, 1);
+    if (safe < 0 || mine < 0 || (safe == 0 && mine == 0)) {
+      return false;
+    }
+
+    int v = mine;
+    if (safe && mine) {
+      v = uniform(rng) < _mineProposal ? 1 : 0;
+      logProposal += v ? logMine : logSafe;
+    }
+
+    assign(t, v);
+    if (v) {
+      worker.layout.push_back(_frontier[t]);
+    }
+  }
+
+  int left = _hiddenMines - frontierMines;
+  if (left < 0 || left > interior) {
+    return false;
+  }
+  logWeight = _logChoose[left] - logProposal;
+
+  // the remaining mines go uniformly to the interior tiles
+  worker.interior.assign(_interior.begin(), _interior.end());
+  for (std::size_t k = 0; k < static_cast<std::size_t>(left); k++) {
+    std::size_t j = k + rng() % (worker.interior.size() - k);
+    std::swap(worker.interior[k], worker.interior[j]);
+    worker.layout.push_back(worker.interior[k]);
+  }
+
+  return true;
+}
+
+void MonteCarloEngine::setUpBoard(Worker& worker) {
+  // the mines revealed in the view are part of the layout as well; they are
+  // flagged so that the rollouts never guess them
+  worker.layout.insert(worker.layout.end(), _knownMines.begin(),
+                       _knownMines.end());
+
+  worker.base.setMines(worker.layout);
+  for (std::size_t i : _revealed) {
+    worker.base.reveal(static_cast<int>(i / _size),
+                       static_cast<int>(i % _size));
+  }
+  for (std::size_t i : _knownMines) {
+    worker.base.toggleFlag(static_cast<int>(i / _size),
+                           static_cast<int>(i % _size));
+  }
+}
+
+bool MonteCarloEngine::rollout(Worker& worker, std::size_t candidate,
+                               std::uint64_t seed) {
+  SplitMix64 rng{seed};
+
+  Board& sim = worker.sim;
+  sim = worker.base;
+
+  std::size_t i = candidate;
+  for (;;) {
+    if (sim.reveal(static_cast<int>(i / _size), static_cast<int>(i % _size)) ==
+        RevealResult::Mine) {
+      return false;
+    }
+
+    switch (worker.solver.solve(sim)) {
+      case Solver::Status::Won:
+        return true;
+      case Solver::Status::Lost:
+        return false;
+      default:
+        break;
+    }
+
+    // stuck: guess at random
+    worker.hidden.clear();
+    for (std::size_t j = 0; j < sim.cellsCount(); j++) {
+      if (!sim.isRevealed(j) && !sim.isFlagged(j)) {
+        worker.hidden.push_back(j);
+      }
+    }
+    if (worker.hidden.empty()) {
+      return sim.won();
+    }
+    i = worker.hidden[rng() % worker.hidden.size()];
+  }
+}
+
+double verifyMonteCarloSampler(ThreadPool& pool) {
+  BoardGenerator generator(kCheckSize, kCheckMines);
+  MonteCarloEngine engine(pool);
+
+  MonteCarloOptions options;
+  options.seed = 1;
+  options.timeBudget = std::chrono::hours(1);
+  options.samplesPerRound = kCheckSamplesPerRound;
+  options.maxRounds = kCheckRounds;
+  options.playRollouts = false;
+
+  double worst = 0;
+  for (std::uint64_t seed = 1; seed <= kCheckBoards; seed++) {
+    generator.seed(seed);
+    generator.generate();
+    int start = generator.getLargestOpeningTile();
+    if (start < 0) {
+      continue;
+    }
+
+    Board view(kCheckSize, kCheckMines);
+    view.setTiles(kCheckSize, generator.getTiles());
+    view.reveal(start / kCheckSize, start % kCheckSize);
+    if (view.won()) {
+      continue;
+    }
+
+    std::vector<double> exact = ExactEnumeration(view).mineProbabilities();
+    MonteCarloResult result = engine.bestGuess(view, options);
+    for (const GuessEstimate& estimate : result.estimates) {
+      std::size_t i = view.index(static_cast<int>(estimate.position.row),
+                                 static_cast<int>(estimate.position.col));
+      worst = std::max(worst, std::abs(estimate.mineProbability - exact[i]));
+    }
+  }
+  return worst;
+}
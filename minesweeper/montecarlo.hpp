@@ -0,0 +1,159 @@
+#pragma once
+
+#include "board.hpp"
+#include "structs.hpp"
+
+class ThreadPool;
+
+/// @brief The settings of a Monte Carlo search.
+struct MonteCarloOptions {
+  std::uint64_t seed{0};  //!< Same seed and rounds give the same result.
+  std::chrono::milliseconds timeBudget{100};  //!< Checked between rounds.
+  std::size_t samplesPerRound{32};  //!< Sampled mine layouts per round.
+  std::size_t maxRounds{0};         //!< 0: run until the budget is spent.
+  bool playRollouts{true};  //!< false: only estimate the mine probabilities.
+};
+
+/// @brief The estimated outcome of clicking a tile.
+struct GuessEstimate {
+  Position position;       //!< The tile.
+  double winProbability;   //!< The weighted fraction of the rollouts won.
+  double mineProbability;  //!< The weighted fraction of the layouts with a
+                           //!< mine on the tile.
+  std::size_t rollouts;    //!< The rollouts played from the tile: one per
+                           //!< sample in which it holds no mine.
+};
+
+/// @brief The outcome of a Monte Carlo search.
+struct MonteCarloResult {
+  std::vector<GuessEstimate> estimates;  //!< Best guess first.
+  std::size_t rounds{0};                 //!< The completed rounds.
+  std::size_t rollouts{0};               //!< The played rollouts; a
+                                         //!< candidate which is a mine in a
+                                         //!< sample plays none.
+  std::size_t rejectedSamples{0};  //!< Samples which found no layout.
+  double effectiveSamples{0};      //!< The number of unweighted samples
+                                   //!< worth the weighted ones.
+  std::size_t threads{0};          //!< The workers used.
+  std::chrono::duration<double> elapsed{0};
+
+  /// @brief Returns the throughput in rollouts per second per core.
+  double rolloutsPerSecondPerCore() const {
+    double seconds = elapsed.count();
+    return seconds <= 0.0 || threads == 0 ? 0.0
+                                          : rollouts / seconds / threads;
+  }
+};
+
+/// @brief Ranks the hidden tiles of a board by their estimated probability
+/// of winning the game when clicked next.
+///
+/// Each round samples mine layouts consistent with the revealed tiles and the
+/// number of mines. For every sampled layout and every candidate tile a
+/// rollout clicks the tile and then plays with the Solver, guessing at random
+/// whenever it gets stuck. The layouts and the rollouts use random streams
+/// derived from the seed and their indices only, and the outcomes are summed
+/// in the order of the samples, so the result does not depend on the number
+/// of threads or on the scheduling.
+///
+/// The layouts are drawn by importance sampling: the frontier tiles (the
+/// hidden tiles touching a revealed number) are assigned one after the other,
+/// each one a mine with a fixed probability if both of its values extend to a
+/// consistent layout (a depth first search checks it) and its only value
+/// otherwise; the remaining mines go uniformly to the interior tiles. A layout
+/// is weighted by the number of full boards it stands for, C(interior, mines
+/// left), over the probability of drawing its frontier. The weighted outcomes
+/// then estimate the probabilities over the uniformly distributed consistent
+/// boards.
+class MonteCarloEngine {
+ public:
+  /// @brief The constructor.
+  /// @param pool The workers running the rollouts.
+  explicit MonteCarloEngine(ThreadPool& pool);
+  ~MonteCarloEngine();
+
+  MonteCarloEngine(const MonteCarloEngine&) = delete;
+  MonteCarloEngine& operator=(const MonteCarloEngine&) = delete;
+
+  /// @brief Searches the best guess. The board is only read through what the
+  /// player sees (revealed tiles); flags are treated as hidden tiles.
+  /// @param view The current board.
+  /// @param options The search settings.
+  /// @return The candidate tiles, the most promising first.
+  MonteCarloResult bestGuess(const Board& view,
+                             const MonteCarloOptions& options);
+
+ private:
+  struct Constraint;
+  struct Worker;
+
+  /// @brief Collects the hidden tiles and the constraints of the view.
+  void prepare(const Board& view);
+
+  /// @brief Samples one mine layout consistent with the view.
+  /// @param logWeight Receives the logarithm of the weight of the layout.
+  /// @return false if the view has no consistent layout or if a search gave
+  /// up.
+  bool sample(Worker& worker, std::uint64_t seed, double& logWeight);
+
+  /// @brief Sets the worker's base board up for the rollouts: the sampled
+  /// layout with the tiles of the view revealed.
+  void setUpBoard(Worker& worker);
+
+  /// @brief Adds the outcomes of the samples of a round, in sample order.
+  void accumulate(std::size_t samples, MonteCarloResult& result);
+
+  /// @brief Plays one game on the worker's sampled board, starting with a
+  /// click on the given tile.
+  /// @return true if the game is won.
+  bool rollout(Worker& worker, std::size_t candidate, std::uint64_t seed);
+
+ private:
+  ThreadPool& _pool;
+  std::vector<std::unique_ptr<Worker>> _workers;  //!< Per worker scratch.
+
+  // the hidden tiles
+  std::vector<std::size_t> _frontier;    //!< Touching a revealed number.
+  std::vector<std::size_t> _interior;    //!< Not touching any number.
+  std::vector<std::size_t> _candidates;  //!< Not flagged.
+  std::vector<std::size_t> _revealed;    //!< The revealed tiles.
+  std::vector<std::size_t> _knownMines;  //!< The revealed mines.
+  std::vector<int> _frontierIndex;  //!< Per tile, its index in _frontier.
+
+  // the constraints, with the frontier tiles they cover and, for each
+  // frontier tile, the constraints covering it (compressed lists)
+  std::vector<Constraint> _constraints;
+  std::vector<std::size_t> _constraintTiles;
+  std::vector<std::size_t> _tileOffsets;
+  std::vector<std::size_t> _tileConstraints;
+  std::vector<std::size_t> _tileFill;
+
+  double _mineProposal{0.5};  //!< The probability to draw a frontier mine.
+  std::vector<double> _logChoose;  //!< log C(interior, k) for each k.
+
+  // the outcomes of the samples of a round: the log weight (-inf: rejected),
+  // then for each candidate kOutcomeMine, kOutcomeWon and kOutcomePlayed bits
+  std::vector<double> _logWeights;
+  std::vector<std::uint8_t> _outcomes;
+
+  // the weighted sums of the outcomes, scaled by exp(-_logScale)
+  double _logScale{0};
+  double _weightSum{0};
+  double _weightSquaresSum{0};
+  std::vector<double> _weightedWins;
+  std::vector<double> _weightedMines;
+
+  std::vector<std::size_t> _rollouts;  //!< The rollouts played from each
+                                       //!< candidate.
+
+  int _size{0};
+  int _minesCount{0};
+  int _hiddenMines{0};  //!< The mines which are not revealed.
+};
+
+/// @brief Checks the sampler on small boards: the mine probabilities it
+/// estimates are compared with the exact ones, enumerated over all the mine
+/// layouts consistent with the revealed tiles.
+/// @param pool The workers.
+/// @return The largest absolute error over the hidden tiles.
+double verifyMonteCarloSampler(ThreadPool& pool);
@@ -0,0 +1,139 @@
+// clang-format off
+#include "pch.h"
+#include "board.hpp"
+#include "threadpool.hpp"
+#include "parallelreveal.hpp"
+
+// clang-format on
+
+template <typename Topology>
+RevealResult ParallelReveal::reveal(ThreadPool& pool,
+                                    BasicBoard<Topology>& board, int row,
+                                    int col) {
+  _rounds = 0;
+  std::size_t start = board.index(row, col);
+  std::vector<std::uint8_t>& cells = board._cells;
+  if (cells[start] & (kCellRevealed | kCellFlagged)) {
+    return RevealResult::None;
+  }
+
+  JournalScope action(board._journal);
+  if (board.isMine(start)) {
+    board.setCell(start, static_cast<std::uint8_t>(cells[start] |
+                                                   kCellRevealed));
+    return RevealResult::Mine;
+  }
+
+  const int size = board.size();
+  _blocksPerRow = (size + _blockSize - 1) / _blockSize;
+  _inboxes.resize(static_cast<std::size_t>(_blocksPerRow) * _blocksPerRow);
+  _workers.resize(pool.size());
+  bool journal = board._journal != nullptr;
+
+  std::size_t first = blockOf(start, size);
+  _inboxes[first].push_back(start);
+  _active.assign(1, first);
+
+  while (!_active.empty()) {
+    _rounds++;
+    pool.parallelFor(_active.size(), [&](std::size_t i, std::size_t worker) {
+      floodBlock(board, _active[i], _workers[worker], journal);
+    });
+
+    // hand the seeds to their blocks; the tiles revealed meanwhile (by their
+    // block, or by an earlier seed) are dropped here, where no worker writes
+    _active.clear();
+    for (Worker& worker : _workers) {
+      for (std::size_t j : worker.outbox) {
+        if (cells[j] & (kCellRevealed | kCellFlagged)) {
+          continue;
+        }
+        std::vector<std::size_t>& inbox = _inboxes[blockOf(j, size)];
+        if (inbox.empty()) {
+          _active.push_back(blockOf(j, size));
+        }
+        inbox.push_back(j);
+      }
+      worker.outbox.clear();
+    }
+  }
+
+  // merge the counts and the changes of the workers
+  for (Worker& worker : _workers) {
+    board._revealedCount += worker.revealedCount;
+    worker.revealedCount = 0;
+    for (std::size_t i : worker.revealed) {
+      board._journal->record(
+          i, static_cast<std::uint8_t>(cells[i] & ~kCellRevealed), cells[i]);
+    }
+    worker.revealed.clear();
+  }
+
+  return RevealResult::Revealed;
+}
+
+template <typename Topology>
+void ParallelReveal::floodBlock(BasicBoard<Topology>& board, std::size_t block,
+                                Worker& worker, bool journal) {
+  std::vector<std::uint8_t>& cells = board._cells;
+  const int size = board.size();
+  const int top = static_cast<int>(block / _blocksPerRow) * _blockSize;
+  const int left = static_cast<int>(block % _blocksPerRow) * _blockSize;
+  const int bottom = std::min(top + _blockSize, size);
+  const int right = std::min(left + _blockSize, size);
+
+  std::size_t revealed = 0;
+  auto revealCell = [&](std::size_t j) {
+    cells[j] = static_cast<std::uint8_t>(cells[j] | kCellRevealed);
+    revealed++;
+    if (journal) {
+      worker.revealed.push_back(j);
+    }
+    worker.stack.push_back(j);
+  };
+
+  // the seeds may repeat: several blocks can hand over the same tile
+  std::vector<std::size_t>& inbox = _inboxes[block];
+  for (std::size_t j : inbox) {
+    if (!(cells[j] & (kCellRevealed | kCellFlagged))) {
+      revealCell(j);
+    }
+  }
+  inbox.clear();
+
+  while (!worker.stack.empty()) {
+    std::size_t i = worker.stack.back();
+    worker.stack.pop_back();
+
+    if ((cells[i] & kCellValueMask) != 0) {
+      continue;
+    }
+
+    int row = static_cast<int>(i / size);
+    int col = static_cast<int>(i % size);
+
+    Topology::forEachNeighbour(row, col, size, [&](int r, int c) {
+      std::size_t j = static_cast<std::size_t>(r) * size + c;
+      if (r < top || r >= bottom || c < left || c >= right) {
+        worker.outbox.push_back(j);
+      } else if (!(cells[j] & (kCellRevealed | kCellFlagged))) {
+        revealCell(j);
+      }
+    });
+  }
+
+  worker.revealedCount += revealed;
+}
+
+template RevealResult ParallelReveal::reveal(ThreadPool&,
+                                             BasicBoard<SquareTopology>&, int,
+                                             int);
+template RevealResult ParallelReveal::reveal(ThreadPool&,
+                                             BasicBoard<TorusTopology>&, int,
+                                             int);
+template RevealResult ParallelReveal::reveal(ThreadPool&,
+                                             BasicBoard<HexTopology>&, int,
+                                             int);
+template RevealResult ParallelReveal::reveal(ThreadPool&,
+                                             BasicBoard<KnightTopology>&, int,
+                                             int);
@@ -0,0 +1,78 @@
+#pragma once
+
+#include "board.hpp"
+
+class ThreadPool;
+
+/// @brief Reveals the regions of very large boards with all the workers of a
+/// thread pool.
+///
+/// The board is split into square blocks. The reveal runs in rounds: in a
+/// round, each block which received seeds floods its own tiles on one worker
+/// and hands the neighbours lying in other blocks to them as the seeds of the
+/// next round. A worker only writes the tiles of its block, so the blocks need
+/// no locking; the seeds are exchanged between the rounds, where the tiles
+/// revealed meanwhile are dropped. The rounds stop when no seed is left.
+///
+/// The revealed tiles and the revealed count are the ones of
+/// BasicBoard::reveal(). With a journal attached, the reveal is recorded as one
+/// action whose changes are merged from the blocks (in block order rather than
+/// in flood order). The object keeps its scratch lists, so it does not allocate
+/// once it has seen the largest reveal.
+class ParallelReveal {
+ public:
+  /// The default dimension of the blocks.
+  static constexpr int kDefaultBlockSize = 256;
+
+  /// @brief The constructor.
+  /// @param blockSize The dimension of the blocks.
+  explicit ParallelReveal(int blockSize = kDefaultBlockSize)
+      : _blockSize{std::max(blockSize, 1)} {}
+
+  ParallelReveal(const ParallelReveal&) = delete;
+  ParallelReveal& operator=(const ParallelReveal&) = delete;
+
+  /// @brief Reveals a tile; if the tile is empty then all the touching tiles
+  /// are revealed as well, like BasicBoard::reveal().
+  /// @param pool The workers.
+  /// @param board The board.
+  /// @param row The row.
+  /// @param col The column.
+  /// @return The outcome of the reveal.
+  template <typename Topology>
+  RevealResult reveal(ThreadPool& pool, BasicBoard<Topology>& board, int row,
+                      int col);
+
+  /// @brief Returns the number of rounds of the last reveal.
+  std::size_t rounds() const { return _rounds; }
+
+ private:
+  /// @brief The scratch data of a worker.
+  struct Worker {
+    std::vector<std::size_t> stack;     //!< The flood fill work list.
+    std::vector<std::size_t> outbox;    //!< The seeds of the other blocks.
+    std::vector<std::size_t> revealed;  //!< The revealed tiles (journal).
+    std::size_t revealedCount{0};
+  };
+
+  /// @brief Floods a block from its seeds.
+  template <typename Topology>
+  void floodBlock(BasicBoard<Topology>& board, std::size_t block,
+                  Worker& worker, bool journal);
+
+  /// @brief Returns the block of a tile.
+  std::size_t blockOf(std::size_t i, int size) const {
+    int row = static_cast<int>(i / size);
+    int col = static_cast<int>(i % size);
+    return static_cast<std::size_t>(row / _blockSize) * _blocksPerRow +
+           col / _blockSize;
+  }
+
+ private:
+  int _blockSize;
+  int _blocksPerRow{0};
+  std::vector<std::vector<std::size_t>> _inboxes;  //!< The seeds of a block.
+  std::vector<std::size_t> _active;  //!< The blocks with seeds.
+  std::vector<Worker> _workers;
+  std::size_t _rounds{0};
+};
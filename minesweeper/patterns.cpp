@@ -0,0 +1,44 @@
+// clang-format off
+#include "pch.h"
+#include "patterns.hpp"
+
+// clang-format on
+
+std::size_t verifyPairTable() {
+  std::size_t wrong = 0;
+
+  for (std::size_t key = 0; key < kPairKeysCount; key++) {
+    std::uint32_t hidden = key & 0x3FF;
+    int minesA = static_cast<int>((key >> 10) & 7);
+    int minesB = static_cast<int>((key >> 13) & 7);
+
+    // the tiles which are a mine in every layout, and the ones which are a
+    // mine in some layout
+    std::uint32_t always = hidden;
+    std::uint32_t sometimes = 0;
+    bool feasible = false;
+    for (std::uint32_t layout = hidden;; layout = (layout - 1) & hidden) {
+      if (countBits(layout & ~kPairOnlyB) == minesA &&
+          countBits(layout & ~kPairOnlyA) == minesB) {
+        feasible = true;
+        always &= layout;
+        sometimes |= layout;
+      }
+      if (layout == 0) {
+        break;
+      }
+    }
+
+    PairDeduction expected{0, 0};
+    if (feasible) {
+      expected.safe = static_cast<std::uint16_t>(hidden & ~sometimes);
+      expected.mines = static_cast<std::uint16_t>(always);
+    }
+    const PairDeduction& actual = kPairTable[key];
+    if (actual.safe != expected.safe || actual.mines != expected.mines) {
+      wrong++;
+    }
+  }
+
+  return wrong;
+}
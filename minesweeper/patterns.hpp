@@ -0,0 +1,153 @@
+#pragma once
+
+/// @brief The local patterns of two adjacent revealed tiles (1-1, 1-2,
+/// 1-2-1 seen from its middle, ...), solved at compile time.
+///
+/// The window of a pair of tiles A and B side by side is the union of their
+/// neighbourhoods (B below A is the same window transposed):
+///
+///   0 3 4 7
+///   1 A B 8
+///   2 5 6 9
+///
+/// Tiles 0-2 only touch A, tiles 3-6 touch both and tiles 7-9 only touch B,
+/// so the window holds every neighbour of A and B. A key packs the hidden
+/// (unflagged) tiles of the window as a 10-bit mask and the mines left
+/// around A and B (their zone values minus their flags, at most 7 each as
+/// they touch each other). The table maps every key to the hidden tiles
+/// which are safe, and the ones which are mines, in every mine layout
+/// satisfying both values: a single lookup instead of enumerating the
+/// layouts. An inconsistent key maps to no deduction.
+///
+/// Within each of the three groups of tiles the layouts are symmetric, so a
+/// table entry only depends on the number of mines of the shared group,
+/// which is what deducePair() enumerates. verifyPairTable() checks the whole
+/// table against the brute force enumeration of the layouts of the window.
+///
+/// The longer patterns (1-2-1, 1-2-2-1) have no window of their own: the
+/// pairs solve them by chaining, a deduced mine letting the next pair or the
+/// single point rule go on, which the pair_chaining test checks.
+
+/// The number of tiles of the window of a pair.
+constexpr int kPairWindowSize = 10;
+
+/// The offsets of the window tiles from A, for B right of A; swap them for B
+/// below A.
+constexpr int kPairRows[kPairWindowSize] = {-1, 0, 1, -1, -1, 1, 1, -1, 0, 1};
+constexpr int kPairCols[kPairWindowSize] = {-1, -1, -1, 0, 1, 0, 1, 2, 2, 2};
+
+/// The tiles touching A only, both tiles, and B only.
+constexpr std::uint32_t kPairOnlyA = 0x007;
+constexpr std::uint32_t kPairShared = 0x078;
+constexpr std::uint32_t kPairOnlyB = 0x380;
+
+/// The number of keys: the hidden tiles and two 3-bit mine counts.
+constexpr std::size_t kPairKeysCount = std::size_t{1} << 16;
+
+/// @brief The tiles of a window (bit k: tile k) known to be safe or mines.
+struct PairDeduction {
+  std::uint16_t safe;
+  std::uint16_t mines;
+};
+
+/// @brief Packs the key of a pair.
+/// @param hidden The hidden unflagged tiles of the window.
+/// @param minesA The mines left around A, in [0, 7].
+/// @param minesB The mines left around B, in [0, 7].
+constexpr std::uint32_t pairKey(std::uint32_t hidden, int minesA,
+                                int minesB) {
+  return hidden | static_cast<std::uint32_t>(minesA) << 10 |
+         static_cast<std::uint32_t>(minesB) << 13;
+}
+
+constexpr int countBits(std::uint32_t mask) {
+  int count = 0;
+  for (; mask != 0; mask &= mask - 1) {
+    count++;
+  }
+  return count;
+}
+
+/// @brief Solves a key: a group of tiles is safe (full of mines) if it holds
+/// no mine (only mines) whatever the feasible number of mines of the shared
+/// group.
+constexpr PairDeduction deducePair(std::uint32_t key) {
+  std::uint32_t hidden = key & 0x3FF;
+  int minesA = static_cast<int>((key >> 10) & 7);
+  int minesB = static_cast<int>((key >> 13) & 7);
+  int countA = countBits(hidden & kPairOnlyA);
+  int countShared = countBits(hidden & kPairShared);
+  int countB = countBits(hidden & kPairOnlyB);
+
+  bool feasible = false;
+  bool emptyA = true, fullA = true;
+  bool emptyShared = true, fullShared = true;
+  bool emptyB = true, fullB = true;
+
+  for (int shared = 0; shared <= countShared; shared++) {
+    int onlyA = minesA - shared;
+    int onlyB = minesB - shared;
+    if (onlyA < 0 || onlyA > countA || onlyB < 0 || onlyB > countB) {
+      continue;
+    }
+    feasible = true;
+    emptyA = emptyA && onlyA == 0;
+    fullA = fullA && onlyA == countA;
+    emptyShared = emptyShared && shared == 0;
+    fullShared = fullShared && shared == countShared;
+    emptyB = emptyB && onlyB == 0;
+    fullB = fullB && onlyB == countB;
+  }
+
+  if (!feasible) {
+    return PairDeduction{0, 0};
+  }
+
+  std::uint32_t safe = (emptyA ? kPairOnlyA : 0) |
+                       (emptyShared ? kPairShared : 0) |
+                       (emptyB ? kPairOnlyB : 0);
+  std::uint32_t mines = (fullA ? kPairOnlyA : 0) |
+                        (fullShared ? kPairShared : 0) |
+                        (fullB ? kPairOnlyB : 0);
+  return PairDeduction{static_cast<std::uint16_t>(safe & hidden),
+                       static_cast<std::uint16_t>(mines & hidden)};
+}
+
+constexpr std::array<PairDeduction, kPairKeysCount> makePairTable() {
+  std::array<PairDeduction, kPairKeysCount> table{};
+  for (std::size_t key = 0; key < kPairKeysCount; key++) {
+    table[key] = deducePair(static_cast<std::uint32_t>(key));
+  }
+  return table;
+}
+
+/// @brief The deductions of every key, built by the compiler.
+inline constexpr std::array<PairDeduction, kPairKeysCount> kPairTable =
+    makePairTable();
+
+// a few well-known patterns, on a wall of hidden tiles above the pair (tiles
+// 0, 3, 4 and 7)
+namespace pair_patterns_check {
+constexpr std::uint32_t kTop = 0x001 | 0x008 | 0x010 | 0x080;
+
+// 1-1 from the edge: A only touches 3 and 4, so 7 is safe
+static_assert(kPairTable[pairKey(0x008 | 0x010 | 0x080, 1, 1)].safe == 0x080,
+              "1-1 pattern");
+// 1-2: the second mine of B is on 7
+static_assert(kPairTable[pairKey(kTop, 1, 2)].mines == 0x080 &&
+                  kPairTable[pairKey(kTop, 1, 2)].safe == 0x001,
+              "1-2 pattern");
+// 1-1 on a wall: nothing is known
+static_assert(kPairTable[pairKey(kTop, 1, 1)].safe == 0 &&
+                  kPairTable[pairKey(kTop, 1, 1)].mines == 0,
+              "1-1 on a wall");
+// inconsistent: 3 mines around A with 2 hidden tiles
+static_assert(kPairTable[pairKey(0x008 | 0x010, 3, 0)].safe == 0 &&
+                  kPairTable[pairKey(0x008 | 0x010, 3, 0)].mines == 0,
+              "inconsistent key");
+}  // namespace pair_patterns_check
+
+/// @brief Checks every entry of kPairTable against the enumeration of all
+/// the mine layouts of its window.
+/// @return The number of wrong entries (0 if the table is right).
+std::size_t verifyPairTable();
@@ -12,7 +12,27 @@
 // add headers that you want to pre-compile here
 
 // clang-format off
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cmath>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <limits>
+#include <mutex>
+#include <new>
+#include <numeric>
 #include <random>
+#include <stdexcept>
+#include <thread>
+#include <tuple>
+#include <type_traits>
 #include <string>
 #include <iostream>
 #include <unordered_map>
@@ -20,18 +40,22 @@
 #include <memory>
 #include <filesystem>
 
+#define FMT_HEADER_ONLY
+#include "fmt/format.h"
+
+// the engine library (board, generator, solver, C API, ...) does not depend
+// on SDL, entt, spdlog or cxxopts
+#ifndef MINESWEEPER_ENGINE
 #include <SDL.h>
 #include <SDL_image.h>
 
 #include <entt/entt.hpp>
 
-#define FMT_HEADER_ONLY
-#include "fmt/format.h"
-
 #include "spdlog/spdlog.h"
 #include "spdlog/sinks/rotating_file_sink.h"
 
 #include "cxxopts.hpp"
+#endif
 
 // clang-format on
 
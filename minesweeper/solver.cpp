@@ -0,0 +1,214 @@
+// clang-format off
+#include "pch.h"
+#include "board.hpp"
+#include "bitboard.hpp"
+#include "patterns.hpp"
+#include "solver.hpp"
+
+// clang-format on
+
+namespace {
+/// @brief A bitboard of a difficulty level and the planes of its deductions.
+template <typename B>
+struct LevelBoard {
+  B board;
+  typename B::Bits safe;
+  typename B::Bits mines;
+
+  void deduce(const std::vector<std::uint8_t>& cells,
+              std::vector<std::size_t>& safeTiles,
+              std::vector<std::size_t>& mineTiles) {
+    board.setCells(cells);
+    if (board.deduce(safe, mines)) {
+      bitboard::forEachBit(safe, board.words(),
+                           [&](std::size_t i) { safeTiles.push_back(i); });
+      bitboard::forEachBit(mines, board.words(),
+                           [&](std::size_t i) { mineTiles.push_back(i); });
+    }
+  }
+};
+}  // namespace
+
+struct Solver::LevelBoards {
+  LevelBoard<BeginnerBitBoard> beginner;
+  LevelBoard<IntermediateBitBoard> intermediate;
+  LevelBoard<AdvancedBitBoard> advanced;
+};
+
+Solver::Solver() : _levels{std::make_unique<LevelBoards>()} {}
+
+Solver::~Solver() = default;
+
+bool Solver::deduceBits(int size, const std::vector<std::uint8_t>& cells,
+                        std::vector<std::size_t>& safe,
+                        std::vector<std::size_t>& mines) {
+  switch (size) {
+    case BeginnerBitBoard::width():
+      _levels->beginner.deduce(cells, safe, mines);
+      return true;
+    case IntermediateBitBoard::width():
+      _levels->intermediate.deduce(cells, safe, mines);
+      return true;
+    case AdvancedBitBoard::width():
+      _levels->advanced.deduce(cells, safe, mines);
+      return true;
+    default:
+      return false;
+  }
+}
+
+template <typename Topology>
+Solver::Status Solver::solve(BasicBoard<Topology>& board) {
+  while (!board.won()) {
+    if (!deduce(board, _safe, _mines)) {
+      return Status::Stuck;
+    }
+
+    for (std::size_t i : _mines) {
+      if (!board.isFlagged(i)) {
+        board.toggleFlag(static_cast<int>(i / board.size()),
+                         static_cast<int>(i % board.size()));
+      }
+    }
+
+    for (std::size_t i : _safe) {
+      int row = static_cast<int>(i / board.size());
+      int col = static_cast<int>(i % board.size());
+      if (board.reveal(row, col) == RevealResult::Mine) {
+        return Status::Lost;
+      }
+    }
+  }
+  return Status::Won;
+}
+
+template <typename Topology>
+bool Solver::deduce(const BasicBoard<Topology>& board,
+                    std::vector<std::size_t>& safe,
+                    std::vector<std::size_t>& mines) {
+  safe.clear();
+  mines.clear();
+
+  const int size = board.size();
+  bool bits = false;
+  if constexpr (Topology::kKind == TopologyKind::Square) {
+    bits = _bitBoards && deduceBits(size, board.cells(), safe, mines);
+  }
+
+  for (int row = 0; !bits && row < size; row++) {
+    for (int col = 0; col < size; col++) {
+      std::size_t i = board.index(row, col);
+      if (!board.isRevealed(i) || board.isMine(i)) {
+        continue;
+      }
+
+      int flagged = 0;
+      _hidden.clear();
+      Topology::forEachNeighbour(row, col, size, [&](int r, int c) {
+        std::size_t j = board.index(r, c);
+        if (board.isFlagged(j)) {
+          flagged++;
+        } else if (!board.isRevealed(j)) {
+          _hidden.push_back(j);
+        }
+      });
+
+      if (_hidden.empty()) {
+        continue;
+      }
+
+      int value = board.zoneValue(i);
+      if (value == flagged) {
+        safe.insert(safe.end(), _hidden.begin(), _hidden.end());
+      } else if (value == flagged + static_cast<int>(_hidden.size())) {
+        mines.insert(mines.end(), _hidden.begin(), _hidden.end());
+      }
+    }
+  }
+
+  // the pair patterns, only when the single point rule is stuck
+  if constexpr (Topology::kKind == TopologyKind::Square) {
+    if (_pairPatterns && safe.empty() && mines.empty()) {
+      deducePairs(board, safe, mines);
+    }
+  }
+
+  return !safe.empty() || !mines.empty();
+}
+
+template <typename Topology>
+void Solver::deducePairs(const BasicBoard<Topology>& board,
+                         std::vector<std::size_t>& safe,
+                         std::vector<std::size_t>& mines) const {
+  const int size = board.size();
+  auto isNumber = [&board](std::size_t i) {
+    return board.isRevealed(i) && !board.isMine(i);
+  };
+
+  for (int row = 0; row < size; row++) {
+    for (int col = 0; col < size; col++) {
+      std::size_t a = board.index(row, col);
+      if (!isNumber(a)) {
+        continue;
+      }
+
+      // B right of A, then B below A (the transposed window)
+      for (int vertical = 0; vertical < 2; vertical++) {
+        int rowB = row + vertical;
+        int colB = col + 1 - vertical;
+        if (rowB >= size || colB >= size) {
+          continue;
+        }
+        std::size_t b = board.index(rowB, colB);
+        if (!isNumber(b)) {
+          continue;
+        }
+
+        std::uint32_t hidden = 0;
+        int flagsA = 0;
+        int flagsB = 0;
+        std::size_t tiles[kPairWindowSize];
+        for (int k = 0; k < kPairWindowSize; k++) {
+          int r = row + (vertical ? kPairCols[k] : kPairRows[k]);
+          int c = col + (vertical ? kPairRows[k] : kPairCols[k]);
+          if (r < 0 || r >= size || c < 0 || c >= size) {
+            continue;
+          }
+          std::size_t j = board.index(r, c);
+          tiles[k] = j;
+          std::uint32_t bit = 1u << k;
+          if (board.isFlagged(j)) {
+            flagsA += (bit & kPairOnlyB) == 0;
+            flagsB += (bit & kPairOnlyA) == 0;
+          } else if (!board.isRevealed(j)) {
+            hidden |= bit;
+          }
+        }
+
+        if (hidden == 0) {
+          continue;
+        }
+        int minesA = board.zoneValue(a) - flagsA;
+        int minesB = board.zoneValue(b) - flagsB;
+        if (minesA < 0 || minesA > 7 || minesB < 0 || minesB > 7) {
+          continue;  // wrong flags
+        }
+
+        const PairDeduction& deduction =
+            kPairTable[pairKey(hidden, minesA, minesB)];
+        for (int k = 0; k < kPairWindowSize; k++) {
+          if (deduction.safe & (1u << k)) {
+            safe.push_back(tiles[k]);
+          } else if (deduction.mines & (1u << k)) {
+            mines.push_back(tiles[k]);
+          }
+        }
+      }
+    }
+  }
+}
+
+template Solver::Status Solver::solve(BasicBoard<SquareTopology>&);
+template Solver::Status Solver::solve(BasicBoard<TorusTopology>&);
+template Solver::Status Solver::solve(BasicBoard<HexTopology>&);
+template Solver::Status Solver::solve(BasicBoard<KnightTopology>&);
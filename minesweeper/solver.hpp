@@ -0,0 +1,75 @@
+#pragma once
+
+#include "board.hpp"
+
+/// @brief Deterministic solver. It only uses what the player sees: the zone
+/// values of the revealed tiles and the flags (which are assumed correct).
+class Solver {
+ public:
+  /// @brief The state of the board when the solver stops.
+  enum class Status { Won, Lost, Stuck };
+
+  Solver();
+  ~Solver();
+
+  Solver(const Solver&) = delete;
+  Solver& operator=(const Solver&) = delete;
+
+  /// @brief Applies the deductions until none is left: the safe tiles are
+  /// revealed and the mines are flagged.
+  /// @param board The board.
+  /// @return Won if all the safe tiles are revealed, Stuck if a guess is
+  /// needed, Lost if a wrong flag led to revealing a mine.
+  template <typename Topology>
+  Status solve(BasicBoard<Topology>& board);
+
+  /// @brief Collects the tiles which are known to be safe or mines using the
+  /// single point rule: a revealed tile whose value equals its flagged
+  /// neighbours makes its hidden neighbours safe, one whose value equals its
+  /// flagged and hidden neighbours makes them mines. On the square boards of
+  /// the difficulty levels the rule runs on a bitboard, for all the tiles at
+  /// once (see setBitBoards()). When the rule finds nothing on a square
+  /// board, the pairs of adjacent revealed tiles are looked up in the pattern
+  /// table (see patterns.hpp and setPairPatterns()).
+  /// @param board The board.
+  /// @param safe Receives the indices of the safe tiles.
+  /// @param mines Receives the indices of the mines.
+  /// @return true if any deduction was made; false otherwise.
+  template <typename Topology>
+  bool deduce(const BasicBoard<Topology>& board,
+              std::vector<std::size_t>& safe, std::vector<std::size_t>& mines);
+
+  /// @brief Enables or disables the pair patterns (enabled by default); without
+  /// them the solver only applies the single point rule, as BitBoard does.
+  void setPairPatterns(bool enabled) { _pairPatterns = enabled; }
+
+  /// @brief Enables or disables the bitboards of the single point rule
+  /// (enabled by default); without them the rule visits the tiles one by one
+  /// on every board. The deductions are the same.
+  void setBitBoards(bool enabled) { _bitBoards = enabled; }
+
+ private:
+  struct LevelBoards;
+
+  /// @brief Collects the deductions of the single point rule on the bitboard
+  /// of the dimension of a square board, if it is the one of a difficulty
+  /// level.
+  /// @return false if the dimension has no bitboard; true otherwise.
+  bool deduceBits(int size, const std::vector<std::uint8_t>& cells,
+                  std::vector<std::size_t>& safe,
+                  std::vector<std::size_t>& mines);
+
+  /// @brief Collects the deductions of the pair patterns of a square board.
+  template <typename Topology>
+  void deducePairs(const BasicBoard<Topology>& board,
+                   std::vector<std::size_t>& safe,
+                   std::vector<std::size_t>& mines) const;
+
+ private:
+  std::vector<std::size_t> _safe;    //!< Scratch list of safe tiles.
+  std::vector<std::size_t> _mines;   //!< Scratch list of mines.
+  std::vector<std::size_t> _hidden;  //!< Scratch list of hidden neighbours.
+  bool _pairPatterns{true};  //!< Looks up the pair patterns when stuck.
+  bool _bitBoards{true};     //!< Runs the single point rule on bitboards.
+  std::unique_ptr<LevelBoards> _levels;  //!< The bitboards of the levels.
+};
@@ -0,0 +1,57 @@
+#pragma once
+
+/// @brief A bounded lock-free queue between one producer thread and one
+/// consumer thread.
+///
+/// The items live in a ring of Capacity slots (a power of two) allocated
+/// with the queue, so pushing and popping never allocate. Each index is
+/// written by one side only and read by the other one with acquire/release
+/// ordering; the two indices sit on separate cache lines.
+template <typename T, std::size_t Capacity>
+class SpscQueue {
+  static_assert(Capacity > 0 && (Capacity & (Capacity - 1)) == 0,
+                "the capacity must be a power of two");
+
+ public:
+  SpscQueue() : _head{0}, _tail{0} {}
+
+  SpscQueue(const SpscQueue&) = delete;
+  SpscQueue& operator=(const SpscQueue&) = delete;
+
+  /// @brief Appends an item (producer side).
+  /// @return false if the queue is full; true otherwise.
+  bool tryPush(const T& item) {
+    std::size_t tail = _tail.load(std::memory_order_relaxed);
+    if (tail - _head.load(std::memory_order_acquire) == Capacity) {
+      return false;
+    }
+
+    _items[tail & (Capacity - 1)] = item;
+    _tail.store(tail + 1, std::memory_order_release);
+    return true;
+  }
+
+  /// @brief Removes the oldest item (consumer side).
+  /// @return false if the queue is empty; true otherwise.
+  bool tryPop(T& item) {
+    std::size_t head = _head.load(std::memory_order_relaxed);
+    if (head == _tail.load(std::memory_order_acquire)) {
+      return false;
+    }
+
+    item = _items[head & (Capacity - 1)];
+    _head.store(head + 1, std::memory_order_release);
+    return true;
+  }
+
+  /// @brief Checks if the queue is empty; exact on the consumer side only.
+  bool empty() const {
+    return _head.load(std::memory_order_acquire) ==
+           _tail.load(std::memory_order_acquire);
+  }
+
+ private:
+  std::array<T, Capacity> _items;
+  alignas(64) std::atomic<std::size_t> _head;  //!< Written by the consumer.
+  alignas(64) std::atomic<std::size_t> _tail;  //!< Written by the producer.
+};
@@ -0,0 +1,74 @@
+// clang-format off
+#include "pch.h"
+#include "threadpool.hpp"
+
+// clang-format on
+
+ThreadPool::ThreadPool(std::size_t threadsCount) : _next{0} {
+  if (threadsCount == 0) {
+    threadsCount = std::max(1u, std::thread::hardware_concurrency());
+  }
+
+  _workers.reserve(threadsCount);
+  for (std::size_t i = 0; i < threadsCount; i++) {
+    _workers.emplace_back([this, i]() { work(i); });
+  }
+}
+
+ThreadPool::~ThreadPool() {
+  {
+    std::lock_guard<std::mutex> lock(_mutex);
+    _stop = true;
+  }
+  _wakeUp.notify_all();
+
+  for (auto& worker : _workers) {
+    worker.join();
+  }
+}
+
+void ThreadPool::parallelFor(std::size_t count, const Task& task) {
+  if (count == 0) {
+    return;
+  }
+
+  std::lock_guard<std::mutex> submitLock(_submitMutex);
+  std::unique_lock<std::mutex> lock(_mutex);
+
+  _task = &task;
+  _count = count;
+  _next.store(0, std::memory_order_relaxed);
+  _running = _workers.size();
+  _generation++;
+  _wakeUp.notify_all();
+
+  _finished.wait(lock, [this]() { return _running == 0; });
+  _task = nullptr;
+}
+
+void ThreadPool::work(std::size_t worker) {
+  std::size_t generation = 0;
+
+  for (;;) {
+    {
+      std::unique_lock<std::mutex> lock(_mutex);
+      _wakeUp.wait(lock, [this, generation]() {
+        return _stop || _generation != generation;
+      });
+      if (_stop) {
+        return;
+      }
+      generation = _generation;
+    }
+
+    for (std::size_t i = _next.fetch_add(1, std::memory_order_relaxed);
+         i < _count; i = _next.fetch_add(1, std::memory_order_relaxed)) {
+      (*_task)(i, worker);
+    }
+
+    std::lock_guard<std::mutex> lock(_mutex);
+    if (--_running == 0) {
+      _finished.notify_one();
+    }
+  }
+}
@@ -0,0 +1,53 @@
+#pragma once
+
+/// @brief A fixed set of worker threads running data parallel loops.
+///
+/// The workers are started once and sleep between the loops, so running
+/// many short loops does not pay the cost of creating threads.
+class ThreadPool {
+ public:
+  /// @brief The body of a parallel loop.
+  /// The first argument is the index of the iteration, the second one is the
+  /// index of the worker running it (in [0, size())), which may be used to
+  /// pick per worker scratch data.
+  using Task = std::function<void(std::size_t, std::size_t)>;
+
+  /// @brief The constructor.
+  /// @param threadsCount The number of workers; 0 uses one worker per
+  /// hardware thread.
+  explicit ThreadPool(std::size_t threadsCount = 0);
+
+  /// @brief The destructor. Stops and joins the workers.
+  ~ThreadPool();
+
+  ThreadPool(const ThreadPool&) = delete;
+  ThreadPool& operator=(const ThreadPool&) = delete;
+
+  /// @brief Returns the number of workers.
+  std::size_t size() const { return _workers.size(); }
+
+  /// @brief Runs task(i, worker) for each i in [0, count) and waits until all
+  /// the iterations are done. Concurrent callers are serialized.
+  /// @param count The number of iterations.
+  /// @param task The loop body.
+  void parallelFor(std::size_t count, const Task& task);
+
+ private:
+  /// @brief The loop executed by each worker thread.
+  void work(std::size_t worker);
+
+ private:
+  std::vector<std::thread> _workers;  //!< The worker threads.
+
+  std::mutex _submitMutex;  //!< Serializes the callers of parallelFor.
+  std::mutex _mutex;        //!< Guards the state below.
+  std::condition_variable _wakeUp;
+  std::condition_variable _finished;
+
+  const Task* _task{nullptr};      //!< The running loop body.
+  std::size_t _count{0};           //!< The number of iterations.
+  std::atomic<std::size_t> _next;  //!< The next iteration to run.
+  std::size_t _generation{0};      //!< Incremented for every loop.
+  std::size_t _running{0};         //!< The workers still in the loop.
+  bool _stop{false};
+};
@@ -0,0 +1,185 @@
+#pragma once
+
+/// @brief The board topologies, for choosing one at run time. The inner
+/// loops never see this value: they are instantiated for a topology policy.
+enum class TopologyKind { Square, Torus, Hex, Knight };
+
+/// @brief Topology policies.
+///
+/// A policy tells which tiles of a size x size board are the neighbours of a
+/// tile: forEachNeighbour(row, col, size, f) calls f(r, c) once for each of
+/// them. forEachHalfNeighbour(row, col, size, f) only visits one offset of
+/// each pair of opposite offsets (the ones going up, or left on the same
+/// row), so iterating it over all the tiles visits each pair of neighbours
+/// once. The board code is templated on the policy, so the offsets are
+/// constants and the calls are inlined; no virtual call or switch happens
+/// per tile. All the policies are symmetric (b is a neighbour of a if and
+/// only if a is a neighbour of b) and have at most 8 neighbours, so a zone
+/// value always fits below the mine value. kMinSize is the smallest dimension
+/// of the boards of a policy.
+
+/// @brief The classic board: the 8 surrounding tiles.
+struct SquareTopology {
+  static constexpr TopologyKind kKind = TopologyKind::Square;
+  static constexpr const char* kName = "square";
+  static constexpr int kMinSize = 1;
+
+  template <typename F>
+  static void forEachNeighbour(int row, int col, int size, F&& f) {
+    visit(row, col, size, 8, f);
+  }
+
+  template <typename F>
+  static void forEachHalfNeighbour(int row, int col, int size, F&& f) {
+    visit(row, col, size, 4, f);
+  }
+
+ private:
+  template <typename F>
+  static void visit(int row, int col, int size, int count, F& f) {
+    constexpr int kRows[] = {0, -1, -1, -1, 0, 1, 1, 1};
+    constexpr int kCols[] = {-1, -1, 0, 1, 1, 1, 0, -1};
+    for (int k = 0; k < count; k++) {
+      int r = row + kRows[k];
+      int c = col + kCols[k];
+      if (r >= 0 && r < size && c >= 0 && c < size) {
+        f(r, c);
+      }
+    }
+  }
+};
+
+/// @brief The 8 surrounding tiles, the edges wrapping around: the board is
+/// a torus and every tile has 8 neighbours. Below 3x3 the offsets wrap onto
+/// the same tiles, which would be counted twice, so smaller boards are
+/// rejected.
+struct TorusTopology {
+  static constexpr TopologyKind kKind = TopologyKind::Torus;
+  static constexpr const char* kName = "torus";
+  static constexpr int kMinSize = 3;
+
+  template <typename F>
+  static void forEachNeighbour(int row, int col, int size, F&& f) {
+    visit(row, col, size, 8, f);
+  }
+
+  template <typename F>
+  static void forEachHalfNeighbour(int row, int col, int size, F&& f) {
+    visit(row, col, size, 4, f);
+  }
+
+ private:
+  template <typename F>
+  static void visit(int row, int col, int size, int count, F& f) {
+    assert(size >= kMinSize);
+    constexpr int kRows[] = {0, -1, -1, -1, 0, 1, 1, 1};
+    constexpr int kCols[] = {-1, -1, 0, 1, 1, 1, 0, -1};
+    for (int k = 0; k < count; k++) {
+      int r = row + kRows[k];
+      int c = col + kCols[k];
+      r = r < 0 ? r + size : r >= size ? r - size : r;
+      c = c < 0 ? c + size : c >= size ? c - size : c;
+      f(r, c);
+    }
+  }
+};
+
+/// @brief Hexagonal tiles in the "odd rows shifted right" layout: the 2
+/// tiles of the same row and 2 tiles of each neighbouring row.
+struct HexTopology {
+  static constexpr TopologyKind kKind = TopologyKind::Hex;
+  static constexpr const char* kName = "hex";
+  static constexpr int kMinSize = 1;
+
+  template <typename F>
+  static void forEachNeighbour(int row, int col, int size, F&& f) {
+    visit(row, col, size, 6, f);
+  }
+
+  template <typename F>
+  static void forEachHalfNeighbour(int row, int col, int size, F&& f) {
+    visit(row, col, size, 3, f);
+  }
+
+ private:
+  template <typename F>
+  static void visit(int row, int col, int size, int count, F& f) {
+    constexpr int kRows[] = {0, -1, -1, 0, 1, 1};
+    // the columns of the neighbours of the even and of the odd rows
+    constexpr int kCols[2][6] = {{-1, -1, 0, 1, 0, -1}, {-1, 0, 1, 1, 1, 0}};
+    const int* cols = kCols[row & 1];
+    for (int k = 0; k < count; k++) {
+      int r = row + kRows[k];
+      int c = col + cols[k];
+      if (r >= 0 && r < size && c >= 0 && c < size) {
+        f(r, c);
+      }
+    }
+  }
+};
+
+/// @brief The tiles a chess knight reaches in one move.
+struct KnightTopology {
+  static constexpr TopologyKind kKind = TopologyKind::Knight;
+  static constexpr const char* kName = "knight";
+  static constexpr int kMinSize = 1;
+
+  template <typename F>
+  static void forEachNeighbour(int row, int col, int size, F&& f) {
+    visit(row, col, size, 8, f);
+  }
+
+  template <typename F>
+  static void forEachHalfNeighbour(int row, int col, int size, F&& f) {
+    visit(row, col, size, 4, f);
+  }
+
+ private:
+  template <typename F>
+  static void visit(int row, int col, int size, int count, F& f) {
+    constexpr int kRows[] = {-2, -2, -1, -1, 1, 1, 2, 2};
+    constexpr int kCols[] = {-1, 1, -2, 2, -2, 2, -1, 1};
+    for (int k = 0; k < count; k++) {
+      int r = row + kRows[k];
+      int c = col + kCols[k];
+      if (r >= 0 && r < size && c >= 0 && c < size) {
+        f(r, c);
+      }
+    }
+  }
+};
+
+/// @brief Calls f(Topology{}) with the policy of a topology kind: the only
+/// switch on the kind, done once around a whole operation.
+template <typename F>
+decltype(auto) withTopology(TopologyKind kind, F&& f) {
+  switch (kind) {
+    case TopologyKind::Torus:
+      return f(TorusTopology{});
+    case TopologyKind::Hex:
+      return f(HexTopology{});
+    case TopologyKind::Knight:
+      return f(KnightTopology{});
+    case TopologyKind::Square:
+    default:
+      return f(SquareTopology{});
+  }
+}
+
+/// @brief Returns the smallest dimension of the boards of a topology.
+inline int minBoardSize(TopologyKind kind) {
+  return withTopology(kind, [](auto t) { return decltype(t)::kMinSize; });
+}
+
+/// @brief Parses a topology name (see the kName of the policies).
+/// @return true if the name is known; false otherwise.
+inline bool parseTopology(const std::string& name, TopologyKind& kind) {
+  for (TopologyKind k : {TopologyKind::Square, TopologyKind::Torus,
+                         TopologyKind::Hex, TopologyKind::Knight}) {
+    if (name == withTopology(k, [](auto t) { return decltype(t)::kName; })) {
+      kind = k;
+      return true;
+    }
+  }
+  return false;
+}
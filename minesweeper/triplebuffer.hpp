@@ -0,0 +1,54 @@
+#pragma once
+
+/// @brief Hands the latest version of a value from one producer thread to one
+/// consumer thread without locks or waits.
+///
+/// The producer fills back() and publishes it; the consumer acquires the
+/// latest published value and reads it through front() for as long as it
+/// needs. The third buffer sits between them, so neither side ever waits for
+/// the other: the producer overwrites a value the consumer skipped and the
+/// consumer keeps its value until a newer one is published. The buffers are
+/// reused, so the values should keep their capacity (e.g. vectors).
+template <typename T>
+class TripleBuffer {
+ public:
+  TripleBuffer() : _back{0}, _middle{1}, _front{2} {}
+
+  TripleBuffer(const TripleBuffer&) = delete;
+  TripleBuffer& operator=(const TripleBuffer&) = delete;
+
+  /// @brief Returns the value being written (producer side). It holds an
+  /// older version, which the producer overwrites.
+  T& back() { return _buffers[_back]; }
+
+  /// @brief Publishes back(), replacing the value the consumer has not
+  /// acquired yet, if any (producer side).
+  void publish() {
+    std::uint8_t back = static_cast<std::uint8_t>(_back | kFresh);
+    _back = _middle.exchange(back, std::memory_order_acq_rel) & kIndexMask;
+  }
+
+  /// @brief Makes front() the latest published value (consumer side).
+  /// @return true if a value was published since the last call; false if
+  /// front() did not change.
+  bool acquire() {
+    if (!(_middle.load(std::memory_order_relaxed) & kFresh)) {
+      return false;
+    }
+    _front = _middle.exchange(_front, std::memory_order_acq_rel) & kIndexMask;
+    return true;
+  }
+
+  /// @brief Returns the acquired value (consumer side).
+  const T& front() const { return _buffers[_front]; }
+
+ private:
+  static constexpr std::uint8_t kIndexMask = 0x03;
+  static constexpr std::uint8_t kFresh = 0x04;  //!< Set on a published middle.
+
+ private:
+  std::array<T, 3> _buffers;
+  std::uint8_t _back;                 //!< Owned by the producer.
+  std::atomic<std::uint8_t> _middle;  //!< The index and the fresh flag.
+  std::uint8_t _front;                //!< Owned by the consumer.
+};
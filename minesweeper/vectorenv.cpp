@@ -0,0 +1,294 @@
+// clang-format off
+#include "pch.h"
+#include "bitboard.hpp"
+#include "boardgenerator.hpp"
+#include "vectorenv.hpp"
+
+// clang-format on
+
+namespace {
+/// The number of boards of a shard: enough work to hide the cost of handing
+/// a shard to a worker.
+const std::size_t kShardSize = 64;
+
+void loadTiles(Board& board, int size, const std::vector<int>& tiles) {
+  board.setTiles(size, tiles);
+}
+
+template <int W, int H>
+void loadTiles(BitBoard<W, H>& board, int, const std::vector<int>& tiles) {
+  board.setTiles(tiles);
+}
+
+/// @brief Writes the tiles of a board as the player sees them: the value of
+/// a hidden tile is cleared, its flag kept.
+void observeTiles(const Board& board, std::uint8_t* out) {
+  // eight tiles at a time, spreading the revealed bit of each byte over the
+  // byte
+  const std::uint64_t kRevealedBytes = 0x0101010101010101ull * kCellRevealed;
+  const std::uint64_t kFlaggedBytes = 0x0101010101010101ull * kCellFlagged;
+  const std::uint8_t* cells = board.cells().data();
+  std::size_t n = board.cellsCount();
+  std::size_t i = 0;
+  for (; i + 8 <= n; i += 8) {
+    std::uint64_t word;
+    std::memcpy(&word, cells + i, sizeof(word));
+    std::uint64_t revealed = ((word & kRevealedBytes) / kCellRevealed) * 0xFF;
+    word &= revealed | kFlaggedBytes;
+    std::memcpy(out + i, &word, sizeof(word));
+  }
+  for (; i < n; i++) {
+    std::uint8_t cell = cells[i];
+    out[i] = static_cast<std::uint8_t>(
+        cell & (cell & kCellRevealed ? 0xFF : kCellFlagged));
+  }
+}
+
+template <int W, int H>
+void observeTiles(const BitBoard<W, H>& board, std::uint8_t* out) {
+  board.observe(out);
+}
+}  // namespace
+
+/// @brief The boards of the environment.
+struct VectorEnv::Slots {
+  virtual ~Slots() = default;
+
+  /// @brief Generates the games of the current seeds of the boards
+  /// [first, last).
+  virtual void start(VectorEnv& env, std::size_t first, std::size_t last,
+                     BoardGenerator& generator) = 0;
+
+  /// @brief Steps or resets the boards [first, last), with the arguments of
+  /// the running step.
+  virtual void run(VectorEnv& env, std::size_t first, std::size_t last,
+                   BoardGenerator& generator) = 0;
+
+  /// @brief Returns the number of games which ended.
+  virtual std::uint64_t episodes() const = 0;
+};
+
+/// @brief The boards of the environment, of type B (Board or a BitBoard of
+/// fixed dimensions).
+template <typename B>
+struct VectorEnv::BoardSlots : VectorEnv::Slots {
+  /// @brief A board and its position in the seed stream.
+  struct Slot {
+    B board;
+    std::uint64_t seed;      //!< The seed of the current game.
+    std::uint64_t episodes;  //!< The games which ended.
+    bool firstMove;          //!< No tile was revealed yet.
+  };
+
+  std::vector<Slot> slots;
+
+  BoardSlots(std::size_t count, std::uint64_t seed) : slots(count) {
+    for (std::size_t b = 0; b < count; b++) {
+      slots[b].seed = seed + b;
+      slots[b].episodes = 0;
+    }
+  }
+
+  void start(VectorEnv& env, std::size_t first, std::size_t last,
+             BoardGenerator& generator) override {
+    for (std::size_t b = first; b < last; b++) {
+      newGame(env, slots[b], generator);
+    }
+  }
+
+  void run(VectorEnv& env, std::size_t first, std::size_t last,
+           BoardGenerator& generator) override {
+    for (std::size_t b = first; b < last; b++) {
+      Slot& slot = slots[b];
+
+      if (env._actions == nullptr) {
+        slot.seed += slots.size();
+        newGame(env, slot, generator);
+      } else {
+        float reward;
+        bool done;
+        step(env, slot, env._actions[b], generator, reward, done);
+        if (env._rewardsOut) {
+          env._rewardsOut[b] = reward;
+        }
+        if (env._dones) {
+          env._dones[b] = done;
+        }
+      }
+
+      if (env._revealed) {
+        env._revealed[b] =
+            static_cast<std::uint32_t>(slot.board.revealedCount());
+      }
+      if (env._observations) {
+        observeTiles(slot.board, env._observations + b * env.cellsCount());
+      }
+    }
+  }
+
+  std::uint64_t episodes() const override {
+    std::uint64_t episodes = 0;
+    for (const Slot& slot : slots) {
+      episodes += slot.episodes;
+    }
+    return episodes;
+  }
+
+  /// @brief Applies an action to a board and resets it if the game ended.
+  void step(VectorEnv& env, Slot& slot, const EnvAction& action,
+            BoardGenerator& generator, float& reward, bool& done) {
+    B& board = slot.board;
+    const EnvRewards& rewards = env._rewards;
+    std::size_t revealedBefore = board.revealedCount();
+    RevealResult result = RevealResult::None;
+    bool changed = false;
+
+    if (action.row < static_cast<std::uint32_t>(env._size) &&
+        action.col < static_cast<std::uint32_t>(env._size)) {
+      int row = static_cast<int>(action.row);
+      int col = static_cast<int>(action.col);
+
+      switch (static_cast<EnvActionKind>(action.kind)) {
+        case EnvActionKind::Reveal:
+          if (slot.firstMove) {
+            // the first reveal is safe: move the mine to the first free tile
+            std::size_t i = board.index(row, col);
+            if (board.isMine(i)) {
+              std::size_t to = 0;
+              while (board.isMine(to) || board.isRevealed(to)) {
+                to++;
+              }
+              board.relocateMine(i, to);
+            }
+          }
+          result = board.reveal(row, col);
+          break;
+        case EnvActionKind::Flag:
+          changed = board.toggleFlag(row, col);
+          break;
+        case EnvActionKind::Chord:
+          result = board.chord(row, col);
+          break;
+        default:
+          break;
+      }
+    }
+
+    done = false;
+    if (result == RevealResult::Mine) {
+      reward = rewards.lose;
+      done = true;
+    } else if (board.revealedCount() > revealedBefore) {
+      std::size_t safe = board.cellsCount() - board.minesCount();
+      reward = rewards.progress *
+               static_cast<float>(board.revealedCount() - revealedBefore) /
+               static_cast<float>(safe);
+      slot.firstMove = false;
+      if (board.won()) {
+        reward += rewards.win;
+        done = true;
+      }
+    } else {
+      reward = changed ? 0.0f : rewards.noop;
+    }
+
+    if (done) {
+      slot.episodes++;
+      slot.seed += slots.size();
+      newGame(env, slot, generator);
+    }
+  }
+
+  /// @brief Generates the game of the current seed of a slot.
+  void newGame(const VectorEnv& env, Slot& slot, BoardGenerator& generator) {
+    generator.seed(slot.seed);
+    generator.generate();
+    loadTiles(slot.board, env._size, generator.getTiles());
+    slot.firstMove = true;
+  }
+};
+
+VectorEnv::VectorEnv(std::size_t count, int size, int mines,
+                     std::uint64_t seed, std::size_t threadsCount)
+    : _size{size}, _mines{mines}, _count{count}, _pool{threadsCount} {
+  // the first reveal moves a mine to a free tile: there must be one
+  if (size <= 0 || size > kMaxBoardSize || mines < 0 ||
+      static_cast<std::size_t>(mines) >= cellsCount()) {
+    throw std::invalid_argument("VectorEnv: invalid size or mines count");
+  }
+
+  switch (size) {
+    case BeginnerBitBoard::width():
+      _slots = std::make_unique<BoardSlots<BeginnerBitBoard>>(count, seed);
+      break;
+    case IntermediateBitBoard::width():
+      _slots = std::make_unique<BoardSlots<IntermediateBitBoard>>(count, seed);
+      break;
+    case AdvancedBitBoard::width():
+      _slots = std::make_unique<BoardSlots<AdvancedBitBoard>>(count, seed);
+      break;
+    default:
+      _slots = std::make_unique<BoardSlots<Board>>(count, seed);
+      break;
+  }
+
+  for (std::size_t i = 0; i < _pool.size(); i++) {
+    _generators.emplace_back(std::make_unique<BoardGenerator>(size, mines));
+  }
+
+  _shardTask = [this](std::size_t shard, std::size_t worker) {
+    runShard(shard, worker);
+  };
+
+  // the first games, on the first seeds
+  _pool.parallelFor((count + kShardSize - 1) / kShardSize,
+                    [this](std::size_t shard, std::size_t worker) {
+                      std::size_t last =
+                          std::min((shard + 1) * kShardSize, _count);
+                      _slots->start(*this, shard * kShardSize, last,
+                                    *_generators[worker]);
+                    });
+}
+
+VectorEnv::~VectorEnv() = default;
+
+std::uint64_t VectorEnv::episodesCount() const { return _slots->episodes(); }
+
+void VectorEnv::reset(std::uint8_t* observations) {
+  _actions = nullptr;
+  _observations = observations;
+  _revealed = nullptr;
+  _rewardsOut = nullptr;
+  _dones = nullptr;
+
+  std::size_t shards = (_count + kShardSize - 1) / kShardSize;
+  if (shards == 1) {
+    runShard(0, 0);
+  } else {
+    _pool.parallelFor(shards, _shardTask);
+  }
+}
+
+void VectorEnv::step(const EnvAction* actions, std::uint8_t* observations,
+                     std::uint32_t* revealed, float* rewards,
+                     std::uint8_t* dones) {
+  _actions = actions;
+  _observations = observations;
+  _revealed = revealed;
+  _rewardsOut = rewards;
+  _dones = dones;
+
+  // a single shard runs on the calling thread: waking a worker up would
+  // cost more than the step
+  std::size_t shards = (_count + kShardSize - 1) / kShardSize;
+  if (shards == 1) {
+    runShard(0, 0);
+  } else {
+    _pool.parallelFor(shards, _shardTask);
+  }
+}
+
+void VectorEnv::runShard(std::size_t shard, std::size_t worker) {
+  std::size_t last = std::min((shard + 1) * kShardSize, _count);
+  _slots->run(*this, shard * kShardSize, last, *_generators[worker]);
+}
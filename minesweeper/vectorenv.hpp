@@ -0,0 +1,115 @@
+#pragma once
+
+#include "board.hpp"
+#include "threadpool.hpp"
+
+/// @brief The kinds of actions of VectorEnv (the values of MS_ACTION_*).
+enum class EnvActionKind : std::uint32_t { Reveal = 0, Flag = 1, Chord = 2 };
+
+/// @brief An action on one board of a VectorEnv; the layout of ms_action.
+struct EnvAction {
+  std::uint32_t row;
+  std::uint32_t col;
+  std::uint32_t kind;  //!< An EnvActionKind.
+};
+
+/// @brief The rewards of a step.
+struct EnvRewards {
+  float win{1};        //!< Added when the step wins the game.
+  float lose{-1};      //!< When the step reveals a mine.
+  float progress{1};   //!< Scaled by the revealed fraction of the safe tiles.
+  float noop{-0.01f};  //!< When the step changed nothing or was invalid.
+};
+
+/// @brief Steps a batch of independent boards in lockstep, for training
+/// agents.
+///
+/// Each step applies one action per board and writes the outcome into
+/// buffers provided by the caller, one entry per board: the observation (the
+/// packed tiles with the values of the hidden tiles cleared), the number of
+/// revealed tiles, the reward and whether the game ended. A board whose game
+/// ended is reset at once, so its observation is the one of the new game.
+/// The first reveal of a game never hits a mine (the mine is moved away).
+///
+/// Board b plays the seeds seed + b, seed + b + count, seed + b + 2 * count,
+/// ... so the games do not depend on the number of threads. The boards are
+/// split into shards run on a thread pool, and the steps do not allocate
+/// memory. The boards of the difficulty levels are bitboards of fixed
+/// dimensions (see bitboard.hpp), the other ones are Board; both play the
+/// same games.
+class VectorEnv {
+ public:
+  /// @brief The constructor. Generates the first game of every board.
+  /// Throws std::invalid_argument if the size is not in [1, kMaxBoardSize] or
+  /// if the mines leave no safe tile.
+  /// @param count The number of boards.
+  /// @param size The dimension of the boards.
+  /// @param mines The number of mines of each board, fewer than size * size.
+  /// @param seed The first seed of the seed stream.
+  /// @param threadsCount The number of threads; 0 uses one thread per
+  /// hardware thread.
+  VectorEnv(std::size_t count, int size, int mines, std::uint64_t seed,
+            std::size_t threadsCount = 0);
+
+  ~VectorEnv();
+
+  VectorEnv(const VectorEnv&) = delete;
+  VectorEnv& operator=(const VectorEnv&) = delete;
+
+  /// @brief Returns the number of boards.
+  std::size_t count() const { return _count; }
+
+  /// @brief Returns the number of tiles of a board, the size of its
+  /// observation.
+  std::size_t cellsCount() const {
+    return static_cast<std::size_t>(_size) * _size;
+  }
+
+  /// @brief Returns the number of games which ended since the construction.
+  std::uint64_t episodesCount() const;
+
+  const EnvRewards& rewards() const { return _rewards; }
+  void setRewards(const EnvRewards& rewards) { _rewards = rewards; }
+
+  /// @brief Starts a new game on every board (with the next seeds).
+  /// @param observations Receives count() * cellsCount() bytes; may be null.
+  void reset(std::uint8_t* observations);
+
+  /// @brief Applies one action per board. Every buffer holds one entry per
+  /// board and may be null.
+  /// @param actions count() actions.
+  /// @param observations Receives count() * cellsCount() bytes.
+  /// @param revealed Receives the revealed tiles of each board.
+  /// @param rewards Receives the reward of each board.
+  /// @param dones Receives 1 for each board whose game ended (and was reset);
+  /// 0 otherwise.
+  void step(const EnvAction* actions, std::uint8_t* observations,
+            std::uint32_t* revealed, float* rewards, std::uint8_t* dones);
+
+ private:
+  struct Slots;
+  template <typename B>
+  struct BoardSlots;
+
+  /// @brief Steps or resets the boards of a shard.
+  void runShard(std::size_t shard, std::size_t worker);
+
+ private:
+  int _size;
+  int _mines;
+  std::size_t _count;
+  EnvRewards _rewards;
+  std::unique_ptr<Slots> _slots;  //!< The boards, of a type chosen by the
+                                  //!< size.
+  ThreadPool _pool;
+  std::vector<std::unique_ptr<BoardGenerator>> _generators;  //!< One per
+                                                              //!< worker.
+  ThreadPool::Task _shardTask;  //!< Calls runShard(); built once.
+
+  // the arguments of the running step (null actions: reset)
+  const EnvAction* _actions{nullptr};
+  std::uint8_t* _observations{nullptr};
+  std::uint32_t* _revealed{nullptr};
+  float* _rewardsOut{nullptr};
+  std::uint8_t* _dones{nullptr};
+};